@@ -39,4 +39,13 @@ void _cally_actor_get_top_level_origin (ClutterActor *actor,
                                         gint         *x,
                                         gint         *y);
 
+void _cally_actor_queue_state_change (AtkObject *atk_obj,
+                                      AtkState   state,
+                                      gboolean   value);
+
+void _cally_actor_queue_text_caret_moved (AtkObject *atk_obj,
+                                          gint       offset);
+
+void _cally_actor_queue_text_selection_changed (AtkObject *atk_obj);
+
 #endif /* __CALLY_ACTOR_PRIVATE_H__ */
@@ -178,8 +178,20 @@ struct _CallyActorPrivate
   GList  *action_list;
 
   GList *children;
+
+  /* Coalesced notifications, see _cally_actor_queue_state_change() */
+  guint64 pending_states;
+  guint64 pending_state_values;
+  gint    pending_caret_offset;
+  guint   pending_text_caret_moved : 1;
+  guint   pending_text_selection_changed : 1;
+  guint   is_queued : 1;
 };
 
+/* Accessibles with pending notifications, in the order they were queued */
+static GQueue pending_accessibles = G_QUEUE_INIT;
+static guint flush_pending_id = 0;
+
 G_DEFINE_TYPE_WITH_CODE (CallyActor,
                          cally_actor,
                          ATK_TYPE_GOBJECT_ACCESSIBLE,
@@ -748,6 +760,153 @@ _cally_actor_get_top_level_origin (ClutterActor *actor,
     *yp = 0;
 }
 
+/* Coalesced notifications
+ *
+ * Every ATK signal is forwarded to the AT-SPI bridge as a D-Bus message.
+ * Instead of emitting them as the underlying actor properties change,
+ * they are collected per accessible and emitted once per main loop
+ * iteration: repeated changes are merged, and a state that flips back to
+ * its previous value before the flush is not reported at all.
+ */
+static gboolean
+flush_pending_notifications (gpointer data)
+{
+  CallyActor *cally_actor;
+
+  flush_pending_id = 0;
+
+  while ((cally_actor = g_queue_pop_head (&pending_accessibles)))
+    {
+      CallyActorPrivate *priv = cally_actor->priv;
+      AtkObject *atk_obj = ATK_OBJECT (cally_actor);
+      guint64 states;
+      guint64 values;
+      AtkState state;
+
+      priv->is_queued = FALSE;
+
+      states = priv->pending_states;
+      values = priv->pending_state_values;
+      priv->pending_states = 0;
+
+      for (state = 0; states; state++, states >>= 1, values >>= 1)
+        {
+          if (states & 1)
+            atk_object_notify_state_change (atk_obj, state, values & 1);
+        }
+
+      if (priv->pending_text_selection_changed)
+        {
+          priv->pending_text_selection_changed = FALSE;
+          g_signal_emit_by_name (atk_obj, "text_selection_changed");
+        }
+
+      if (priv->pending_text_caret_moved)
+        {
+          priv->pending_text_caret_moved = FALSE;
+          g_signal_emit_by_name (atk_obj, "text_caret_moved",
+                                 priv->pending_caret_offset);
+        }
+
+      g_object_unref (cally_actor);
+    }
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+queue_notifications (CallyActor *cally_actor)
+{
+  CallyActorPrivate *priv = cally_actor->priv;
+
+  if (!priv->is_queued)
+    {
+      priv->is_queued = TRUE;
+      g_queue_push_tail (&pending_accessibles, g_object_ref (cally_actor));
+    }
+
+  if (!flush_pending_id)
+    {
+      flush_pending_id = g_idle_add_full (G_PRIORITY_DEFAULT,
+                                          flush_pending_notifications,
+                                          NULL, NULL);
+      g_source_set_name_by_id (flush_pending_id,
+                               "[clutter] flush_pending_notifications");
+    }
+}
+
+/*
+ * _cally_actor_queue_state_change:
+ *
+ * Queues an atk_object_notify_state_change() for @atk_obj. A change that
+ * is queued again with the opposite value before being emitted cancels
+ * out, as the state is then back to what was last reported.
+ */
+void
+_cally_actor_queue_state_change (AtkObject *atk_obj,
+                                 AtkState   state,
+                                 gboolean   value)
+{
+  CallyActorPrivate *priv;
+  guint64 mask;
+
+  if (!CALLY_IS_ACTOR (atk_obj) || state >= 64)
+    {
+      atk_object_notify_state_change (atk_obj, state, value);
+      return;
+    }
+
+  priv = CALLY_ACTOR (atk_obj)->priv;
+  mask = G_GUINT64_CONSTANT (1) << state;
+
+  if (priv->pending_states & mask)
+    {
+      if (!!(priv->pending_state_values & mask) != !!value)
+        priv->pending_states &= ~mask;
+      return;
+    }
+
+  priv->pending_states |= mask;
+  if (value)
+    priv->pending_state_values |= mask;
+  else
+    priv->pending_state_values &= ~mask;
+
+  queue_notifications (CALLY_ACTOR (atk_obj));
+}
+
+/*
+ * _cally_actor_queue_text_caret_moved:
+ *
+ * Queues a "text_caret_moved" signal; only the last offset is reported.
+ */
+void
+_cally_actor_queue_text_caret_moved (AtkObject *atk_obj,
+                                     gint       offset)
+{
+  CallyActorPrivate *priv = CALLY_ACTOR (atk_obj)->priv;
+
+  priv->pending_text_caret_moved = TRUE;
+  priv->pending_caret_offset = offset;
+
+  queue_notifications (CALLY_ACTOR (atk_obj));
+}
+
+/*
+ * _cally_actor_queue_text_selection_changed:
+ *
+ * Queues a "text_selection_changed" signal, emitted once per flush.
+ */
+void
+_cally_actor_queue_text_selection_changed (AtkObject *atk_obj)
+{
+  CallyActorPrivate *priv = CALLY_ACTOR (atk_obj)->priv;
+
+  priv->pending_text_selection_changed = TRUE;
+
+  queue_notifications (CALLY_ACTOR (atk_obj));
+}
+
 /* AtkAction implementation */
 static void
 cally_actor_action_interface_init (AtkActionIface *iface)
@@ -981,7 +1140,7 @@ cally_actor_real_notify_clutter (GObject    *obj,
   else
     return;
 
-  atk_object_notify_state_change (atk_obj, state, value);
+  _cally_actor_queue_state_change (atk_obj, state, value);
 }
 
 static void
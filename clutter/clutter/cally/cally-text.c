@@ -1693,20 +1693,20 @@ cally_text_notify_clutter (GObject    *obj,
     {
       /* the selection can change also for the cursor position */
       if (_check_for_selection_change (cally_text, clutter_text))
-        g_signal_emit_by_name (atk_obj, "text_selection_changed");
+        _cally_actor_queue_text_selection_changed (atk_obj);
 
-      g_signal_emit_by_name (atk_obj, "text_caret_moved",
-                             clutter_text_get_cursor_position (clutter_text));
+      _cally_actor_queue_text_caret_moved (atk_obj,
+                                           clutter_text_get_cursor_position (clutter_text));
     }
   else if (g_strcmp0 (pspec->name, "selection-bound") == 0)
     {
       if (_check_for_selection_change (cally_text, clutter_text))
-        g_signal_emit_by_name (atk_obj, "text_selection_changed");
+        _cally_actor_queue_text_selection_changed (atk_obj);
     }
   else if (g_strcmp0 (pspec->name, "editable") == 0)
     {
-      atk_object_notify_state_change (atk_obj, ATK_STATE_EDITABLE,
-                                      clutter_text_get_editable (clutter_text));
+      _cally_actor_queue_state_change (atk_obj, ATK_STATE_EDITABLE,
+                                       clutter_text_get_editable (clutter_text));
     }
   else if (g_strcmp0 (pspec->name, "activatable") == 0)
     {
@@ -32,6 +32,8 @@ G_BEGIN_DECLS
  *   extents of what needs to be redrawn lies within the actors
  *   current allocation. (Only use this for 2D actors though because
  *   any actor with depth may be projected outside of its allocation)
+ * @CLUTTER_REDRAW_KEEP_PICK: Only what the actor paints changed, not its
+ *   geometry or how it reacts to input, so the stage pick stays valid
  *
  * Flags passed to the clutter_actor_queue_redraw_with_clip ()
  * function
@@ -40,7 +42,8 @@ G_BEGIN_DECLS
  */
 typedef enum
 {
-  CLUTTER_REDRAW_CLIPPED_TO_ALLOCATION  = 1 << 0
+  CLUTTER_REDRAW_CLIPPED_TO_ALLOCATION  = 1 << 0,
+  CLUTTER_REDRAW_KEEP_PICK              = 1 << 1,
 } ClutterRedrawFlags;
 
 /*< private >
@@ -254,6 +257,8 @@ ClutterActor *                  _clutter_actor_get_stage_internal
 
 void                            _clutter_actor_apply_modelview_transform                (ClutterActor *self,
                                                                                          CoglMatrix   *matrix);
+void                            _clutter_actor_invalidate_absolute_transforms           (void);
+
 void                            _clutter_actor_apply_relative_transformation_matrix     (ClutterActor *self,
                                                                                          ClutterActor *ancestor,
                                                                                          CoglMatrix   *matrix);
@@ -318,6 +323,14 @@ void                            _clutter_actor_queue_update_resource_scale_recur
 gboolean                        _clutter_actor_get_real_resource_scale                  (ClutterActor *actor,
                                                                                          float        *resource_scale);
 
+gboolean                        _clutter_actor_is_scalar_animatable_property            (ClutterAnimatable *animatable,
+                                                                                         GParamSpec        *pspec);
+void                            _clutter_actor_set_animatable_scalar                    (ClutterActor *self,
+                                                                                         GParamSpec   *pspec,
+                                                                                         double        value);
+void                            _clutter_actor_begin_notify_batch                       (void);
+void                            _clutter_actor_end_notify_batch                         (void);
+
 ClutterPaintNode *              clutter_actor_create_texture_paint_node                 (ClutterActor *self,
                                                                                          CoglTexture  *texture);
 
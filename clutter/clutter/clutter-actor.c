@@ -615,6 +615,7 @@
 #include "clutter-build-config.h"
 
 #include <math.h>
+#include <string.h>
 
 #include <gobject/gvaluecollector.h>
 
@@ -681,6 +682,16 @@ typedef enum
  * will ask for 3 different preferred size in each allocation cycle */
 #define N_CACHED_SIZE_REQUESTS 3
 
+typedef struct _ClutterActorProjectionCache
+{
+  CoglMatrix eye_transform;
+  guint eye_transform_stamp;
+
+  ClutterActorBox box;
+  graphene_point3d_t box_vertices[4];
+  guint box_stamp;
+} ClutterActorProjectionCache;
+
 struct _ClutterActorPrivate
 {
   /* request mode */
@@ -706,6 +717,10 @@ struct _ClutterActorPrivate
   /* the cached transformation matrix; see apply_transform() */
   CoglMatrix transform;
 
+  /* cached transformation to eye coordinates and the last box projected
+   * with it; see clutter_actor_get_eye_transform() */
+  ClutterActorProjectionCache *projection_cache;
+
   float resource_scale;
 
   guint8 opacity;
@@ -853,6 +868,7 @@ struct _ClutterActorPrivate
   guint needs_paint_volume_update   : 1;
   guint had_effects_on_last_paint_volume_update : 1;
   guint needs_compute_resource_scale : 1;
+  guint in_notify_batch             : 1;
 };
 
 enum
@@ -1022,6 +1038,24 @@ enum
 
 static guint actor_signals[LAST_SIGNAL] = { 0, };
 
+/* Bumped whenever the transformation of any actor, its position in the
+ * scene graph or the stage view changes; cached absolute transformations
+ * tagged with an older stamp are stale */
+static guint absolute_transform_stamp = 1;
+
+static inline void
+clutter_actor_invalidate_transform (ClutterActor *self)
+{
+  self->priv->transform_valid = FALSE;
+  absolute_transform_stamp++;
+}
+
+void
+_clutter_actor_invalidate_absolute_transforms (void)
+{
+  absolute_transform_stamp++;
+}
+
 typedef struct _TransitionClosure
 {
   ClutterActor *actor;
@@ -1293,12 +1327,13 @@ _clutter_actor_transform_local_box_to_stage (ClutterActor          *self,
 {
   CoglFramebuffer *fb =
    clutter_pick_context_get_framebuffer (pick_context);
-  CoglMatrix stage_transform, inv_stage_transform;
+  CoglMatrix inv_stage_transform;
   CoglMatrix modelview, transform_to_stage;
+  graphene_point3d_t stage_vertices[4];
   int v;
 
-  clutter_actor_get_transform (CLUTTER_ACTOR (stage), &stage_transform);
-  if (!cogl_matrix_get_inverse (&stage_transform, &inv_stage_transform))
+  /* The stage keeps the inverse of its view cached across pick boxes */
+  if (!_clutter_stage_get_inverse_view_matrix (stage, &inv_stage_transform))
     return FALSE;
   cogl_framebuffer_get_modelview_matrix (fb, &modelview);
   cogl_matrix_multiply (&transform_to_stage, &inv_stage_transform, &modelview);
@@ -1315,16 +1350,19 @@ _clutter_actor_transform_local_box_to_stage (ClutterActor          *self,
   vertices[3].x = box->x1;
   vertices[3].y = box->y2;
 
+  /* Transform all corners in a single pass */
+  cogl_matrix_transform_points (&transform_to_stage,
+                                2,
+                                sizeof (graphene_point_t),
+                                vertices,
+                                sizeof (graphene_point3d_t),
+                                stage_vertices,
+                                4);
+
   for (v = 0; v < 4; v++)
     {
-      float z = 0.f;
-      float w = 1.f;
-
-      cogl_matrix_transform_point (&transform_to_stage,
-                                   &vertices[v].x,
-                                   &vertices[v].y,
-                                   &z,
-                                   &w);
+      vertices[v].x = stage_vertices[v].x;
+      vertices[v].y = stage_vertices[v].y;
     }
 
   return TRUE;
@@ -2601,7 +2639,7 @@ clutter_actor_set_allocation_internal (ClutterActor           *self,
       CLUTTER_NOTE (LAYOUT, "Allocation for '%s' changed",
                     _clutter_actor_get_debug_name (self));
 
-      priv->transform_valid = FALSE;
+      clutter_actor_invalidate_transform (self);
 
       g_object_notify_by_pspec (obj, obj_props[PROP_ALLOCATION]);
 
@@ -2918,6 +2956,34 @@ clutter_actor_apply_relative_transform_to_point (ClutterActor             *self,
   cogl_matrix_transform_point (&matrix, &vertex->x, &vertex->y, &vertex->z, &w);
 }
 
+/* Returns the transformation from the coordinate space of @self to eye
+ * coordinates, like _clutter_actor_get_relative_transformation_matrix()
+ * with a %NULL ancestor. The result is cached on each actor along the way
+ * to the stage, and reused until any transformation changes. */
+static const CoglMatrix *
+clutter_actor_get_eye_transform (ClutterActor *self)
+{
+  ClutterActorPrivate *priv = self->priv;
+  ClutterActorProjectionCache *cache;
+
+  if (priv->projection_cache == NULL)
+    priv->projection_cache = g_new0 (ClutterActorProjectionCache, 1);
+
+  cache = priv->projection_cache;
+  if (cache->eye_transform_stamp != absolute_transform_stamp)
+    {
+      if (priv->parent != NULL)
+        cache->eye_transform = *clutter_actor_get_eye_transform (priv->parent);
+      else
+        cogl_matrix_init_identity (&cache->eye_transform);
+
+      _clutter_actor_apply_modelview_transform (self, &cache->eye_transform);
+      cache->eye_transform_stamp = absolute_transform_stamp;
+    }
+
+  return &cache->eye_transform;
+}
+
 static gboolean
 _clutter_actor_fully_transform_vertices (ClutterActor             *self,
                                          const graphene_point3d_t *vertices_in,
@@ -2925,7 +2991,7 @@ _clutter_actor_fully_transform_vertices (ClutterActor             *self,
                                          int                       n_vertices)
 {
   ClutterActor *stage;
-  CoglMatrix modelview;
+  const CoglMatrix *modelview;
   CoglMatrix projection;
   float viewport[4];
 
@@ -2938,10 +3004,9 @@ _clutter_actor_fully_transform_vertices (ClutterActor             *self,
   if (stage == NULL)
     return FALSE;
 
-  /* Note: we pass NULL as the ancestor because we don't just want the modelview
-   * that gets us to stage coordinates, we want to go all the way to eye
-   * coordinates */
-  _clutter_actor_get_relative_transformation_matrix (self, NULL, &modelview);
+  /* Note: we don't just want the modelview that gets us to stage
+   * coordinates, we want to go all the way to eye coordinates */
+  modelview = clutter_actor_get_eye_transform (self);
 
   /* Fetch the projection and viewport */
   _clutter_stage_get_projection_matrix (CLUTTER_STAGE (stage), &projection);
@@ -2951,7 +3016,7 @@ _clutter_actor_fully_transform_vertices (ClutterActor             *self,
                                &viewport[2],
                                &viewport[3]);
 
-  _clutter_util_fully_transform_vertices (&modelview,
+  _clutter_util_fully_transform_vertices (modelview,
                                           &projection,
                                           viewport,
                                           vertices_in,
@@ -3029,8 +3094,19 @@ _clutter_actor_transform_and_project_box (ClutterActor          *self,
                                           const ClutterActorBox *box,
                                           graphene_point3d_t    *verts)
 {
+  ClutterActorProjectionCache *cache = self->priv->projection_cache;
   graphene_point3d_t box_vertices[4];
 
+  /* Paint volumes and culling project the same boxes over and over
+   * while nothing moves */
+  if (cache != NULL &&
+      cache->box_stamp == absolute_transform_stamp &&
+      clutter_actor_box_equal (&cache->box, box))
+    {
+      memcpy (verts, cache->box_vertices, sizeof (cache->box_vertices));
+      return TRUE;
+    }
+
   box_vertices[0].x = box->x1;
   box_vertices[0].y = box->y1;
   box_vertices[0].z = 0;
@@ -3044,8 +3120,15 @@ _clutter_actor_transform_and_project_box (ClutterActor          *self,
   box_vertices[3].y = box->y2;
   box_vertices[3].z = 0;
 
-  return
-    _clutter_actor_fully_transform_vertices (self, box_vertices, verts, 4);
+  if (!_clutter_actor_fully_transform_vertices (self, box_vertices, verts, 4))
+    return FALSE;
+
+  cache = self->priv->projection_cache;
+  cache->box = *box;
+  memcpy (cache->box_vertices, verts, sizeof (cache->box_vertices));
+  cache->box_stamp = absolute_transform_stamp;
+
+  return TRUE;
 }
 
 /**
@@ -4386,6 +4469,7 @@ remove_child (ClutterActor *self,
     self->priv->last_child = prev_sibling;
 
   child->priv->parent = NULL;
+  clutter_actor_invalidate_transform (child);
   child->priv->prev_sibling = NULL;
   child->priv->next_sibling = NULL;
 }
@@ -4657,7 +4741,7 @@ clutter_actor_set_pivot_point_internal (ClutterActor           *self,
   info = _clutter_actor_get_transform_info (self);
   info->pivot = *pivot;
 
-  self->priv->transform_valid = FALSE;
+  clutter_actor_invalidate_transform (self);
 
   g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_PIVOT_POINT]);
 
@@ -4673,7 +4757,7 @@ clutter_actor_set_pivot_point_z_internal (ClutterActor *self,
   info = _clutter_actor_get_transform_info (self);
   info->pivot_z = pivot_z;
 
-  self->priv->transform_valid = FALSE;
+  clutter_actor_invalidate_transform (self);
 
   g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_PIVOT_POINT_Z]);
 
@@ -4707,7 +4791,7 @@ clutter_actor_set_translation_internal (ClutterActor *self,
   else
     g_assert_not_reached ();
 
-  self->priv->transform_valid = FALSE;
+  clutter_actor_invalidate_transform (self);
   clutter_actor_queue_redraw (self);
   g_object_notify_by_pspec (obj, pspec);
 }
@@ -4839,7 +4923,7 @@ clutter_actor_set_rotation_angle_internal (ClutterActor *self,
   else
     g_assert_not_reached ();
 
-  self->priv->transform_valid = FALSE;
+  clutter_actor_invalidate_transform (self);
 
   clutter_actor_queue_redraw (self);
 
@@ -4995,7 +5079,7 @@ clutter_actor_set_rotation_center_internal (ClutterActor             *self,
       break;
     }
 
-  self->priv->transform_valid = FALSE;
+  clutter_actor_invalidate_transform (self);
 
   g_object_thaw_notify (obj);
 
@@ -5021,7 +5105,7 @@ clutter_actor_set_scale_factor_internal (ClutterActor *self,
   else
     g_assert_not_reached ();
 
-  self->priv->transform_valid = FALSE;
+  clutter_actor_invalidate_transform (self);
   clutter_actor_queue_redraw (self);
   g_object_notify_by_pspec (obj, pspec);
 }
@@ -5103,7 +5187,7 @@ clutter_actor_set_scale_center (ClutterActor      *self,
       g_assert_not_reached ();
     }
 
-  self->priv->transform_valid = FALSE;
+  clutter_actor_invalidate_transform (self);
 
   clutter_actor_queue_redraw (self);
 
@@ -5125,7 +5209,7 @@ clutter_actor_set_scale_gravity (ClutterActor   *self,
   else
     clutter_anchor_coord_set_gravity (&info->scale_center, gravity);
 
-  self->priv->transform_valid = FALSE;
+  clutter_actor_invalidate_transform (self);
 
   g_object_notify_by_pspec (obj, obj_props[PROP_SCALE_CENTER_X]);
   g_object_notify_by_pspec (obj, obj_props[PROP_SCALE_CENTER_Y]);
@@ -5178,7 +5262,7 @@ clutter_actor_set_anchor_coord (ClutterActor      *self,
       g_assert_not_reached ();
     }
 
-  self->priv->transform_valid = FALSE;
+  clutter_actor_invalidate_transform (self);
 
   clutter_actor_queue_redraw (self);
 
@@ -6210,6 +6294,7 @@ clutter_actor_finalize (GObject *object)
                 g_type_name (G_OBJECT_TYPE (object)));
 
   g_free (priv->name);
+  g_free (priv->projection_cache);
 
 #ifdef CLUTTER_ENABLE_DEBUG
   g_free (priv->debug_name);
@@ -9081,6 +9166,11 @@ _clutter_actor_queue_redraw_full (ClutterActor             *self,
                                        allocation_clip.y1);
     }
 
+  /* Queuing a redraw or clip change invalidates the pick cache, unless the
+   * actor only repaints its contents in place. */
+  if (!(flags & CLUTTER_REDRAW_KEEP_PICK))
+    clutter_stage_invalidate_pick (CLUTTER_STAGE (stage));
+
   self->priv->queue_redraw_entry =
     _clutter_stage_queue_actor_redraw (CLUTTER_STAGE (stage),
                                        priv->queue_redraw_entry,
@@ -12118,7 +12208,7 @@ clutter_actor_set_depth_internal (ClutterActor *self,
       /* Sets Z value - XXX 2.0: should we invert? */
       info->z_position = depth;
 
-      self->priv->transform_valid = FALSE;
+      clutter_actor_invalidate_transform (self);
 
       /* FIXME - remove this crap; sadly, there are still containers
        * in Clutter that depend on this utter brain damage
@@ -12143,7 +12233,7 @@ clutter_actor_set_z_position_internal (ClutterActor *self,
     {
       info->z_position = z_position;
 
-      self->priv->transform_valid = FALSE;
+      clutter_actor_invalidate_transform (self);
 
       clutter_actor_queue_redraw (self);
 
@@ -12715,6 +12805,7 @@ insert_child_at_depth (ClutterActor *self,
   float child_depth;
 
   child->priv->parent = self;
+  clutter_actor_invalidate_transform (child);
 
   child_depth =
     _clutter_actor_get_transform_info_or_defaults (child)->z_position;
@@ -12786,6 +12877,7 @@ insert_child_at_index (ClutterActor *self,
   gint index_ = GPOINTER_TO_INT (data_);
 
   child->priv->parent = self;
+  clutter_actor_invalidate_transform (child);
 
   if (index_ == 0)
     {
@@ -12848,6 +12940,7 @@ insert_child_above (ClutterActor *self,
   ClutterActor *sibling = data;
 
   child->priv->parent = self;
+  clutter_actor_invalidate_transform (child);
 
   if (sibling == NULL)
     sibling = self->priv->last_child;
@@ -12883,6 +12976,7 @@ insert_child_below (ClutterActor *self,
   ClutterActor *sibling = data;
 
   child->priv->parent = self;
+  clutter_actor_invalidate_transform (child);
 
   if (sibling == NULL)
     sibling = self->priv->first_child;
@@ -13527,6 +13621,7 @@ insert_child_between (ClutterActor *self,
   ClutterActor *next_sibling = data->next_sibling;
 
   child->priv->parent = self;
+  clutter_actor_invalidate_transform (child);
   child->priv->prev_sibling = prev_sibling;
   child->priv->next_sibling = next_sibling;
 
@@ -13979,7 +14074,7 @@ clutter_actor_set_anchor_point (ClutterActor *self,
 
   if (changed)
     {
-      priv->transform_valid = FALSE;
+      clutter_actor_invalidate_transform (self);
       clutter_actor_queue_redraw (self);
     }
 
@@ -14149,7 +14244,7 @@ clutter_actor_set_anchor_point_from_gravity (ClutterActor   *self,
       g_object_notify_by_pspec (obj, obj_props[PROP_ANCHOR_X]);
       g_object_notify_by_pspec (obj, obj_props[PROP_ANCHOR_Y]);
 
-      self->priv->transform_valid = FALSE;
+      clutter_actor_invalidate_transform (self);
 
       clutter_actor_queue_redraw (self);
 
@@ -15000,6 +15095,182 @@ clutter_actor_set_final_state (ClutterAnimatable *animatable,
   g_free (p_name);
 }
 
+/* Actors written to by transitions during the current master clock
+ * tick; their notifications are frozen until the tick is over, so that
+ * several transitions on the same actor only dispatch once
+ */
+static GPtrArray *notify_batch = NULL;
+
+void
+_clutter_actor_begin_notify_batch (void)
+{
+  g_assert (notify_batch == NULL);
+
+  notify_batch = g_ptr_array_new ();
+}
+
+void
+_clutter_actor_end_notify_batch (void)
+{
+  GPtrArray *batch = notify_batch;
+  unsigned int i;
+
+  g_assert (notify_batch != NULL);
+
+  /* Thawing might run handlers that animate actors on their own */
+  notify_batch = NULL;
+
+  for (i = 0; i < batch->len; i++)
+    {
+      ClutterActor *actor = g_ptr_array_index (batch, i);
+
+      actor->priv->in_notify_batch = FALSE;
+      g_object_thaw_notify (G_OBJECT (actor));
+      g_object_unref (actor);
+    }
+
+  g_ptr_array_free (batch, TRUE);
+}
+
+static inline void
+clutter_actor_add_to_notify_batch (ClutterActor *self)
+{
+  if (notify_batch == NULL || self->priv->in_notify_batch)
+    return;
+
+  self->priv->in_notify_batch = TRUE;
+  g_object_freeze_notify (G_OBJECT (self));
+  g_ptr_array_add (notify_batch, g_object_ref (self));
+}
+
+/*< private >
+ * _clutter_actor_is_scalar_animatable_property:
+ * @animatable: a #ClutterAnimatable
+ * @pspec: a #GParamSpec returned by clutter_animatable_find_property()
+ *
+ * Checks whether @pspec is one of the numeric #ClutterActor properties
+ * that _clutter_actor_set_animatable_scalar() can write directly.
+ *
+ * Subclasses overriding the #ClutterAnimatable implementation of
+ * #ClutterActor always take the generic path.
+ *
+ * Return value: %TRUE if the property can be set as a scalar
+ */
+gboolean
+_clutter_actor_is_scalar_animatable_property (ClutterAnimatable *animatable,
+                                              GParamSpec        *pspec)
+{
+  ClutterAnimatableInterface *iface;
+
+  if (!CLUTTER_IS_ACTOR (animatable))
+    return FALSE;
+
+  iface = CLUTTER_ANIMATABLE_GET_IFACE (animatable);
+  if (iface->set_final_state != clutter_actor_set_final_state ||
+      iface->interpolate_value != NULL)
+    return FALSE;
+
+  if (pspec->owner_type != CLUTTER_TYPE_ACTOR ||
+      pspec->param_id >= PROP_LAST ||
+      obj_props[pspec->param_id] != pspec)
+    return FALSE;
+
+  switch (pspec->param_id)
+    {
+    case PROP_X:
+    case PROP_Y:
+    case PROP_WIDTH:
+    case PROP_HEIGHT:
+    case PROP_Z_POSITION:
+    case PROP_OPACITY:
+    case PROP_PIVOT_POINT_Z:
+    case PROP_TRANSLATION_X:
+    case PROP_TRANSLATION_Y:
+    case PROP_TRANSLATION_Z:
+    case PROP_SCALE_X:
+    case PROP_SCALE_Y:
+    case PROP_SCALE_Z:
+    case PROP_ROTATION_ANGLE_X:
+    case PROP_ROTATION_ANGLE_Y:
+    case PROP_ROTATION_ANGLE_Z:
+      return TRUE;
+
+    default:
+      return FALSE;
+    }
+}
+
+/*< private >
+ * _clutter_actor_set_animatable_scalar:
+ * @self: a #ClutterActor
+ * @pspec: a #GParamSpec accepted by
+ *   _clutter_actor_is_scalar_animatable_property()
+ * @value: the new value of the property
+ *
+ * Sets a numeric animatable property without going through a #GValue,
+ * the same way clutter_actor_set_animatable_property() would. While the
+ * master clock advances the timelines, notifications are batched.
+ */
+void
+_clutter_actor_set_animatable_scalar (ClutterActor *self,
+                                      GParamSpec   *pspec,
+                                      double        value)
+{
+  clutter_actor_add_to_notify_batch (self);
+
+  switch (pspec->param_id)
+    {
+    case PROP_X:
+      clutter_actor_set_x_internal (self, value);
+      break;
+
+    case PROP_Y:
+      clutter_actor_set_y_internal (self, value);
+      break;
+
+    case PROP_WIDTH:
+      clutter_actor_set_width_internal (self, value);
+      break;
+
+    case PROP_HEIGHT:
+      clutter_actor_set_height_internal (self, value);
+      break;
+
+    case PROP_Z_POSITION:
+      clutter_actor_set_z_position_internal (self, value);
+      break;
+
+    case PROP_OPACITY:
+      clutter_actor_set_opacity_internal (self, (guint) value);
+      break;
+
+    case PROP_PIVOT_POINT_Z:
+      clutter_actor_set_pivot_point_z_internal (self, value);
+      break;
+
+    case PROP_TRANSLATION_X:
+    case PROP_TRANSLATION_Y:
+    case PROP_TRANSLATION_Z:
+      clutter_actor_set_translation_internal (self, value, pspec);
+      break;
+
+    case PROP_SCALE_X:
+    case PROP_SCALE_Y:
+    case PROP_SCALE_Z:
+      clutter_actor_set_scale_factor_internal (self, value, pspec);
+      break;
+
+    case PROP_ROTATION_ANGLE_X:
+    case PROP_ROTATION_ANGLE_Y:
+    case PROP_ROTATION_ANGLE_Z:
+      clutter_actor_set_rotation_angle_internal (self, value, pspec);
+      break;
+
+    default:
+      g_assert_not_reached ();
+    }
+}
+
 static void
 clutter_animatable_iface_init (ClutterAnimatableInterface *iface)
 {
@@ -16197,7 +16468,7 @@ clutter_actor_set_transform_internal (ClutterActor        *self,
   info->transform = *transform;
   info->transform_set = !cogl_matrix_is_identity (&info->transform);
 
-  self->priv->transform_valid = FALSE;
+  clutter_actor_invalidate_transform (self);
 
   clutter_actor_queue_redraw (self);
 
@@ -16321,6 +16592,44 @@ clutter_actor_has_damage (ClutterActor *actor)
   return actor->priv->is_dirty;
 }
 
+/**
+ * clutter_actor_queue_damage_redraw: (skip)
+ * @self: A #ClutterActor
+ * @clip: the actor-relative area whose contents changed
+ *
+ * Queues a redraw of @clip, like clutter_actor_queue_redraw_with_clip(),
+ * for when only the contents @self paints changed. The stage keeps its
+ * pick stack, so input devices moving afterwards don't cause the whole
+ * stage to be picked again. Anything affecting where @self is or which
+ * parts of it are reactive must still invalidate the pick, either through
+ * a regular redraw or clutter_stage_invalidate_pick().
+ */
+void
+clutter_actor_queue_damage_redraw (ClutterActor                *self,
+                                   const cairo_rectangle_int_t *clip)
+{
+  ClutterPaintVolume volume;
+  graphene_point3d_t origin;
+
+  g_return_if_fail (CLUTTER_IS_ACTOR (self));
+  g_return_if_fail (clip != NULL);
+
+  _clutter_paint_volume_init_static (&volume, self);
+
+  origin.x = clip->x;
+  origin.y = clip->y;
+  origin.z = 0.0f;
+
+  clutter_paint_volume_set_origin (&volume, &origin);
+  clutter_paint_volume_set_width (&volume, clip->width);
+  clutter_paint_volume_set_height (&volume, clip->height);
+
+  _clutter_actor_queue_redraw_full (self, CLUTTER_REDRAW_KEEP_PICK,
+                                    &volume, NULL);
+
+  clutter_paint_volume_free (&volume);
+}
+
 static gboolean
 set_direction_recursive (ClutterActor *actor,
                          gpointer      user_data)
@@ -20608,7 +20917,7 @@ clutter_actor_set_child_transform_internal (ClutterActor        *self,
   /* we need to reset the transform_valid flag on each child */
   clutter_actor_iter_init (&iter, self);
   while (clutter_actor_iter_next (&iter, &child))
-    child->priv->transform_valid = FALSE;
+    clutter_actor_invalidate_transform (child);
 
   clutter_actor_queue_redraw (self);
 
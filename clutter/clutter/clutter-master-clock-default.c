@@ -33,6 +33,7 @@
 
 #include "clutter-master-clock.h"
 #include "clutter-master-clock-default.h"
+#include "clutter-actor-private.h"
 #include "clutter-debug.h"
 #include "clutter-private.h"
 #include "clutter-stage-manager-private.h"
@@ -334,9 +335,13 @@ master_clock_advance_timelines (ClutterMasterClockDefault *master_clock)
   timelines = g_slist_copy (master_clock->timelines);
   g_slist_foreach (timelines, (GFunc) g_object_ref, NULL);
 
+  _clutter_actor_begin_notify_batch ();
+
   for (l = timelines; l != NULL; l = l->next)
     _clutter_timeline_do_tick (l->data, master_clock->cur_tick / 1000);
 
+  _clutter_actor_end_notify_batch ();
+
   g_slist_free_full (timelines, g_object_unref);
 
 #ifdef CLUTTER_ENABLE_DEBUG
@@ -60,6 +60,13 @@ void clutter_stage_update_resource_scales (ClutterStage *stage);
 CLUTTER_EXPORT
 gboolean clutter_actor_has_damage (ClutterActor *actor);
 
+CLUTTER_EXPORT
+void clutter_actor_queue_damage_redraw (ClutterActor                *self,
+                                        const cairo_rectangle_int_t *clip);
+
+CLUTTER_EXPORT
+void clutter_stage_invalidate_pick (ClutterStage *stage);
+
 #undef __CLUTTER_H_INSIDE__
 
 #endif /* __CLUTTER_MUTTER_H__ */
@@ -34,6 +34,7 @@
 
 #include "clutter-property-transition.h"
 
+#include "clutter-actor-private.h"
 #include "clutter-animatable.h"
 #include "clutter-debug.h"
 #include "clutter-interval.h"
@@ -45,6 +46,9 @@ struct _ClutterPropertyTransitionPrivate
   char *property_name;
 
   GParamSpec *pspec;
+
+  /* the property can be interpolated without a GValue */
+  guint is_scalar : 1;
 };
 
 enum
@@ -109,6 +113,9 @@ clutter_property_transition_attached (ClutterTransition *transition,
   if (priv->pspec == NULL)
     return;
 
+  priv->is_scalar =
+    _clutter_actor_is_scalar_animatable_property (animatable, priv->pspec);
+
   interval = clutter_transition_get_interval (transition);
   if (interval == NULL)
     return;
@@ -123,7 +130,76 @@ clutter_property_transition_detached (ClutterTransition *transition,
   ClutterPropertyTransition *self = CLUTTER_PROPERTY_TRANSITION (transition);
   ClutterPropertyTransitionPrivate *priv = self->priv;
 
-  priv->pspec = NULL; 
+  priv->pspec = NULL;
+  priv->is_scalar = FALSE;
+}
+
+/*
+ * Interpolates numeric intervals on #ClutterActor properties directly,
+ * skipping the #GValue transformations and the property lookup of the
+ * generic path; the results match clutter_interval_compute_value()
+ * followed by g_value_transform().
+ */
+static gboolean
+clutter_property_transition_compute_scalar (ClutterPropertyTransition *self,
+                                            ClutterAnimatable         *animatable,
+                                            ClutterInterval           *interval,
+                                            gdouble                    progress)
+{
+  ClutterPropertyTransitionPrivate *priv = self->priv;
+  const GValue *initial, *final;
+  GType i_type;
+  double res;
+
+  /* subclasses and progress functions may interpolate differently */
+  if (G_OBJECT_TYPE (interval) != CLUTTER_TYPE_INTERVAL)
+    return FALSE;
+
+  i_type = clutter_interval_get_value_type (interval);
+  if (_clutter_has_progress_function (i_type))
+    return FALSE;
+
+  initial = clutter_interval_peek_initial_value (interval);
+  final = clutter_interval_peek_final_value (interval);
+
+  switch (i_type)
+    {
+    case G_TYPE_FLOAT:
+      {
+        double ia = g_value_get_float (initial);
+        double ib = g_value_get_float (final);
+
+        res = (float) ((progress * (ib - ia)) + ia);
+      }
+      break;
+
+    case G_TYPE_DOUBLE:
+      {
+        double ia = g_value_get_double (initial);
+        double ib = g_value_get_double (final);
+
+        res = (progress * (ib - ia)) + ia;
+      }
+      break;
+
+    case G_TYPE_UINT:
+      {
+        guint ia = g_value_get_uint (initial);
+        guint ib = g_value_get_uint (final);
+
+        res = (guint) ((progress * (ib - (double) ia)) + ia);
+      }
+      break;
+
+    default:
+      return FALSE;
+    }
+
+  _clutter_actor_set_animatable_scalar (CLUTTER_ACTOR (animatable),
+                                        priv->pspec,
+                                        res);
+
+  return TRUE;
 }
 
 static void
@@ -144,6 +220,11 @@ clutter_property_transition_compute_value (ClutterTransition *transition,
 
   clutter_property_transition_ensure_interval (self, animatable, interval);
 
+  if (priv->is_scalar &&
+      clutter_property_transition_compute_scalar (self, animatable,
+                                                  interval, progress))
+    return;
+
   p_type = G_PARAM_SPEC_VALUE_TYPE (priv->pspec);
   i_type = clutter_interval_get_value_type (interval);
 
@@ -323,6 +404,7 @@ clutter_property_transition_set_property_name (ClutterPropertyTransition *transi
   g_free (priv->property_name);
   priv->property_name = g_strdup (property_name);
   priv->pspec = NULL;
+  priv->is_scalar = FALSE;
 
   animatable =
     clutter_transition_get_animatable (CLUTTER_TRANSITION (transition));
@@ -330,6 +412,10 @@ clutter_property_transition_set_property_name (ClutterPropertyTransition *transi
     {
       priv->pspec = clutter_animatable_find_property (animatable,
                                                       priv->property_name);
+      if (priv->pspec != NULL)
+        priv->is_scalar =
+          _clutter_actor_is_scalar_animatable_property (animatable,
+                                                        priv->pspec);
     }
 
   g_object_notify_by_pspec (G_OBJECT (transition),
@@ -49,6 +49,8 @@ CLUTTER_EXPORT
 ClutterStageWindow *_clutter_stage_get_window            (ClutterStage          *stage);
 void                _clutter_stage_get_projection_matrix (ClutterStage          *stage,
                                                           CoglMatrix            *projection);
+gboolean            _clutter_stage_get_inverse_view_matrix (ClutterStage        *stage,
+                                                            CoglMatrix          *inverse);
 void                _clutter_stage_dirty_projection      (ClutterStage          *stage);
 void                _clutter_stage_set_viewport          (ClutterStage          *stage,
                                                           float                  x,
@@ -2401,6 +2401,7 @@ clutter_stage_set_perspective_internal (ClutterStage       *stage,
   cogl_matrix_get_inverse (&priv->projection,
                            &priv->inverse_projection);
 
+  _clutter_actor_invalidate_absolute_transforms ();
   _clutter_stage_dirty_projection (stage);
   clutter_actor_queue_redraw (CLUTTER_ACTOR (stage));
 }
@@ -2475,6 +2476,17 @@ _clutter_stage_get_projection_matrix (ClutterStage *stage,
   *projection = stage->priv->projection;
 }
 
+gboolean
+_clutter_stage_get_inverse_view_matrix (ClutterStage *stage,
+                                        CoglMatrix   *inverse)
+{
+  g_return_val_if_fail (CLUTTER_IS_STAGE (stage), FALSE);
+  g_return_val_if_fail (inverse != NULL, FALSE);
+
+  /* The inverse is cached in the matrix itself until the view changes */
+  return cogl_matrix_get_inverse (&stage->priv->view, inverse);
+}
+
 /* This simply provides a simple mechanism for us to ensure that
  * the projection matrix gets re-asserted before painting.
  *
@@ -3271,6 +3283,8 @@ clutter_stage_update_view_perspective (ClutterStage *stage)
                                       z_2d,
                                       priv->viewport[2],
                                       priv->viewport[3]);
+
+  _clutter_actor_invalidate_absolute_transforms ();
 }
 
 void
@@ -3748,12 +3762,6 @@ _clutter_stage_queue_actor_redraw (ClutterStage                 *stage,
   CLUTTER_NOTE (CLIPPING, "stage_queue_actor_redraw (actor=%s, clip=%p): ",
                 _clutter_actor_get_debug_name (actor), clip);
 
-  /* Queuing a redraw or clip change invalidates the pick cache, unless we're
-   * in the middle of building it. So we reset the cached flag but don't
-   * completely clear the pick stack...
-   */
-  priv->cached_pick_mode = CLUTTER_PICK_NONE;
-
   if (!priv->redraw_pending)
     {
       ClutterMasterClock *master_clock;
@@ -4538,6 +4546,24 @@ clutter_stage_thaw_updates (ClutterStage *stage)
     }
 }
 
+/**
+ * clutter_stage_invalidate_pick: (skip)
+ * @stage: a #ClutterStage
+ *
+ * Invalidates the cached pick of @stage, e.g. because the reactive area of
+ * an actor changed without its geometry changing.
+ */
+void
+clutter_stage_invalidate_pick (ClutterStage *stage)
+{
+  ClutterStagePrivate *priv = stage->priv;
+
+  /* This may be called while the pick stack is being built. So we reset the
+   * cached flag but don't completely clear the pick stack...
+   */
+  priv->cached_pick_mode = CLUTTER_PICK_NONE;
+}
+
 GList *
 _clutter_stage_peek_stage_views (ClutterStage *stage)
 {
@@ -49,6 +49,12 @@
 
 #include "cogl/cogl-trace.h"
 
+typedef enum _ClutterStageCoglClipStrategy
+{
+  CLUTTER_STAGE_COGL_CLIP_STRATEGY_BOUNDING_BOX,
+  CLUTTER_STAGE_COGL_CLIP_STRATEGY_REGION,
+} ClutterStageCoglClipStrategy;
+
 typedef struct _ClutterStageViewCoglPrivate
 {
   /*
@@ -664,6 +670,105 @@ calculate_scissor_region (cairo_rectangle_int_t *fb_clip_region,
     out_scissor_rect->height -= 2 * subpixel_compensation;
 }
 
+static void
+paint_stage_scissored (ClutterStageCogl *stage_cogl,
+                       ClutterStageView *view,
+                       cairo_region_t   *fb_clip_region,
+                       int               subpixel_compensation)
+{
+  CoglFramebuffer *fb = clutter_stage_view_get_framebuffer (view);
+  cairo_rectangle_int_t clip_rect;
+  cairo_rectangle_int_t scissor_rect;
+
+  cairo_region_get_extents (fb_clip_region, &clip_rect);
+
+  calculate_scissor_region (&clip_rect,
+                            subpixel_compensation,
+                            cogl_framebuffer_get_width (fb),
+                            cogl_framebuffer_get_height (fb),
+                            &scissor_rect);
+
+  CLUTTER_NOTE (CLIPPING,
+                "Stage clip pushed: x=%d, y=%d, width=%d, height=%d\n",
+                scissor_rect.x,
+                scissor_rect.y,
+                scissor_rect.width,
+                scissor_rect.height);
+
+  cogl_framebuffer_push_scissor_clip (fb,
+                                      scissor_rect.x,
+                                      scissor_rect.y,
+                                      scissor_rect.width,
+                                      scissor_rect.height);
+
+  paint_stage (stage_cogl, view, fb_clip_region);
+
+  cogl_framebuffer_pop_clip (fb);
+}
+
+static ClutterStageCoglClipStrategy
+choose_clip_strategy (cairo_region_t *fb_clip_region)
+{
+  cairo_rectangle_int_t extents;
+  int64_t extents_area;
+  int64_t region_area = 0;
+  int n_rects;
+  int i;
+
+  n_rects = cairo_region_num_rectangles (fb_clip_region);
+  cairo_region_get_extents (fb_clip_region, &extents);
+  extents_area = (int64_t) extents.width * extents.height;
+
+  for (i = 0; i < n_rects; i++)
+    {
+      cairo_rectangle_int_t rect;
+
+      cairo_region_get_rectangle (fb_clip_region, i, &rect);
+      region_area += (int64_t) rect.width * rect.height;
+    }
+
+  /* When the damage covers most of its extents, painting the few extra
+   * pixels is cheaper than any form of exact clipping */
+  if (region_area * 4 >= extents_area * 3)
+    return CLUTTER_STAGE_COGL_CLIP_STRATEGY_BOUNDING_BOX;
+
+  /* Cogl applies the region with window rectangles when the driver supports
+   * enough of them, and with the stencil buffer otherwise. */
+  return CLUTTER_STAGE_COGL_CLIP_STRATEGY_REGION;
+}
+
+static void
+paint_stage_clipped (ClutterStageCogl *stage_cogl,
+                     ClutterStageView *view,
+                     cairo_region_t   *fb_clip_region,
+                     int               subpixel_compensation)
+{
+  CoglFramebuffer *fb = clutter_stage_view_get_framebuffer (view);
+
+  switch (choose_clip_strategy (fb_clip_region))
+    {
+    case CLUTTER_STAGE_COGL_CLIP_STRATEGY_BOUNDING_BOX:
+      {
+        COGL_TRACE_BEGIN_SCOPED (ClutterStageCoglPaintBoundingBox,
+                                 "Paint (bounding box clip)");
+
+        paint_stage_scissored (stage_cogl, view, fb_clip_region,
+                               subpixel_compensation);
+        break;
+      }
+    case CLUTTER_STAGE_COGL_CLIP_STRATEGY_REGION:
+      {
+        COGL_TRACE_BEGIN_SCOPED (ClutterStageCoglPaintRegion,
+                                 "Paint (region clip)");
+
+        cogl_framebuffer_push_region_clip (fb, fb_clip_region);
+        paint_stage (stage_cogl, view, fb_clip_region);
+        cogl_framebuffer_pop_clip (fb);
+        break;
+      }
+    }
+}
+
 static inline gboolean
 is_buffer_age_enabled (void)
 {
@@ -698,14 +803,11 @@ clutter_stage_cogl_redraw_view (ClutterStageWindow *stage_window,
   gboolean clip_region_empty;
   float fb_scale;
   int subpixel_compensation = 0;
-  int fb_width, fb_height;
 
   wrapper = CLUTTER_ACTOR (stage_cogl->wrapper);
 
   clutter_stage_view_get_layout (view, &view_rect);
   fb_scale = clutter_stage_view_get_scale (view);
-  fb_width = cogl_framebuffer_get_width (fb);
-  fb_height = cogl_framebuffer_get_height (fb);
 
   can_blit_sub_buffer =
     cogl_is_onscreen (fb) &&
@@ -875,41 +977,10 @@ clutter_stage_cogl_redraw_view (ClutterStageWindow *stage_window,
     }
   else if (use_clipped_redraw)
     {
-      cairo_rectangle_int_t clip_rect;
-      cairo_rectangle_int_t scissor_rect;
-
       stage_cogl->using_clipped_redraw = TRUE;
 
-      if (cairo_region_num_rectangles (fb_clip_region) == 1)
-        {
-          cairo_region_get_extents (fb_clip_region, &clip_rect);
-
-          calculate_scissor_region (&clip_rect,
-                                    subpixel_compensation,
-                                    fb_width, fb_height,
-                                    &scissor_rect);
-
-          CLUTTER_NOTE (CLIPPING,
-                        "Stage clip pushed: x=%d, y=%d, width=%d, height=%d\n",
-                        scissor_rect.x,
-                        scissor_rect.y,
-                        scissor_rect.width,
-                        scissor_rect.height);
-
-          cogl_framebuffer_push_scissor_clip (fb,
-                                              scissor_rect.x,
-                                              scissor_rect.y,
-                                              scissor_rect.width,
-                                              scissor_rect.height);
-        }
-      else
-        {
-          cogl_framebuffer_push_region_clip (fb, fb_clip_region);
-        }
-
-      paint_stage (stage_cogl, view, fb_clip_region);
-
-      cogl_framebuffer_pop_clip (fb);
+      paint_stage_clipped (stage_cogl, view, fb_clip_region,
+                           subpixel_compensation);
 
       stage_cogl->using_clipped_redraw = FALSE;
     }
@@ -923,25 +994,8 @@ clutter_stage_cogl_redraw_view (ClutterStageWindow *stage_window,
           may_use_clipped_redraw &&
           !clip_region_empty)
         {
-          cairo_rectangle_int_t clip_rect;
-          cairo_rectangle_int_t scissor_rect;
-
-          cairo_region_get_extents (fb_clip_region, &clip_rect);
-
-          calculate_scissor_region (&clip_rect,
-                                    subpixel_compensation,
-                                    fb_width, fb_height,
-                                    &scissor_rect);
-
-          cogl_framebuffer_push_scissor_clip (fb,
-                                              scissor_rect.x,
-                                              scissor_rect.y,
-                                              scissor_rect.width,
-                                              scissor_rect.height);
-
-          paint_stage (stage_cogl, view, fb_clip_region);
-
-          cogl_framebuffer_pop_clip (fb);
+          paint_stage_scissored (stage_cogl, view, fb_clip_region,
+                                 subpixel_compensation);
         }
       else
         {
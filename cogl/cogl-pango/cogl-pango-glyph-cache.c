@@ -284,7 +284,8 @@ cogl_pango_glyph_cache_add_to_local_atlas (CoglPangoGlyphCache *cache,
     {
       atlas = _cogl_atlas_new (COGL_PIXEL_FORMAT_A_8,
                                COGL_ATLAS_CLEAR_TEXTURE |
-                               COGL_ATLAS_DISABLE_MIGRATION,
+                               COGL_ATLAS_DISABLE_MIGRATION |
+                               COGL_ATLAS_MULTI_PAGE,
                                cogl_pango_glyph_cache_update_position_cb);
       COGL_NOTE (ATLAS, "Created new atlas for glyphs: %p", atlas);
       /* If we still can't reserve space then something has gone
@@ -124,10 +124,9 @@ _cogl_atlas_texture_pre_reorganize_cb (void *data)
    */
   cogl_flush ();
 
-  if (atlas->map)
-    _cogl_rectangle_map_foreach (atlas->map,
-                                 _cogl_atlas_texture_pre_reorganize_foreach_cb,
-                                 NULL);
+  _cogl_atlas_foreach (atlas,
+                       _cogl_atlas_texture_pre_reorganize_foreach_cb,
+                       NULL);
 }
 
 typedef struct
@@ -151,25 +150,27 @@ static void
 _cogl_atlas_texture_post_reorganize_cb (void *user_data)
 {
   CoglAtlas *atlas = user_data;
+  unsigned int n_rectangles;
 
   _COGL_GET_CONTEXT (ctx, NO_RETVAL);
 
-  if (atlas->map)
+  n_rectangles = _cogl_atlas_get_n_rectangles (atlas);
+
+  if (n_rectangles > 0)
     {
       CoglAtlasTextureGetRectanglesData data;
       unsigned int i;
 
-      data.textures = g_new (CoglAtlasTexture *,
-                             _cogl_rectangle_map_get_n_rectangles (atlas->map));
+      data.textures = g_new (CoglAtlasTexture *, n_rectangles);
       data.n_textures = 0;
 
       /* We need to remove all of the references that we took during
          the preorganize callback. We have to get a separate array of
          the textures because CoglRectangleMap doesn't support
          removing rectangles during iteration */
-      _cogl_rectangle_map_foreach (atlas->map,
-                                   _cogl_atlas_texture_get_rectangles_cb,
-                                   &data);
+      _cogl_atlas_foreach (atlas,
+                           _cogl_atlas_texture_get_rectangles_cb,
+                           &data);
 
       for (i = 0; i < data.n_textures; i++)
         {
@@ -203,7 +204,7 @@ _cogl_atlas_texture_create_atlas (CoglContext *ctx)
   static CoglUserDataKey atlas_private_key;
 
   CoglAtlas *atlas = _cogl_atlas_new (COGL_PIXEL_FORMAT_RGBA_8888,
-                                      0,
+                                      COGL_ATLAS_MULTI_PAGE,
                                       _cogl_atlas_texture_update_position_cb);
 
   _cogl_atlas_add_reorganize_callback (atlas,
@@ -264,12 +265,21 @@ _cogl_atlas_texture_gl_flush_legacy_texobj_wrap_modes (CoglTexture *tex,
                                                    wrap_mode_p);
 }
 
+static CoglTexture *
+_cogl_atlas_texture_get_atlas_page (CoglAtlasTexture *atlas_tex)
+{
+  /* While the texture is in an atlas the sub texture points into the
+     atlas page holding it */
+  return cogl_sub_texture_get_parent (COGL_SUB_TEXTURE (atlas_tex->sub_texture));
+}
+
 static void
 _cogl_atlas_texture_remove_from_atlas (CoglAtlasTexture *atlas_tex)
 {
   if (atlas_tex->atlas)
     {
       _cogl_atlas_remove (atlas_tex->atlas,
+                          _cogl_atlas_texture_get_atlas_page (atlas_tex),
                           &atlas_tex->rectangle);
 
       cogl_object_unref (atlas_tex->atlas);
@@ -386,6 +396,7 @@ _cogl_atlas_texture_migrate_out_of_atlas (CoglAtlasTexture *atlas_tex)
 
   standalone_tex =
     _cogl_atlas_copy_rectangle (atlas_tex->atlas,
+                                _cogl_atlas_texture_get_atlas_page (atlas_tex),
                                 atlas_tex->rectangle.x + 1,
                                 atlas_tex->rectangle.y + 1,
                                 atlas_tex->rectangle.width - 2,
@@ -406,14 +417,16 @@ _cogl_atlas_texture_migrate_out_of_atlas (CoglAtlasTexture *atlas_tex)
    * if the CoglTexture is reused with the same texture unit. */
   _cogl_pipeline_texture_storage_change_notify (COGL_TEXTURE (atlas_tex));
 
+  /* The sub texture is needed to find the atlas page to remove the
+     texture from, so this has to happen before replacing it */
+  _cogl_atlas_texture_remove_from_atlas (atlas_tex);
+
   /* We need to unref the sub texture after doing the copy because
      the copy can involve rendering which might cause the texture
      to be used if it is used from a layer that is left in a
      texture unit */
   cogl_object_unref (atlas_tex->sub_texture);
   atlas_tex->sub_texture = standalone_tex;
-
-  _cogl_atlas_texture_remove_from_atlas (atlas_tex);
 }
 
 static void
@@ -454,10 +467,10 @@ _cogl_atlas_texture_set_region_with_border (CoglAtlasTexture *atlas_tex,
                                             CoglBitmap *bmp,
                                             GError **error)
 {
-  CoglAtlas *atlas = atlas_tex->atlas;
+  CoglTexture *page = _cogl_atlas_texture_get_atlas_page (atlas_tex);
 
   /* Copy the central data */
-  if (!_cogl_texture_set_region_from_bitmap (atlas->texture,
+  if (!_cogl_texture_set_region_from_bitmap (page,
                                              src_x, src_y,
                                              dst_width,
                                              dst_height,
@@ -470,7 +483,7 @@ _cogl_atlas_texture_set_region_with_border (CoglAtlasTexture *atlas_tex,
 
   /* Update the left edge pixels */
   if (dst_x == 0 &&
-      !_cogl_texture_set_region_from_bitmap (atlas->texture,
+      !_cogl_texture_set_region_from_bitmap (page,
                                              src_x, src_y,
                                              1, dst_height,
                                              bmp,
@@ -481,7 +494,7 @@ _cogl_atlas_texture_set_region_with_border (CoglAtlasTexture *atlas_tex,
     return FALSE;
   /* Update the right edge pixels */
   if (dst_x + dst_width == atlas_tex->rectangle.width - 2 &&
-      !_cogl_texture_set_region_from_bitmap (atlas->texture,
+      !_cogl_texture_set_region_from_bitmap (page,
                                              src_x + dst_width - 1, src_y,
                                              1, dst_height,
                                              bmp,
@@ -493,7 +506,7 @@ _cogl_atlas_texture_set_region_with_border (CoglAtlasTexture *atlas_tex,
     return FALSE;
   /* Update the top edge pixels */
   if (dst_y == 0 &&
-      !_cogl_texture_set_region_from_bitmap (atlas->texture,
+      !_cogl_texture_set_region_from_bitmap (page,
                                              src_x, src_y,
                                              dst_width, 1,
                                              bmp,
@@ -504,7 +517,7 @@ _cogl_atlas_texture_set_region_with_border (CoglAtlasTexture *atlas_tex,
     return FALSE;
   /* Update the bottom edge pixels */
   if (dst_y + dst_height == atlas_tex->rectangle.height - 2 &&
-      !_cogl_texture_set_region_from_bitmap (atlas->texture,
+      !_cogl_texture_set_region_from_bitmap (page,
                                              src_x, src_y + dst_height - 1,
                                              dst_width, 1,
                                              bmp,
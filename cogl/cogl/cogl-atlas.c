@@ -45,10 +45,62 @@
 
 #include <stdlib.h>
 
+/* Size of the pages added to a COGL_ATLAS_MULTI_PAGE atlas. At 4 bytes
+   per pixel this is 4MB each */
+#define COGL_ATLAS_PAGE_SIZE 1024
+
 static void _cogl_atlas_free (CoglAtlas *atlas);
 
 COGL_OBJECT_INTERNAL_DEFINE (Atlas, atlas);
 
+static void
+_cogl_atlas_page_free (CoglAtlasPage *page)
+{
+  _cogl_rectangle_map_free (page->map);
+  cogl_object_unref (page->texture);
+  g_free (page);
+}
+
+static int
+_cogl_atlas_page_get_waste (CoglAtlasPage *page)
+{
+  /* waste as a percentage */
+  return (_cogl_rectangle_map_get_remaining_space (page->map) * 100 /
+          (_cogl_rectangle_map_get_width (page->map) *
+           _cogl_rectangle_map_get_height (page->map)));
+}
+
+static CoglAtlasPage *
+_cogl_atlas_add_page (CoglAtlas *atlas,
+                      CoglRectangleMap *map,
+                      CoglTexture *texture)
+{
+  CoglAtlasPage *page = g_new0 (CoglAtlasPage, 1);
+
+  page->map = map;
+  page->texture = texture;
+  g_ptr_array_add (atlas->pages, page);
+
+  return page;
+}
+
+static CoglAtlasPage *
+_cogl_atlas_find_page (CoglAtlas *atlas,
+                       CoglTexture *texture)
+{
+  unsigned int i;
+
+  for (i = 0; i < atlas->pages->len; i++)
+    {
+      CoglAtlasPage *page = g_ptr_array_index (atlas->pages, i);
+
+      if (page->texture == texture)
+        return page;
+    }
+
+  return NULL;
+}
+
 CoglAtlas *
 _cogl_atlas_new (CoglPixelFormat texture_format,
                  CoglAtlasFlags flags,
@@ -57,8 +109,11 @@ _cogl_atlas_new (CoglPixelFormat texture_format,
   CoglAtlas *atlas = g_new (CoglAtlas, 1);
 
   atlas->update_position_cb = update_position_cb;
-  atlas->map = NULL;
-  atlas->texture = NULL;
+  atlas->pages =
+    g_ptr_array_new_with_free_func ((GDestroyNotify) _cogl_atlas_page_free);
+  atlas->page_width = 0;
+  atlas->page_height = 0;
+  atlas->compaction_idle_id = 0;
   atlas->flags = flags;
   atlas->texture_format = texture_format;
   g_hook_list_init (&atlas->pre_reorganize_callbacks, sizeof (GHook));
@@ -72,10 +127,9 @@ _cogl_atlas_free (CoglAtlas *atlas)
 {
   COGL_NOTE (ATLAS, "%p: Atlas destroyed", atlas);
 
-  if (atlas->texture)
-    cogl_object_unref (atlas->texture);
-  if (atlas->map)
-    _cogl_rectangle_map_free (atlas->map);
+  if (atlas->compaction_idle_id)
+    g_source_remove (atlas->compaction_idle_id);
+  g_ptr_array_free (atlas->pages, TRUE);
 
   g_hook_list_clear (&atlas->pre_reorganize_callbacks);
   g_hook_list_clear (&atlas->post_reorganize_callbacks);
@@ -169,19 +223,17 @@ _cogl_atlas_get_next_size (unsigned int *map_width,
     *map_height <<= 1;
 }
 
-static void
-_cogl_atlas_get_initial_size (CoglPixelFormat format,
-                              unsigned int *map_width,
-                              unsigned int *map_height)
+static unsigned int
+_cogl_atlas_get_supported_size (CoglPixelFormat format,
+                                unsigned int size)
 {
-  unsigned int size;
   GLenum gl_intformat;
   GLenum gl_format;
   GLenum gl_type;
 
-  _COGL_GET_CONTEXT (ctx, NO_RETVAL);
+  _COGL_GET_CONTEXT (ctx, 0);
 
-  g_return_if_fail (cogl_pixel_format_get_n_planes (format) == 1);
+  g_return_val_if_fail (cogl_pixel_format_get_n_planes (format) == 1, 0);
 
   ctx->driver_vtable->pixel_format_to_gl (ctx,
                                           format,
@@ -189,16 +241,6 @@ _cogl_atlas_get_initial_size (CoglPixelFormat format,
                                           &gl_format,
                                           &gl_type);
 
-  /* At least on Intel hardware, the texture size will be rounded up
-     to at least 1MB so we might as well try to aim for that as an
-     initial minimum size. If the format is only 1 byte per pixel we
-     can use 1024x1024, otherwise we'll assume it will take 4 bytes
-     per pixel and use 512x512. */
-  if (cogl_pixel_format_get_bytes_per_pixel (format, 0) == 1)
-    size = 1024;
-  else
-    size = 512;
-
   /* Some platforms might not support this large size so we'll
      decrease the size until it can */
   while (size > 1 &&
@@ -210,6 +252,28 @@ _cogl_atlas_get_initial_size (CoglPixelFormat format,
                                                size, size))
     size >>= 1;
 
+  return size;
+}
+
+static void
+_cogl_atlas_get_initial_size (CoglPixelFormat format,
+                              unsigned int *map_width,
+                              unsigned int *map_height)
+{
+  unsigned int size;
+
+  /* At least on Intel hardware, the texture size will be rounded up
+     to at least 1MB so we might as well try to aim for that as an
+     initial minimum size. If the format is only 1 byte per pixel we
+     can use 1024x1024, otherwise we'll assume it will take 4 bytes
+     per pixel and use 512x512. */
+  if (cogl_pixel_format_get_bytes_per_pixel (format, 0) == 1)
+    size = 1024;
+  else
+    size = 512;
+
+  size = _cogl_atlas_get_supported_size (format, size);
+
   *map_width = size;
   *map_height = size;
 }
@@ -368,6 +432,98 @@ _cogl_atlas_notify_post_reorganize (CoglAtlas *atlas)
   g_hook_list_invoke (&atlas->post_reorganize_callbacks, FALSE);
 }
 
+static gboolean
+_cogl_atlas_reserve_space_in_pages (CoglAtlas    *atlas,
+                                    unsigned int  width,
+                                    unsigned int  height,
+                                    void         *user_data)
+{
+  unsigned int i;
+
+  /* Try the most recently added pages first as the older ones are
+     more likely to be full */
+  for (i = atlas->pages->len; i > 0; i--)
+    {
+      CoglAtlasPage *page = g_ptr_array_index (atlas->pages, i - 1);
+      CoglRectangleMapEntry new_position;
+
+      if (!_cogl_rectangle_map_add (page->map, width, height,
+                                    user_data,
+                                    &new_position))
+        continue;
+
+      COGL_NOTE (ATLAS, "%p: Atlas is %ix%i, has %i textures and is %i%% waste",
+                 atlas,
+                 _cogl_rectangle_map_get_width (page->map),
+                 _cogl_rectangle_map_get_height (page->map),
+                 _cogl_rectangle_map_get_n_rectangles (page->map),
+                 _cogl_atlas_page_get_waste (page));
+
+      atlas->update_position_cb (user_data,
+                                 page->texture,
+                                 &new_position);
+
+      return TRUE;
+    }
+
+  return FALSE;
+}
+
+static gboolean
+_cogl_atlas_reserve_space_in_new_page (CoglAtlas    *atlas,
+                                       unsigned int  width,
+                                       unsigned int  height,
+                                       void         *user_data)
+{
+  CoglRectangleMap *map;
+  CoglTexture2D *tex;
+  CoglRectangleMapEntry new_position;
+
+  if (atlas->page_width == 0)
+    {
+      atlas->page_width =
+        _cogl_atlas_get_supported_size (atlas->texture_format,
+                                        COGL_ATLAS_PAGE_SIZE);
+      atlas->page_height = atlas->page_width;
+    }
+
+  if (width > atlas->page_width || height > atlas->page_height)
+    {
+      COGL_NOTE (ATLAS, "%p: Texture is too big for an atlas page", atlas);
+      return FALSE;
+    }
+
+  tex = _cogl_atlas_create_texture (atlas,
+                                    atlas->page_width,
+                                    atlas->page_height);
+  if (tex == NULL)
+    {
+      COGL_NOTE (ATLAS, "%p: Could not create a CoglTexture2D", atlas);
+      return FALSE;
+    }
+
+  map = _cogl_rectangle_map_new (atlas->page_width, atlas->page_height, NULL);
+
+  /* The page is empty so this can't fail */
+  _cogl_rectangle_map_add (map, width, height, user_data, &new_position);
+
+  _cogl_atlas_add_page (atlas, map, COGL_TEXTURE (tex));
+
+  COGL_NOTE (ATLAS, "%p: Added page %u with size %ux%u",
+             atlas,
+             atlas->pages->len,
+             atlas->page_width,
+             atlas->page_height);
+
+  /* None of the existing textures move so there is no need to notify
+     about a reorganization */
+  atlas->update_position_cb (user_data,
+                             COGL_TEXTURE (tex),
+                             &new_position);
+
+  return TRUE;
+}
+
 gboolean
 _cogl_atlas_reserve_space (CoglAtlas             *atlas,
                            unsigned int           width,
@@ -375,34 +531,23 @@ _cogl_atlas_reserve_space (CoglAtlas             *atlas,
                            void                  *user_data)
 {
   CoglAtlasGetRectanglesData data;
+  CoglAtlasPage *page;
   CoglRectangleMap *new_map;
   CoglTexture2D *new_tex;
   unsigned int map_width = 0, map_height = 0;
   gboolean ret;
-  CoglRectangleMapEntry new_position;
 
-  /* Check if we can fit the rectangle into the existing map */
-  if (atlas->map &&
-      _cogl_rectangle_map_add (atlas->map, width, height,
-                               user_data,
-                               &new_position))
-    {
-      COGL_NOTE (ATLAS, "%p: Atlas is %ix%i, has %i textures and is %i%% waste",
-                 atlas,
-                 _cogl_rectangle_map_get_width (atlas->map),
-                 _cogl_rectangle_map_get_height (atlas->map),
-                 _cogl_rectangle_map_get_n_rectangles (atlas->map),
-                 /* waste as a percentage */
-                 _cogl_rectangle_map_get_remaining_space (atlas->map) *
-                 100 / (_cogl_rectangle_map_get_width (atlas->map) *
-                        _cogl_rectangle_map_get_height (atlas->map)));
+  /* Check if we can fit the rectangle into the existing pages */
+  if (_cogl_atlas_reserve_space_in_pages (atlas, width, height, user_data))
+    return TRUE;
 
-      atlas->update_position_cb (user_data,
-                                 atlas->texture,
-                                 &new_position);
+  if ((atlas->flags & COGL_ATLAS_MULTI_PAGE))
+    return _cogl_atlas_reserve_space_in_new_page (atlas,
+                                                  width, height,
+                                                  user_data);
 
-      return TRUE;
-    }
+  /* Without multiple pages there is at most the one page to grow */
+  page = atlas->pages->len > 0 ? g_ptr_array_index (atlas->pages, 0) : NULL;
 
   /* If we make it here then we need to reorganize the atlas. First
      we'll notify any users of the atlas that this is going to happen
@@ -412,15 +557,15 @@ _cogl_atlas_reserve_space (CoglAtlas             *atlas,
 
   /* Get an array of all the textures currently in the atlas. */
   data.n_textures = 0;
-  if (atlas->map == NULL)
+  if (page == NULL)
     data.textures = g_malloc (sizeof (CoglAtlasRepositionData));
   else
     {
       unsigned int n_rectangles =
-        _cogl_rectangle_map_get_n_rectangles (atlas->map);
+        _cogl_rectangle_map_get_n_rectangles (page->map);
       data.textures = g_malloc (sizeof (CoglAtlasRepositionData) *
                                 (n_rectangles + 1));
-      _cogl_rectangle_map_foreach (atlas->map,
+      _cogl_rectangle_map_foreach (page->map,
                                    _cogl_atlas_get_rectangles_cb,
                                    &data);
     }
@@ -441,16 +586,16 @@ _cogl_atlas_reserve_space (CoglAtlas             *atlas,
          _cogl_atlas_compare_size_cb);
 
   /* Try to create a new atlas that can contain all of the textures */
-  if (atlas->map)
+  if (page)
     {
-      map_width = _cogl_rectangle_map_get_width (atlas->map);
-      map_height = _cogl_rectangle_map_get_height (atlas->map);
+      map_width = _cogl_rectangle_map_get_width (page->map);
+      map_height = _cogl_rectangle_map_get_height (page->map);
 
       /* If there is enough space in for the new rectangle in the
          existing atlas with at least 6% waste we'll start with the
          same size, otherwise we'll immediately double it */
       if ((map_width * map_height -
-           _cogl_rectangle_map_get_remaining_space (atlas->map) +
+           _cogl_rectangle_map_get_remaining_space (page->map) +
            width * height) * 53 / 50 >
           map_width * map_height)
         _cogl_atlas_get_next_size (&map_width, &map_height);
@@ -481,53 +626,50 @@ _cogl_atlas_reserve_space (CoglAtlas             *atlas,
     }
   else
     {
-      int waste;
-
       COGL_NOTE (ATLAS,
                  "%p: Atlas %s with size %ix%i",
                  atlas,
-                 atlas->map == NULL ||
-                 _cogl_rectangle_map_get_width (atlas->map) !=
+                 page == NULL ||
+                 _cogl_rectangle_map_get_width (page->map) !=
                  _cogl_rectangle_map_get_width (new_map) ||
-                 _cogl_rectangle_map_get_height (atlas->map) !=
+                 _cogl_rectangle_map_get_height (page->map) !=
                  _cogl_rectangle_map_get_height (new_map) ?
                  "resized" : "reorganized",
                  _cogl_rectangle_map_get_width (new_map),
                  _cogl_rectangle_map_get_height (new_map));
 
-      if (atlas->map)
+      if (page)
         {
           /* Move all the textures to the right position in the new
              texture. This will also update the texture's rectangle */
           _cogl_atlas_migrate (atlas,
                                data.n_textures,
                                data.textures,
-                               atlas->texture,
+                               page->texture,
                                COGL_TEXTURE (new_tex),
                                user_data);
-          _cogl_rectangle_map_free (atlas->map);
-          cogl_object_unref (atlas->texture);
+          _cogl_rectangle_map_free (page->map);
+          cogl_object_unref (page->texture);
+          page->map = new_map;
+          page->texture = COGL_TEXTURE (new_tex);
+          page->removed_space = 0;
         }
       else
-        /* We know there's only one texture so we can just directly
-           update the rectangle from its new position */
-        atlas->update_position_cb (data.textures[0].user_data,
-                                   COGL_TEXTURE (new_tex),
-                                   &data.textures[0].new_position);
-
-      atlas->map = new_map;
-      atlas->texture = COGL_TEXTURE (new_tex);
-
-      waste = (_cogl_rectangle_map_get_remaining_space (atlas->map) *
-               100 / (_cogl_rectangle_map_get_width (atlas->map) *
-                      _cogl_rectangle_map_get_height (atlas->map)));
+        {
+          /* We know there's only one texture so we can just directly
+             update the rectangle from its new position */
+          atlas->update_position_cb (data.textures[0].user_data,
+                                     COGL_TEXTURE (new_tex),
+                                     &data.textures[0].new_position);
+          page = _cogl_atlas_add_page (atlas, new_map, COGL_TEXTURE (new_tex));
+        }
 
       COGL_NOTE (ATLAS, "%p: Atlas is %ix%i, has %i textures and is %i%% waste",
                  atlas,
-                 _cogl_rectangle_map_get_width (atlas->map),
-                 _cogl_rectangle_map_get_height (atlas->map),
-                 _cogl_rectangle_map_get_n_rectangles (atlas->map),
-                 waste);
+                 _cogl_rectangle_map_get_width (page->map),
+                 _cogl_rectangle_map_get_height (page->map),
+                 _cogl_rectangle_map_get_n_rectangles (page->map),
+                 _cogl_atlas_page_get_waste (page));
 
       ret = TRUE;
     }
@@ -539,11 +681,138 @@ _cogl_atlas_reserve_space (CoglAtlas             *atlas,
   return ret;
 }
 
+static void
+_cogl_atlas_compact_page (CoglAtlas     *atlas,
+                          CoglAtlasPage *page)
+{
+  CoglAtlasGetRectanglesData data;
+  CoglRectangleMap *new_map;
+  CoglTexture2D *new_tex;
+  unsigned int map_width, map_height;
+  unsigned int n_rectangles;
+  unsigned int i;
+
+  n_rectangles = _cogl_rectangle_map_get_n_rectangles (page->map);
+  if (n_rectangles == 0)
+    return;
+
+  map_width = _cogl_rectangle_map_get_width (page->map);
+  map_height = _cogl_rectangle_map_get_height (page->map);
+
+  data.textures = g_new (CoglAtlasRepositionData, n_rectangles);
+  data.n_textures = 0;
+  _cogl_rectangle_map_foreach (page->map,
+                               _cogl_atlas_get_rectangles_cb,
+                               &data);
+
+  qsort (data.textures, data.n_textures,
+         sizeof (CoglAtlasRepositionData),
+         _cogl_atlas_compare_size_cb);
+
+  /* Repack the rectangles into a page of the same size so that the
+     free space left behind by removed textures is merged */
+  new_map = _cogl_rectangle_map_new (map_width, map_height, NULL);
+  for (i = 0; i < data.n_textures; i++)
+    if (!_cogl_rectangle_map_add (new_map,
+                                  data.textures[i].old_position.width,
+                                  data.textures[i].old_position.height,
+                                  data.textures[i].user_data,
+                                  &data.textures[i].new_position))
+      break;
+
+  if (i < data.n_textures)
+    {
+      COGL_NOTE (ATLAS, "%p: Could not repack atlas page", atlas);
+      _cogl_rectangle_map_free (new_map);
+      goto out;
+    }
+
+  new_tex = _cogl_atlas_create_texture (atlas, map_width, map_height);
+  if (new_tex == NULL)
+    {
+      COGL_NOTE (ATLAS, "%p: Could not create a CoglTexture2D", atlas);
+      _cogl_rectangle_map_free (new_map);
+      goto out;
+    }
+
+  _cogl_atlas_notify_pre_reorganize (atlas);
+
+  _cogl_atlas_migrate (atlas,
+                       data.n_textures,
+                       data.textures,
+                       page->texture,
+                       COGL_TEXTURE (new_tex),
+                       NULL);
+  _cogl_rectangle_map_free (page->map);
+  cogl_object_unref (page->texture);
+  page->map = new_map;
+  page->texture = COGL_TEXTURE (new_tex);
+
+  COGL_NOTE (ATLAS, "%p: Compacted page, has %i textures and is %i%% waste",
+             atlas,
+             _cogl_rectangle_map_get_n_rectangles (page->map),
+             _cogl_atlas_page_get_waste (page));
+
+  /* This may drop the last reference on textures in the page, so the
+     page can't be used after this */
+  _cogl_atlas_notify_post_reorganize (atlas);
+
+out:
+  g_free (data.textures);
+}
+
+static gboolean
+_cogl_atlas_compact_idle (void *user_data)
+{
+  CoglAtlas *atlas = user_data;
+  gboolean more_pages = FALSE;
+  unsigned int i;
+
+  /* Releasing the textures after compacting may free the atlas */
+  cogl_object_ref (atlas);
+
+  /* Only compact one page per iteration to keep the stalls short */
+  for (i = 0; i < atlas->pages->len; i++)
+    {
+      CoglAtlasPage *page = g_ptr_array_index (atlas->pages, i);
+
+      if (page->needs_compaction)
+        {
+          page->needs_compaction = FALSE;
+          page->removed_space = 0;
+          _cogl_atlas_compact_page (atlas, page);
+          break;
+        }
+    }
+
+  for (i = 0; i < atlas->pages->len; i++)
+    {
+      CoglAtlasPage *page = g_ptr_array_index (atlas->pages, i);
+
+      if (page->needs_compaction)
+        more_pages = TRUE;
+    }
+
+  if (!more_pages)
+    atlas->compaction_idle_id = 0;
+
+  cogl_object_unref (atlas);
+
+  return more_pages ? G_SOURCE_CONTINUE : G_SOURCE_REMOVE;
+}
+
 void
 _cogl_atlas_remove (CoglAtlas *atlas,
+                    CoglTexture *texture,
                     const CoglRectangleMapEntry *rectangle)
 {
-  _cogl_rectangle_map_remove (atlas->map, rectangle);
+  CoglAtlasPage *page = _cogl_atlas_find_page (atlas, texture);
+  unsigned int page_size;
+
+  g_return_if_fail (page != NULL);
+
+  _cogl_rectangle_map_remove (page->map, rectangle);
+  page->removed_space += rectangle->width * rectangle->height;
 
   COGL_NOTE (ATLAS, "%p: Removed rectangle sized %ix%i",
              atlas,
@@ -551,13 +820,73 @@ _cogl_atlas_remove (CoglAtlas *atlas,
              rectangle->height);
   COGL_NOTE (ATLAS, "%p: Atlas is %ix%i, has %i textures and is %i%% waste",
              atlas,
-             _cogl_rectangle_map_get_width (atlas->map),
-             _cogl_rectangle_map_get_height (atlas->map),
-             _cogl_rectangle_map_get_n_rectangles (atlas->map),
-             _cogl_rectangle_map_get_remaining_space (atlas->map) *
-             100 / (_cogl_rectangle_map_get_width (atlas->map) *
-                    _cogl_rectangle_map_get_height (atlas->map)));
-};
+             _cogl_rectangle_map_get_width (page->map),
+             _cogl_rectangle_map_get_height (page->map),
+             _cogl_rectangle_map_get_n_rectangles (page->map),
+             _cogl_atlas_page_get_waste (page));
+
+  if (!(atlas->flags & COGL_ATLAS_MULTI_PAGE))
+    return;
+
+  page_size = (_cogl_rectangle_map_get_width (page->map) *
+               _cogl_rectangle_map_get_height (page->map));
+
+  if (_cogl_rectangle_map_get_n_rectangles (page->map) == 0 &&
+      atlas->pages->len > 1)
+    {
+      COGL_NOTE (ATLAS, "%p: Freeing empty page", atlas);
+      g_ptr_array_remove (atlas->pages, page);
+    }
+  else if (!page->needs_compaction &&
+           _cogl_rectangle_map_get_remaining_space (page->map) * 2 >=
+           page_size &&
+           page->removed_space * 4 >= page_size)
+    {
+      /* Repack mostly empty pages once the application is idle so that
+         their free space can be used for bigger textures again. Only
+         do so once a quarter of the page was freed since it was last
+         packed, so pages that stay half empty aren't repacked after
+         every removal */
+      page->needs_compaction = TRUE;
+
+      if (!atlas->compaction_idle_id)
+        atlas->compaction_idle_id = g_idle_add_full (G_PRIORITY_LOW,
+                                                     _cogl_atlas_compact_idle,
+                                                     atlas,
+                                                     NULL);
+    }
+}
+
+unsigned int
+_cogl_atlas_get_n_rectangles (CoglAtlas *atlas)
+{
+  unsigned int n_rectangles = 0;
+  unsigned int i;
+
+  for (i = 0; i < atlas->pages->len; i++)
+    {
+      CoglAtlasPage *page = g_ptr_array_index (atlas->pages, i);
+
+      n_rectangles += _cogl_rectangle_map_get_n_rectangles (page->map);
+    }
+
+  return n_rectangles;
+}
+
+void
+_cogl_atlas_foreach (CoglAtlas *atlas,
+                     CoglRectangleMapCallback callback,
+                     void *user_data)
+{
+  unsigned int i;
+
+  for (i = 0; i < atlas->pages->len; i++)
+    {
+      CoglAtlasPage *page = g_ptr_array_index (atlas->pages, i);
+
+      _cogl_rectangle_map_foreach (page->map, callback, user_data);
+    }
+}
 
 static CoglTexture *
 create_migration_texture (CoglContext *ctx,
@@ -603,6 +932,7 @@ create_migration_texture (CoglContext *ctx,
 
 CoglTexture *
 _cogl_atlas_copy_rectangle (CoglAtlas *atlas,
+                            CoglTexture *texture,
                             int x,
                             int y,
                             int width,
@@ -627,7 +957,7 @@ _cogl_atlas_copy_rectangle (CoglAtlas *atlas,
   /* Blit the data out of the atlas to the new texture. If FBOs
      aren't available this will end up having to copy the entire
      atlas texture */
-  _cogl_blit_begin (&blit_data, tex, atlas->texture);
+  _cogl_blit_begin (&blit_data, tex, texture);
   _cogl_blit (&blit_data,
                     x, y,
                     0, 0,
@@ -41,25 +41,46 @@ typedef void
 typedef enum
 {
   COGL_ATLAS_CLEAR_TEXTURE     = (1 << 0),
-  COGL_ATLAS_DISABLE_MIGRATION = (1 << 1)
+  COGL_ATLAS_DISABLE_MIGRATION = (1 << 1),
+  /* Add fixed size pages when the atlas is full instead of migrating
+     everything to a bigger texture */
+  COGL_ATLAS_MULTI_PAGE        = (1 << 2)
 } CoglAtlasFlags;
 
 typedef struct _CoglAtlas CoglAtlas;
+typedef struct _CoglAtlasPage CoglAtlasPage;
 
 #define COGL_ATLAS(object) ((CoglAtlas *) object)
 
+struct _CoglAtlasPage
+{
+  CoglRectangleMap *map;
+  CoglTexture *texture;
+
+  /* Area of the rectangles removed since the page was last packed */
+  unsigned int removed_space;
+
+  /* Set when enough was removed since the page was last packed */
+  gboolean needs_compaction;
+};
+
 struct _CoglAtlas
 {
   CoglObject _parent;
 
-  CoglRectangleMap *map;
+  /* Array of CoglAtlasPage. Without COGL_ATLAS_MULTI_PAGE there is at
+     most one page, which grows by migrating to a bigger texture */
+  GPtrArray *pages;
+  unsigned int page_width;
+  unsigned int page_height;
 
-  CoglTexture *texture;
   CoglPixelFormat texture_format;
   CoglAtlasFlags flags;
 
   CoglAtlasUpdatePositionCallback update_position_cb;
 
+  unsigned int compaction_idle_id;
+
   GHookList pre_reorganize_callbacks;
   GHookList post_reorganize_callbacks;
 };
@@ -77,10 +98,20 @@ _cogl_atlas_reserve_space (CoglAtlas             *atlas,
 
 void
 _cogl_atlas_remove (CoglAtlas *atlas,
+                    CoglTexture *texture,
                     const CoglRectangleMapEntry *rectangle);
 
+unsigned int
+_cogl_atlas_get_n_rectangles (CoglAtlas *atlas);
+
+void
+_cogl_atlas_foreach (CoglAtlas *atlas,
+                     CoglRectangleMapCallback callback,
+                     void *user_data);
+
 CoglTexture *
 _cogl_atlas_copy_rectangle (CoglAtlas *atlas,
+                            CoglTexture *texture,
                             int x,
                             int y,
                             int width,
@@ -235,6 +235,9 @@ struct _CoglContext
   GLint             max_texture_image_units;
   GLint             max_activateable_texture_units;
 
+  /* Cached GL_MAX_WINDOW_RECTANGLES_EXT, 0 if the extension is missing */
+  GLint             max_window_rectangles;
+
   /* Fragment processing programs */
   CoglHandle              current_program;
 
@@ -259,6 +262,9 @@ struct _CoglContext
      same state multiple times. When the clip state is flushed this
      will hold a reference */
   CoglClipStack    *current_clip_stack;
+  /* Whether GL_EXT_window_rectangles is currently restricting
+     rendering to the rectangles of a flushed clip region */
+  gboolean          current_gl_window_rectangles_enabled;
 
   /* This is used as a temporary buffer to fill a CoglBuffer when
      cogl_buffer_map fails and we only want to map to fill it with new
@@ -245,6 +245,7 @@ cogl_context_new (CoglDisplay *display,
 
   context->current_clip_stack_valid = FALSE;
   context->current_clip_stack = NULL;
+  context->current_gl_window_rectangles_enabled = FALSE;
 
   context->legacy_backface_culling_enabled = FALSE;
 
@@ -58,6 +58,11 @@ struct _CoglMatrixEntry
   CoglMatrixOp op;
   unsigned int ref_count;
 
+  /* Entries never change once pushed, so once an entry had to be
+   * composed more than once, the result is kept around */
+  CoglMatrix *composite_cache;
+  unsigned int n_composites;
+
 #ifdef COGL_DEBUG_ENABLED
   /* used for performance tracing */
   int composite_gets;
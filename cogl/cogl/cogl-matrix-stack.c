@@ -63,6 +63,8 @@ _cogl_matrix_entry_new (CoglMatrixOp operation)
 
   entry->ref_count = 1;
   entry->op = operation;
+  entry->composite_cache = NULL;
+  entry->n_composites = 0;
 
 #ifdef COGL_DEBUG_ENABLED
   entry->composite_gets = 0;
@@ -136,6 +138,8 @@ _cogl_matrix_entry_identity_init (CoglMatrixEntry *entry)
   entry->ref_count = 1;
   entry->op = COGL_MATRIX_OP_LOAD_IDENTITY;
   entry->parent = NULL;
+  entry->composite_cache = NULL;
+  entry->n_composites = 0;
 #ifdef COGL_DEBUG_ENABLED
   entry->composite_gets = 0;
 #endif
@@ -330,6 +334,10 @@ cogl_matrix_entry_unref (CoglMatrixEntry *entry)
     {
       parent = entry->parent;
 
+      if (entry->composite_cache)
+        _cogl_magazine_chunk_free (cogl_matrix_stack_matrices_magazine,
+                                   entry->composite_cache);
+
       switch (entry->op)
         {
         case COGL_MATRIX_OP_LOAD_IDENTITY:
@@ -435,6 +443,13 @@ cogl_matrix_entry_get (CoglMatrixEntry *entry,
        current;
        current = current->parent, depth++)
     {
+      if (current->composite_cache)
+        {
+          _cogl_matrix_init_from_matrix_without_inverse (matrix,
+                                                         current->composite_cache);
+          goto initialized;
+        }
+
       switch (current->op)
         {
         case COGL_MATRIX_OP_LOAD_IDENTITY:
@@ -470,6 +485,9 @@ initialized:
 
   if (depth == 0)
     {
+      if (entry->composite_cache)
+        return entry->composite_cache;
+
       switch (entry->op)
         {
         case COGL_MATRIX_OP_LOAD_IDENTITY:
@@ -586,6 +604,17 @@ initialized:
         }
     }
 
+  /* Entries composed only once (e.g. transient pick or culling
+   * transforms) aren't worth the allocation */
+  if (++entry->n_composites >= 2)
+    {
+      entry->composite_cache =
+        _cogl_magazine_chunk_alloc (cogl_matrix_stack_matrices_magazine);
+      _cogl_matrix_init_from_matrix_without_inverse (entry->composite_cache,
+                                                     matrix);
+      return entry->composite_cache;
+    }
+
   return NULL;
 }
 
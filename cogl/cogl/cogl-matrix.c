@@ -80,6 +80,24 @@
 #include <math.h>
 #include <string.h>
 
+#include <test-fixtures/test-unit.h>
+
+/* Use vector kernels for the hot operations when the target has them. The
+ * scalar kernels are still built for the unit tests comparing the two. */
+#if defined(__SSE__) && defined(__GNUC__)
+#define COGL_MATRIX_USE_SSE
+#define COGL_MATRIX_USE_SIMD
+#include <xmmintrin.h>
+#elif defined(__ARM_NEON) && defined(__GNUC__)
+#define COGL_MATRIX_USE_NEON
+#define COGL_MATRIX_USE_SIMD
+#include <arm_neon.h>
+#endif
+
+#if !defined(COGL_MATRIX_USE_SIMD) || defined(ENABLE_UNIT_TESTS)
+#define COGL_MATRIX_NEED_SCALAR_MULTIPLY
+#endif
+
 #include <cogl-gtype-private.h>
 COGL_GTYPE_DEFINE_BOXED (Matrix, matrix,
                          cogl_matrix_copy,
@@ -234,6 +252,7 @@ static float identity[16] = {
 #define B(row,col)  b[(col<<2)+row]
 #define R(row,col)  result[(col<<2)+row]
 
+#ifdef COGL_MATRIX_NEED_SCALAR_MULTIPLY
 /*
  * Perform a full 4x4 matrix multiplication.
  *
@@ -242,7 +261,7 @@ static float identity[16] = {
  * <note>KW: 4*16 = 64 multiplications</note>
  */
 static void
-matrix_multiply4x4 (float *result, const float *a, const float *b)
+matrix_multiply4x4_scalar (float *result, const float *a, const float *b)
 {
   int i;
   for (i = 0; i < 4; i++)
@@ -264,7 +283,7 @@ matrix_multiply4x4 (float *result, const float *a, const float *b)
  * @product will receive the product of \p a and \p b.
  */
 static void
-matrix_multiply3x4 (float *result, const float *a, const float *b)
+matrix_multiply3x4_scalar (float *result, const float *a, const float *b)
 {
   int i;
   for (i = 0; i < 3; i++)
@@ -280,6 +299,76 @@ matrix_multiply3x4 (float *result, const float *a, const float *b)
   R(3,2) = 0;
   R(3,3) = 1;
 }
+#endif /* COGL_MATRIX_NEED_SCALAR_MULTIPLY */
+
+#if defined(COGL_MATRIX_USE_SSE)
+static void
+matrix_multiply4x4 (float *result, const float *a, const float *b)
+{
+  const __m128 a0 = _mm_loadu_ps (a);
+  const __m128 a1 = _mm_loadu_ps (a + 4);
+  const __m128 a2 = _mm_loadu_ps (a + 8);
+  const __m128 a3 = _mm_loadu_ps (a + 12);
+  int i;
+
+  /* Each result column is a linear combination of the columns of @a */
+  for (i = 0; i < 4; i++)
+    {
+      const float *bi = b + i * 4;
+      __m128 r;
+
+      r = _mm_mul_ps (a0, _mm_set1_ps (bi[0]));
+      r = _mm_add_ps (r, _mm_mul_ps (a1, _mm_set1_ps (bi[1])));
+      r = _mm_add_ps (r, _mm_mul_ps (a2, _mm_set1_ps (bi[2])));
+      r = _mm_add_ps (r, _mm_mul_ps (a3, _mm_set1_ps (bi[3])));
+      _mm_storeu_ps (result + i * 4, r);
+    }
+}
+#elif defined(COGL_MATRIX_USE_NEON)
+static void
+matrix_multiply4x4 (float *result, const float *a, const float *b)
+{
+  const float32x4_t a0 = vld1q_f32 (a);
+  const float32x4_t a1 = vld1q_f32 (a + 4);
+  const float32x4_t a2 = vld1q_f32 (a + 8);
+  const float32x4_t a3 = vld1q_f32 (a + 12);
+  int i;
+
+  /* Each result column is a linear combination of the columns of @a */
+  for (i = 0; i < 4; i++)
+    {
+      const float *bi = b + i * 4;
+      float32x4_t r;
+
+      r = vmulq_n_f32 (a0, bi[0]);
+      r = vmlaq_n_f32 (r, a1, bi[1]);
+      r = vmlaq_n_f32 (r, a2, bi[2]);
+      r = vmlaq_n_f32 (r, a3, bi[3]);
+      vst1q_f32 (result + i * 4, r);
+    }
+}
+#else
+static void
+matrix_multiply4x4 (float *result, const float *a, const float *b)
+{
+  matrix_multiply4x4_scalar (result, a, b);
+}
+#endif
+
+static void
+matrix_multiply3x4 (float *result, const float *a, const float *b)
+{
+#ifdef COGL_MATRIX_USE_SIMD
+  /* A full vector multiply is cheaper than skipping the bottom row */
+  matrix_multiply4x4 (result, a, b);
+  R(3,0) = 0;
+  R(3,1) = 0;
+  R(3,2) = 0;
+  R(3,3) = 1;
+#else
+  matrix_multiply3x4_scalar (result, a, b);
+#endif
+}
 
 #undef A
 #undef B
@@ -440,7 +529,7 @@ cogl_debug_matrix_print (const CoglMatrix *matrix)
  * unrolled.
  */
 static gboolean
-invert_matrix_general (CoglMatrix *matrix)
+invert_matrix_general_scalar (CoglMatrix *matrix)
 {
   const float *m = (float *)matrix;
   float *out = matrix->inv;
@@ -561,6 +650,143 @@ invert_matrix_general (CoglMatrix *matrix)
 
   return TRUE;
 }
+
+#ifdef COGL_MATRIX_USE_SSE
+
+#define SHUFFLE_MASK(x, y, z, w) ((x) | ((y) << 2) | ((z) << 4) | ((w) << 6))
+#define SWIZZLE(v, x, y, z, w) \
+  _mm_shuffle_ps ((v), (v), SHUFFLE_MASK (x, y, z, w))
+#define SHUFFLE(v1, v2, x, y, z, w) \
+  _mm_shuffle_ps ((v1), (v2), SHUFFLE_MASK (x, y, z, w))
+
+/* 2x2 block products, with blocks stored row major as (a b c d) */
+static inline __m128
+mat2_mul (__m128 v1,
+          __m128 v2)
+{
+  return _mm_add_ps (_mm_mul_ps (v1, SWIZZLE (v2, 0, 3, 0, 3)),
+                     _mm_mul_ps (SWIZZLE (v1, 1, 0, 3, 2),
+                                 SWIZZLE (v2, 2, 1, 2, 1)));
+}
+
+/* adj(v1) * v2 */
+static inline __m128
+mat2_adj_mul (__m128 v1,
+              __m128 v2)
+{
+  return _mm_sub_ps (_mm_mul_ps (SWIZZLE (v1, 3, 3, 0, 0), v2),
+                     _mm_mul_ps (SWIZZLE (v1, 1, 1, 2, 2),
+                                 SWIZZLE (v2, 2, 3, 0, 1)));
+}
+
+/* v1 * adj(v2) */
+static inline __m128
+mat2_mul_adj (__m128 v1,
+              __m128 v2)
+{
+  return _mm_sub_ps (_mm_mul_ps (v1, SWIZZLE (v2, 3, 0, 3, 0)),
+                     _mm_mul_ps (SWIZZLE (v1, 1, 0, 3, 2),
+                                 SWIZZLE (v2, 2, 1, 2, 1)));
+}
+
+/*
+ * Compute inverse of 4x4 transformation matrix.
+ *
+ * @mat pointer to a CoglMatrix structure. The matrix inverse will be
+ * stored in the CoglMatrix::inv attribute.
+ *
+ * Returns: %TRUE for success, %FALSE for failure (\p singular matrix).
+ *
+ * Splits the matrix into 2x2 blocks and computes the adjugate blockwise,
+ * which needs no branches and maps well onto SSE registers. As the
+ * inverse of the transpose is the transpose of the inverse, the column
+ * major storage doesn't need any special care. Matrices that are close to
+ * singular are inverted by invert_matrix_general_scalar().
+ */
+static gboolean
+invert_matrix_general (CoglMatrix *matrix)
+{
+  const float *m = (float *)matrix;
+  const __m128 c0 = _mm_loadu_ps (m);
+  const __m128 c1 = _mm_loadu_ps (m + 4);
+  const __m128 c2 = _mm_loadu_ps (m + 8);
+  const __m128 c3 = _mm_loadu_ps (m + 12);
+  __m128 a, b, c, d;
+  __m128 det_sub, det_a, det_b, det_c, det_d, det_m;
+  __m128 d_c, a_b, x, y, z, w, tr, rdet;
+  float det, bound;
+  int i;
+
+  a = _mm_movelh_ps (c0, c1);
+  b = _mm_movehl_ps (c1, c0);
+  c = _mm_movelh_ps (c2, c3);
+  d = _mm_movehl_ps (c3, c2);
+
+  /* Determinants of the four blocks as (|a| |b| |c| |d|) */
+  det_sub = _mm_sub_ps (_mm_mul_ps (SHUFFLE (c0, c2, 0, 2, 0, 2),
+                                    SHUFFLE (c1, c3, 1, 3, 1, 3)),
+                        _mm_mul_ps (SHUFFLE (c0, c2, 1, 3, 1, 3),
+                                    SHUFFLE (c1, c3, 0, 2, 0, 2)));
+  det_a = SWIZZLE (det_sub, 0, 0, 0, 0);
+  det_b = SWIZZLE (det_sub, 1, 1, 1, 1);
+  det_c = SWIZZLE (det_sub, 2, 2, 2, 2);
+  det_d = SWIZZLE (det_sub, 3, 3, 3, 3);
+
+  d_c = mat2_adj_mul (d, c);
+  a_b = mat2_adj_mul (a, b);
+
+  x = _mm_sub_ps (_mm_mul_ps (det_d, a), mat2_mul (b, d_c));
+  w = _mm_sub_ps (_mm_mul_ps (det_a, d), mat2_mul (c, a_b));
+  y = _mm_sub_ps (_mm_mul_ps (det_b, c), mat2_mul_adj (d, a_b));
+  z = _mm_sub_ps (_mm_mul_ps (det_c, b), mat2_mul_adj (a, d_c));
+
+  /* |m| = |a| |d| + |b| |c| - tr (adj(a) b adj(d) c) */
+  tr = _mm_mul_ps (a_b, SWIZZLE (d_c, 0, 2, 1, 3));
+  tr = _mm_add_ps (tr, SWIZZLE (tr, 2, 3, 0, 1));
+  tr = _mm_add_ps (tr, SWIZZLE (tr, 1, 0, 3, 2));
+
+  det_m = _mm_add_ps (_mm_mul_ps (det_a, det_d), _mm_mul_ps (det_b, det_c));
+  det_m = _mm_sub_ps (det_m, tr);
+
+  /* Hadamard's inequality bounds |m| by the product of the column lengths.
+   * Matrices whose determinant is small compared to that are left to the
+   * elimination, so both kernels agree on which of them can be inverted,
+   * and ill conditioned matrices get the pivoting. */
+  det = _mm_cvtss_f32 (det_m);
+  bound = 1.0f;
+  for (i = 0; i < 16; i += 4)
+    bound *= (m[i] * m[i] + m[i + 1] * m[i + 1] +
+              m[i + 2] * m[i + 2] + m[i + 3] * m[i + 3]);
+  if (det * det <= 1e-8f * bound)
+    return invert_matrix_general_scalar (matrix);
+
+  rdet = _mm_div_ps (_mm_setr_ps (1.0f, -1.0f, -1.0f, 1.0f), det_m);
+  x = _mm_mul_ps (x, rdet);
+  y = _mm_mul_ps (y, rdet);
+  z = _mm_mul_ps (z, rdet);
+  w = _mm_mul_ps (w, rdet);
+
+  _mm_storeu_ps (matrix->inv, SHUFFLE (x, y, 3, 1, 3, 1));
+  _mm_storeu_ps (matrix->inv + 4, SHUFFLE (x, y, 2, 0, 2, 0));
+  _mm_storeu_ps (matrix->inv + 8, SHUFFLE (z, w, 3, 1, 3, 1));
+  _mm_storeu_ps (matrix->inv + 12, SHUFFLE (z, w, 2, 0, 2, 0));
+
+  return TRUE;
+}
+
+#undef SWIZZLE
+#undef SHUFFLE
+#undef SHUFFLE_MASK
+
+#else /* COGL_MATRIX_USE_SSE */
+
+static gboolean
+invert_matrix_general (CoglMatrix *matrix)
+{
+  return invert_matrix_general_scalar (matrix);
+}
+
+#endif /* COGL_MATRIX_USE_SSE */
 #undef SWAP_ROWS
 
 /*
@@ -923,12 +1149,21 @@ analyse_from_scratch (CoglMatrix *matrix)
 {
   const float *m = (float *)matrix;
   unsigned int mask = 0;
+#ifdef COGL_MATRIX_USE_SSE
+  const __m128 zero = _mm_setzero_ps ();
+
+  mask = ((_mm_movemask_ps (_mm_cmpeq_ps (_mm_loadu_ps (m), zero))) |
+          (_mm_movemask_ps (_mm_cmpeq_ps (_mm_loadu_ps (m + 4), zero)) << 4) |
+          (_mm_movemask_ps (_mm_cmpeq_ps (_mm_loadu_ps (m + 8), zero)) << 8) |
+          (_mm_movemask_ps (_mm_cmpeq_ps (_mm_loadu_ps (m + 12), zero)) << 12));
+#else
   unsigned int i;
 
   for (i = 0 ; i < 16 ; i++)
     {
       if (m[i] == 0.0) mask |= (1<<i);
     }
+#endif
 
   if (m[0] == 1.0f) mask |= (1<<16);
   if (m[5] == 1.0f) mask |= (1<<21);
@@ -2239,3 +2474,131 @@ cogl_gtype_matrix_get_type (void)
 {
   return cogl_matrix_get_gtype ();
 }
+
+#ifdef ENABLE_UNIT_TESTS
+
+static void
+init_random_matrix (CoglMatrix *matrix,
+                    GRand      *rand,
+                    gboolean    affine)
+{
+  float m[16];
+  int i;
+
+  for (i = 0; i < 16; i++)
+    m[i] = g_rand_double_range (rand, -10.0, 10.0);
+
+  if (affine)
+    {
+      MAT (m, 3, 0) = 0.0f;
+      MAT (m, 3, 1) = 0.0f;
+      MAT (m, 3, 2) = 0.0f;
+      MAT (m, 3, 3) = 1.0f;
+    }
+
+  cogl_matrix_init_from_array (matrix, m);
+}
+
+/* Makes the matrix singular, then moves it slightly away from that */
+static void
+make_near_singular (CoglMatrix *matrix,
+                    float       offset)
+{
+  float *m = (float *) matrix;
+  int c;
+
+  for (c = 0; c < 4; c++)
+    MAT (m, 3, c) = MAT (m, 0, c) + MAT (m, 1, c) + offset;
+
+  matrix->flags = MAT_FLAG_GENERAL | MAT_DIRTY_ALL;
+}
+
+static void
+assert_floats_close (const float *a,
+                     const float *b,
+                     int          n,
+                     float        epsilon)
+{
+  int i;
+
+  for (i = 0; i < n; i++)
+    {
+      float scale = MAX (1.0f, MAX (fabsf (a[i]), fabsf (b[i])));
+
+      if (fabsf (a[i] - b[i]) > epsilon * scale)
+        g_error ("Element %d differs: %f != %f", i, a[i], b[i]);
+    }
+}
+
+UNIT_TEST (check_matrix_kernels,
+           0 /* no requirements */,
+           0 /* no failure cases */)
+{
+  GRand *rand = g_rand_new_with_seed (4711);
+  int i;
+
+  for (i = 0; i < 100; i++)
+    {
+      CoglMatrix a, b, scalar, vector;
+      float points[4][4], expected[4][4];
+      int j;
+
+      /* Multiplication, with and without the 3x4 shortcut */
+      init_random_matrix (&a, rand, FALSE);
+      init_random_matrix (&b, rand, FALSE);
+      matrix_multiply4x4_scalar ((float *) &scalar,
+                                 (float *) &a, (float *) &b);
+      matrix_multiply4x4 ((float *) &vector, (float *) &a, (float *) &b);
+      assert_floats_close ((float *) &scalar, (float *) &vector, 16, 1e-5);
+
+      init_random_matrix (&a, rand, TRUE);
+      init_random_matrix (&b, rand, TRUE);
+      matrix_multiply3x4_scalar ((float *) &scalar,
+                                 (float *) &a, (float *) &b);
+      matrix_multiply3x4 ((float *) &vector, (float *) &a, (float *) &b);
+      assert_floats_close ((float *) &scalar, (float *) &vector, 16, 1e-5);
+
+      /* Transforming points by the product */
+      cogl_matrix_multiply (&vector, &a, &b);
+      for (j = 0; j < 4; j++)
+        {
+          int k;
+
+          for (k = 0; k < 4; k++)
+            points[j][k] = g_rand_double_range (rand, -100.0, 100.0);
+          points[j][3] = 1.0f;
+
+          for (k = 0; k < 4; k++)
+            {
+              expected[j][k] = (MAT ((float *) &scalar, k, 0) * points[j][0] +
+                                MAT ((float *) &scalar, k, 1) * points[j][1] +
+                                MAT ((float *) &scalar, k, 2) * points[j][2] +
+                                MAT ((float *) &scalar, k, 3) * points[j][3]);
+            }
+
+          cogl_matrix_transform_point (&vector,
+                                       &points[j][0], &points[j][1],
+                                       &points[j][2], &points[j][3]);
+        }
+      assert_floats_close (&expected[0][0], &points[0][0], 16, 1e-4);
+
+      /* Inversion of general and affine matrices */
+      init_random_matrix (&a, rand, i % 2);
+      scalar = a;
+      vector = a;
+      g_assert_cmpint (invert_matrix_general_scalar (&scalar), ==,
+                       invert_matrix_general (&vector));
+      assert_floats_close (scalar.inv, vector.inv, 16, 1e-3);
+
+      /* Near singular matrices must be classified the same way */
+      make_near_singular (&a, i % 3 == 0 ? 0.0f : 1e-6f);
+      scalar = a;
+      vector = a;
+      g_assert_cmpint (invert_matrix_general_scalar (&scalar), ==,
+                       invert_matrix_general (&vector));
+    }
+
+  g_rand_free (rand);
+}
+
+#endif /* ENABLE_UNIT_TESTS */
@@ -70,13 +70,12 @@ cogl_trace_begin (CoglTraceHead *head,
 }
 
 static inline void
-cogl_trace_end (CoglTraceHead *head)
+cogl_trace_end_at (CoglTraceHead    *head,
+                   SysprofTimeStamp  end_time)
 {
-  SysprofTimeStamp end_time;
   CoglTraceContext *trace_context;
   CoglTraceThreadContext *trace_thread_context;
 
-  end_time = g_get_monotonic_time () * 1000;
   trace_context = cogl_trace_context;
   trace_thread_context = g_private_get (&cogl_trace_thread_data);
 
@@ -100,6 +99,12 @@ cogl_trace_end (CoglTraceHead *head)
   g_mutex_unlock (&cogl_trace_mutex);
 }
 
+static inline void
+cogl_trace_end (CoglTraceHead *head)
+{
+  cogl_trace_end_at (head, g_get_monotonic_time () * 1000);
+}
+
 static inline void
 cogl_auto_trace_end_helper (CoglTraceHead **head)
 {
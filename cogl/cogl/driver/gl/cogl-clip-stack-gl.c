@@ -231,6 +231,41 @@ add_stencil_clip_region (CoglFramebuffer *framebuffer,
   GE( ctx, glStencilOp (GL_KEEP, GL_KEEP, GL_KEEP) );
 }
 
+static void
+add_window_rectangles_clip_region (CoglFramebuffer *framebuffer,
+                                   cairo_region_t  *region)
+{
+  CoglContext *ctx = cogl_framebuffer_get_context (framebuffer);
+  int num_rectangles = cairo_region_num_rectangles (region);
+  int framebuffer_height = cogl_framebuffer_get_height (framebuffer);
+  GLint *boxes;
+  int i;
+
+  boxes = g_alloca (sizeof (GLint) * 4 * num_rectangles);
+
+  for (i = 0; i < num_rectangles; i++)
+    {
+      cairo_rectangle_int_t rect;
+      GLint *box = boxes + i * 4;
+
+      cairo_region_get_rectangle (region, i, &rect);
+
+      /* Like the scissor, window rectangles have their origin at the
+       * bottom left, except for offscreen rendering which Cogl does
+       * upside down */
+      box[0] = rect.x;
+      if (cogl_is_offscreen (framebuffer))
+        box[1] = rect.y;
+      else
+        box[1] = framebuffer_height - (rect.y + rect.height);
+      box[2] = rect.width;
+      box[3] = rect.height;
+    }
+
+  GE (ctx, glWindowRectangles (GL_INCLUSIVE_EXT, num_rectangles, boxes));
+  ctx->current_gl_window_rectangles_enabled = TRUE;
+}
+
 typedef void (*SilhouettePaintCallback) (CoglFramebuffer *framebuffer,
                                          CoglPipeline *pipeline,
                                          void *user_data);
@@ -396,6 +431,12 @@ _cogl_clip_stack_gl_flush (CoglClipStack *stack,
 
   GE( ctx, glDisable (GL_STENCIL_TEST) );
 
+  if (ctx->current_gl_window_rectangles_enabled)
+    {
+      GE (ctx, glWindowRectangles (GL_EXCLUSIVE_EXT, 0, NULL));
+      ctx->current_gl_window_rectangles_enabled = FALSE;
+    }
+
   /* If the stack is empty then there's nothing else to do
    */
   if (stack == NULL)
@@ -499,11 +540,24 @@ _cogl_clip_stack_gl_flush (CoglClipStack *stack,
         case COGL_CLIP_STACK_REGION:
             {
               CoglClipStackRegion *region = (CoglClipStackRegion *) entry;
+              int num_rectangles =
+                cairo_region_num_rectangles (region->region);
 
               /* If nrectangles <= 1, it can be fully represented with the
-               * scissor clip.
+               * scissor clip. Window rectangles can only hold one region,
+               * so any further regions have to use the stencil buffer.
                */
-              if (cairo_region_num_rectangles (region->region) > 1)
+              if (num_rectangles > 1 &&
+                  num_rectangles <= ctx->max_window_rectangles &&
+                  !ctx->current_gl_window_rectangles_enabled)
+                {
+                  COGL_NOTE (CLIPPING,
+                             "Adding window rectangles clip for region");
+
+                  add_window_rectangles_clip_region (framebuffer,
+                                                     region->region);
+                }
+              else if (num_rectangles > 1)
                 {
                   COGL_NOTE (CLIPPING, "Adding stencil clip for region");
 
@@ -42,6 +42,16 @@
 #define GL_CONTEXT_LOST GL_CONTEXT_LOST_KHR
 #endif
 
+#ifndef GL_INCLUSIVE_EXT
+#define GL_INCLUSIVE_EXT 0x8F10
+#endif
+#ifndef GL_EXCLUSIVE_EXT
+#define GL_EXCLUSIVE_EXT 0x8F11
+#endif
+#ifndef GL_MAX_WINDOW_RECTANGLES_EXT
+#define GL_MAX_WINDOW_RECTANGLES_EXT 0x8F14
+#endif
+
 #ifdef COGL_GL_DEBUG
 
 const char *
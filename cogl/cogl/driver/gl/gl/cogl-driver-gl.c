@@ -524,6 +524,15 @@ _cogl_driver_update_features (CoglContext *ctx,
   if (ctx->glFenceSync)
     COGL_FLAGS_SET (ctx->features, COGL_FEATURE_ID_FENCE, TRUE);
 
+  if (ctx->glWindowRectangles)
+    {
+      GE (ctx, glGetIntegerv (GL_MAX_WINDOW_RECTANGLES_EXT,
+                              &ctx->max_window_rectangles));
+      if (ctx->max_window_rectangles > 0)
+        COGL_FLAGS_SET (ctx->features,
+                        COGL_FEATURE_ID_WINDOW_RECTANGLES, TRUE);
+    }
+
   if (COGL_CHECK_GL_VERSION (gl_major, gl_minor, 3, 0) ||
       _cogl_check_extension ("GL_ARB_texture_rg", gl_extensions))
     COGL_FLAGS_SET (ctx->features,
@@ -364,6 +364,15 @@ _cogl_driver_update_features (CoglContext *context,
                     COGL_FEATURE_ID_TEXTURE_RG,
                     TRUE);
 
+  if (context->glWindowRectangles)
+    {
+      GE (context, glGetIntegerv (GL_MAX_WINDOW_RECTANGLES_EXT,
+                                  &context->max_window_rectangles));
+      if (context->max_window_rectangles > 0)
+        COGL_FLAGS_SET (context->features,
+                        COGL_FEATURE_ID_WINDOW_RECTANGLES, TRUE);
+    }
+
   /* Cache features */
   for (i = 0; i < G_N_ELEMENTS (private_features); i++)
     context->private_features[i] |= private_features[i];
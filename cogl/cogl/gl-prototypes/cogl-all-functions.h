@@ -150,6 +150,16 @@ COGL_EXT_FUNCTION (void, glDiscardFramebuffer,
                     const GLenum    *attachments))
 COGL_EXT_END ()
 
+COGL_EXT_BEGIN (window_rectangles, 255, 255,
+                0, /* not in either GLES */
+                "EXT\0",
+                "window_rectangles\0")
+COGL_EXT_FUNCTION (void, glWindowRectangles,
+                   (GLenum           mode,
+                    GLsizei          count,
+                    const GLint     *box))
+COGL_EXT_END ()
+
 COGL_EXT_BEGIN (IMG_multisampled_render_to_texture, 255, 255,
                 0, /* not in either GLES */
                 "\0",
@@ -5,6 +5,11 @@
 
 #define N_TEXTURES 128
 
+/* Textures of this size take up a 202x202 rectangle including the
+   border so a handful of them fill a 1024x1024 atlas page */
+#define N_PAGE_TEXTURES 64
+#define PAGE_TEXTURE_SIZE(tex_num) (200 + (tex_num) % 3)
+
 #define OPACITY_FOR_ROW(y) \
   (0xff - ((y) & 0xf) * 0x10)
 
@@ -144,3 +149,92 @@ test_atlas_migration (void)
   if (cogl_test_verbose ())
     g_print ("OK\n");
 }
+
+void
+test_atlas_pages (void)
+{
+  CoglTexture *textures[N_PAGE_TEXTURES];
+  unsigned int handles[N_PAGE_TEXTURES];
+  unsigned int first_handle, handle;
+  gboolean added_page = FALSE;
+  int tex_num;
+
+  textures[0] = create_texture (PAGE_TEXTURE_SIZE (0));
+
+  if (!cogl_is_atlas_texture (textures[0]))
+    {
+      if (cogl_test_verbose ())
+        g_print ("Skipping: texture not atlased\n");
+      cogl_object_unref (textures[0]);
+      return;
+    }
+
+  cogl_texture_get_gl_texture (textures[0], &first_handle, NULL);
+
+  for (tex_num = 1; tex_num < N_PAGE_TEXTURES; tex_num++)
+    textures[tex_num] = create_texture (PAGE_TEXTURE_SIZE (tex_num));
+
+  /* Running out of space should have added pages instead of moving
+     the first texture to a bigger atlas */
+  cogl_texture_get_gl_texture (textures[0], &handle, NULL);
+  g_assert_cmpuint (handle, ==, first_handle);
+
+  for (tex_num = 1; tex_num < N_PAGE_TEXTURES; tex_num++)
+    {
+      cogl_texture_get_gl_texture (textures[tex_num], &handle, NULL);
+      if (handle != first_handle)
+        added_page = TRUE;
+    }
+  g_assert_true (added_page);
+
+  for (tex_num = 0; tex_num < N_PAGE_TEXTURES; tex_num++)
+    {
+      verify_texture (textures[tex_num], PAGE_TEXTURE_SIZE (tex_num));
+      cogl_texture_get_gl_texture (textures[tex_num],
+                                   &handles[tex_num], NULL);
+    }
+
+  /* Leave the pages mostly empty so they get compacted */
+  for (tex_num = 0; tex_num < N_PAGE_TEXTURES; tex_num++)
+    {
+      if (tex_num % 8 != 0)
+        {
+          cogl_object_unref (textures[tex_num]);
+          textures[tex_num] = NULL;
+        }
+    }
+
+  while (g_main_context_iteration (NULL, FALSE));
+
+  /* Compaction moves the remaining textures to a new texture for each
+     page, they should still have the right data */
+  for (tex_num = 0; tex_num < N_PAGE_TEXTURES; tex_num += 8)
+    {
+      cogl_texture_get_gl_texture (textures[tex_num], &handle, NULL);
+      g_assert_cmpuint (handle, !=, handles[tex_num]);
+      handles[tex_num] = handle;
+
+      verify_texture (textures[tex_num], PAGE_TEXTURE_SIZE (tex_num));
+    }
+
+  /* Removing a single texture from a compacted page doesn't free enough
+     space to compact it again */
+  cogl_object_unref (textures[N_PAGE_TEXTURES - 8]);
+  textures[N_PAGE_TEXTURES - 8] = NULL;
+
+  while (g_main_context_iteration (NULL, FALSE));
+
+  for (tex_num = 0; tex_num < N_PAGE_TEXTURES - 8; tex_num += 8)
+    {
+      cogl_texture_get_gl_texture (textures[tex_num], &handle, NULL);
+      g_assert_cmpuint (handle, ==, handles[tex_num]);
+
+      verify_texture (textures[tex_num], PAGE_TEXTURE_SIZE (tex_num));
+    }
+
+  for (tex_num = 0; tex_num < N_PAGE_TEXTURES - 8; tex_num += 8)
+    cogl_object_unref (textures[tex_num]);
+
+  if (cogl_test_verbose ())
+    g_print ("OK\n");
+}
@@ -77,6 +77,7 @@ main (int argc, char **argv)
   UNPORTED_TEST (test_texture_pixmap_x11);
   ADD_TEST (test_texture_get_set_data, 0, 0);
   ADD_TEST (test_atlas_migration, 0, 0);
+  ADD_TEST (test_atlas_pages, 0, 0);
   ADD_TEST (test_read_texture_formats, 0, TEST_KNOWN_FAILURE);
   ADD_TEST (test_write_texture_formats, 0, 0);
   ADD_TEST (test_alpha_textures, 0, 0);
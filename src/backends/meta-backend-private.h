@@ -46,6 +46,10 @@
 #include "backends/meta-remote-desktop.h"
 #endif
 
+#ifdef HAVE_PROFILER
+#include "backends/meta-profiler.h"
+#endif
+
 #define DEFAULT_XKB_RULES_FILE "evdev"
 #define DEFAULT_XKB_MODEL "pc105+inet"
 
@@ -140,6 +144,10 @@ MetaEgl * meta_backend_get_egl (MetaBackend *backend);
 MetaRemoteDesktop * meta_backend_get_remote_desktop (MetaBackend *backend);
 #endif
 
+#ifdef HAVE_PROFILER
+MetaProfiler * meta_backend_get_profiler (MetaBackend *backend);
+#endif
+
 gboolean meta_backend_grab_device (MetaBackend *backend,
                                    int          device_id,
                                    uint32_t     timestamp);
@@ -1018,6 +1018,19 @@ meta_backend_get_remote_desktop (MetaBackend *backend)
 }
 #endif /* HAVE_REMOTE_DESKTOP */
 
+#ifdef HAVE_PROFILER
+/**
+ * meta_backend_get_profiler: (skip)
+ */
+MetaProfiler *
+meta_backend_get_profiler (MetaBackend *backend)
+{
+  MetaBackendPrivate *priv = meta_backend_get_instance_private (backend);
+
+  return priv->profiler;
+}
+#endif /* HAVE_PROFILER */
+
 /**
  * meta_backend_get_remote_access_controller:
  * @backend: A #MetaBackend
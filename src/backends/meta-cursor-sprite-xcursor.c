@@ -26,6 +26,36 @@
 #include "cogl/cogl.h"
 #include "meta/prefs.h"
 
+/*
+ * Cursors are loaded from the theme once per cursor, theme and size, and
+ * shared between all sprites using them, together with a texture per frame.
+ * Backends may attach their own data, e.g. hardware cursor buffers, to the
+ * frame textures using cogl_object_set_user_data().
+ */
+typedef struct _MetaXcursorCacheKey
+{
+  MetaCursor cursor;
+  char *theme;
+  int size;
+} MetaXcursorCacheKey;
+
+typedef struct _MetaXcursorCacheEntry
+{
+  grefcount ref_count;
+
+  XcursorImages *xcursor_images;
+  CoglTexture **textures;
+} MetaXcursorCacheEntry;
+
+typedef struct _MetaXcursorCache
+{
+  GHashTable *entries;
+
+  GArray *warm_up_sizes;
+  guint warm_up_idle_id;
+  int n_warmed_up;
+} MetaXcursorCache;
+
 struct _MetaCursorSpriteXcursor
 {
   MetaCursorSprite parent;
@@ -33,12 +63,31 @@ struct _MetaCursorSpriteXcursor
   MetaCursor cursor;
 
   int current_frame;
-  XcursorImages *xcursor_images;
+  MetaXcursorCacheEntry *cache_entry;
 
   int theme_scale;
   gboolean theme_dirty;
 };
 
+/* Loaded ahead of time, as these show up as soon as the pointer moves */
+static const MetaCursor warm_up_cursors[] = {
+  META_CURSOR_DEFAULT,
+  META_CURSOR_IBEAM,
+  META_CURSOR_POINTING_HAND,
+  META_CURSOR_NORTH_RESIZE,
+  META_CURSOR_SOUTH_RESIZE,
+  META_CURSOR_WEST_RESIZE,
+  META_CURSOR_EAST_RESIZE,
+  META_CURSOR_SE_RESIZE,
+  META_CURSOR_SW_RESIZE,
+  META_CURSOR_NE_RESIZE,
+  META_CURSOR_NW_RESIZE,
+  META_CURSOR_MOVE_OR_RESIZE_WINDOW,
+  META_CURSOR_BUSY,
+};
+
+static MetaXcursorCache *xcursor_cache;
+
 G_DEFINE_TYPE (MetaCursorSpriteXcursor, meta_cursor_sprite_xcursor,
                META_TYPE_CURSOR_SPRITE)
 
@@ -105,18 +154,150 @@ meta_create_x_cursor (Display    *xdisplay,
   return XcursorLibraryLoadCursor (xdisplay, translate_meta_cursor (cursor));
 }
 
-static XcursorImages *
-load_cursor_on_client (MetaCursor cursor, int scale)
+static guint
+xcursor_cache_key_hash (gconstpointer data)
+{
+  const MetaXcursorCacheKey *key = data;
+
+  return (key->cursor * 31 + key->size) ^ (key->theme ? g_str_hash (key->theme)
+                                                      : 0);
+}
+
+static gboolean
+xcursor_cache_key_equal (gconstpointer data,
+                         gconstpointer other_data)
 {
-  return XcursorLibraryLoadImages (translate_meta_cursor (cursor),
-                                   meta_prefs_get_cursor_theme (),
-                                   meta_prefs_get_cursor_size () * scale);
+  const MetaXcursorCacheKey *key = data;
+  const MetaXcursorCacheKey *other_key = other_data;
+
+  return (key->cursor == other_key->cursor &&
+          key->size == other_key->size &&
+          g_strcmp0 (key->theme, other_key->theme) == 0);
 }
 
 static void
-load_from_current_xcursor_image (MetaCursorSpriteXcursor *sprite_xcursor)
+xcursor_cache_key_free (MetaXcursorCacheKey *key)
+{
+  g_free (key->theme);
+  g_free (key);
+}
+
+static MetaXcursorCacheEntry *
+xcursor_cache_entry_ref (MetaXcursorCacheEntry *entry)
+{
+  g_ref_count_inc (&entry->ref_count);
+  return entry;
+}
+
+static void
+xcursor_cache_entry_unref (MetaXcursorCacheEntry *entry)
+{
+  int i;
+
+  if (!g_ref_count_dec (&entry->ref_count))
+    return;
+
+  for (i = 0; i < entry->xcursor_images->nimage; i++)
+    g_clear_pointer (&entry->textures[i], cogl_object_unref);
+  g_free (entry->textures);
+  XcursorImagesDestroy (entry->xcursor_images);
+  g_free (entry);
+}
+
+static gboolean
+is_stale_cache_entry (gpointer key,
+                      gpointer value,
+                      gpointer user_data)
+{
+  MetaXcursorCacheKey *cache_key = key;
+
+  return (cache_key->size % meta_prefs_get_cursor_size () != 0 ||
+          g_strcmp0 (cache_key->theme, meta_prefs_get_cursor_theme ()) != 0);
+}
+
+static void
+xcursor_cache_prefs_changed (MetaPreference pref,
+                             gpointer       user_data)
+{
+  if (pref != META_PREF_CURSOR_THEME &&
+      pref != META_PREF_CURSOR_SIZE)
+    return;
+
+  /*
+   * Sprites keep using what they loaded until they are reloaded, which
+   * might already have happened, so only drop the cursors that can't be
+   * requested anymore with the new theme and size.
+   */
+  g_hash_table_foreach_remove (xcursor_cache->entries,
+                               is_stale_cache_entry,
+                               NULL);
+
+  g_array_set_size (xcursor_cache->warm_up_sizes, 0);
+  g_clear_handle_id (&xcursor_cache->warm_up_idle_id, g_source_remove);
+}
+
+static MetaXcursorCache *
+ensure_xcursor_cache (void)
+{
+  if (xcursor_cache)
+    return xcursor_cache;
+
+  xcursor_cache = g_new0 (MetaXcursorCache, 1);
+  xcursor_cache->entries =
+    g_hash_table_new_full (xcursor_cache_key_hash,
+                           xcursor_cache_key_equal,
+                           (GDestroyNotify) xcursor_cache_key_free,
+                           (GDestroyNotify) xcursor_cache_entry_unref);
+  xcursor_cache->warm_up_sizes = g_array_new (FALSE, FALSE, sizeof (int));
+
+  meta_prefs_add_listener (xcursor_cache_prefs_changed, NULL);
+
+  return xcursor_cache;
+}
+
+static MetaXcursorCacheEntry *
+xcursor_cache_lookup (MetaCursor cursor,
+                      int        size)
+{
+  MetaXcursorCache *cache = ensure_xcursor_cache ();
+  MetaXcursorCacheKey lookup_key;
+  MetaXcursorCacheKey *key;
+  MetaXcursorCacheEntry *entry;
+  XcursorImages *xcursor_images;
+
+  lookup_key = (MetaXcursorCacheKey) {
+    .cursor = cursor,
+    .theme = (char *) meta_prefs_get_cursor_theme (),
+    .size = size,
+  };
+
+  entry = g_hash_table_lookup (cache->entries, &lookup_key);
+  if (entry)
+    return entry;
+
+  xcursor_images = XcursorLibraryLoadImages (translate_meta_cursor (cursor),
+                                             lookup_key.theme,
+                                             size);
+  if (!xcursor_images)
+    return NULL;
+
+  entry = g_new0 (MetaXcursorCacheEntry, 1);
+  g_ref_count_init (&entry->ref_count);
+  entry->xcursor_images = xcursor_images;
+  entry->textures = g_new0 (CoglTexture *, xcursor_images->nimage);
+
+  key = g_new0 (MetaXcursorCacheKey, 1);
+  *key = lookup_key;
+  key->theme = g_strdup (lookup_key.theme);
+  g_hash_table_insert (cache->entries, key, entry);
+
+  return entry;
+}
+
+static CoglTexture *
+xcursor_cache_entry_get_texture (MetaXcursorCacheEntry *entry,
+                                 int                    frame)
 {
-  MetaCursorSprite *sprite = META_CURSOR_SPRITE (sprite_xcursor);
   XcursorImage *xc_image;
   int width, height, rowstride;
   CoglPixelFormat cogl_format;
@@ -125,9 +306,10 @@ load_from_current_xcursor_image (MetaCursorSpriteXcursor *sprite_xcursor)
   CoglTexture2D *texture;
   GError *error = NULL;
 
-  g_assert (!meta_cursor_sprite_get_cogl_texture (sprite));
+  if (entry->textures[frame])
+    return entry->textures[frame];
 
-  xc_image = meta_cursor_sprite_xcursor_get_current_image (sprite_xcursor);
+  xc_image = entry->xcursor_images->images[frame];
   width = (int) xc_image->width;
   height = (int) xc_image->height;
   rowstride = width * 4;
@@ -152,11 +334,81 @@ load_from_current_xcursor_image (MetaCursorSpriteXcursor *sprite_xcursor)
       g_error_free (error);
     }
 
+  entry->textures[frame] = COGL_TEXTURE (texture);
+
+  return entry->textures[frame];
+}
+
+static gboolean
+warm_up_cursor_cache (gpointer user_data)
+{
+  MetaXcursorCache *cache = xcursor_cache;
+  int n_cursors = G_N_ELEMENTS (warm_up_cursors);
+  MetaXcursorCacheEntry *entry;
+  int size;
+
+  /* Load one cursor per iteration, not to hold up the main loop */
+  size = g_array_index (cache->warm_up_sizes, int,
+                        cache->n_warmed_up / n_cursors);
+  entry = xcursor_cache_lookup (warm_up_cursors[cache->n_warmed_up % n_cursors],
+                                size);
+  if (entry)
+    xcursor_cache_entry_get_texture (entry, 0);
+
+  cache->n_warmed_up++;
+  if (cache->n_warmed_up < cache->warm_up_sizes->len * n_cursors)
+    return G_SOURCE_CONTINUE;
+
+  cache->warm_up_idle_id = 0;
+  return G_SOURCE_REMOVE;
+}
+
+static void
+maybe_warm_up_cursor_cache (int size)
+{
+  MetaXcursorCache *cache = ensure_xcursor_cache ();
+  unsigned int i;
+
+  for (i = 0; i < cache->warm_up_sizes->len; i++)
+    {
+      if (g_array_index (cache->warm_up_sizes, int, i) == size)
+        return;
+    }
+
+  if (!cache->warm_up_idle_id)
+    {
+      g_array_set_size (cache->warm_up_sizes, 0);
+      cache->n_warmed_up = 0;
+    }
+
+  g_array_append_val (cache->warm_up_sizes, size);
+
+  if (!cache->warm_up_idle_id)
+    {
+      cache->warm_up_idle_id = g_idle_add_full (G_PRIORITY_LOW,
+                                                warm_up_cursor_cache,
+                                                NULL, NULL);
+      g_source_set_name_by_id (cache->warm_up_idle_id,
+                               "[mutter] warm_up_cursor_cache");
+    }
+}
+
+static void
+load_from_current_xcursor_image (MetaCursorSpriteXcursor *sprite_xcursor)
+{
+  MetaCursorSprite *sprite = META_CURSOR_SPRITE (sprite_xcursor);
+  XcursorImage *xc_image;
+  CoglTexture *texture;
+
+  g_assert (!meta_cursor_sprite_get_cogl_texture (sprite));
+
+  xc_image = meta_cursor_sprite_xcursor_get_current_image (sprite_xcursor);
+  texture = xcursor_cache_entry_get_texture (sprite_xcursor->cache_entry,
+                                             sprite_xcursor->current_frame);
+
   meta_cursor_sprite_set_texture (sprite,
-                                  COGL_TEXTURE (texture),
+                                  texture,
                                   xc_image->xhot, xc_image->yhot);
-
-  g_clear_pointer (&texture, cogl_object_unref);
 }
 
 void
@@ -173,14 +425,16 @@ meta_cursor_sprite_xcursor_is_animated (MetaCursorSprite *sprite)
 {
   MetaCursorSpriteXcursor *sprite_xcursor = META_CURSOR_SPRITE_XCURSOR (sprite);
 
-  return (sprite_xcursor->xcursor_images &&
-          sprite_xcursor->xcursor_images->nimage > 1);
+  return (sprite_xcursor->cache_entry &&
+          sprite_xcursor->cache_entry->xcursor_images->nimage > 1);
 }
 
 XcursorImage *
 meta_cursor_sprite_xcursor_get_current_image (MetaCursorSpriteXcursor *sprite_xcursor)
 {
-  return sprite_xcursor->xcursor_images->images[sprite_xcursor->current_frame];
+  XcursorImages *xcursor_images = sprite_xcursor->cache_entry->xcursor_images;
+
+  return xcursor_images->images[sprite_xcursor->current_frame];
 }
 
 static void
@@ -193,7 +447,8 @@ meta_cursor_sprite_xcursor_tick_frame (MetaCursorSprite *sprite)
 
   sprite_xcursor->current_frame++;
 
-  if (sprite_xcursor->current_frame >= sprite_xcursor->xcursor_images->nimage)
+  if (sprite_xcursor->current_frame >=
+      sprite_xcursor->cache_entry->xcursor_images->nimage)
     sprite_xcursor->current_frame = 0;
 
   meta_cursor_sprite_clear_texture (sprite);
@@ -208,7 +463,7 @@ meta_cursor_sprite_xcursor_get_current_frame_time (MetaCursorSprite *sprite)
 
   g_return_val_if_fail (meta_cursor_sprite_is_animated (sprite), 0);
 
-  xcursor_images = sprite_xcursor->xcursor_images;
+  xcursor_images = sprite_xcursor->cache_entry->xcursor_images;
   return xcursor_images->images[sprite_xcursor->current_frame]->delay;
 }
 
@@ -216,24 +471,29 @@ static void
 load_cursor_from_theme (MetaCursorSprite *sprite)
 {
   MetaCursorSpriteXcursor *sprite_xcursor = META_CURSOR_SPRITE_XCURSOR (sprite);
+  MetaXcursorCacheEntry *cache_entry;
+  int size;
 
   g_assert (sprite_xcursor->cursor != META_CURSOR_NONE);
 
   sprite_xcursor->theme_dirty = FALSE;
 
+  size = meta_prefs_get_cursor_size () * sprite_xcursor->theme_scale;
+  cache_entry = xcursor_cache_lookup (sprite_xcursor->cursor, size);
+  if (!cache_entry)
+    g_error ("Could not find cursor. Perhaps set XCURSOR_PATH?");
+
   /* We might be reloading with a different scale. If so clear the old data. */
-  if (sprite_xcursor->xcursor_images)
+  if (sprite_xcursor->cache_entry)
     {
       meta_cursor_sprite_clear_texture (sprite);
-      XcursorImagesDestroy (sprite_xcursor->xcursor_images);
+      xcursor_cache_entry_unref (sprite_xcursor->cache_entry);
     }
 
   sprite_xcursor->current_frame = 0;
-  sprite_xcursor->xcursor_images =
-    load_cursor_on_client (sprite_xcursor->cursor,
-                           sprite_xcursor->theme_scale);
-  if (!sprite_xcursor->xcursor_images)
-    g_error ("Could not find cursor. Perhaps set XCURSOR_PATH?");
+  sprite_xcursor->cache_entry = xcursor_cache_entry_ref (cache_entry);
+
+  maybe_warm_up_cursor_cache (size);
 
   load_from_current_xcursor_image (sprite_xcursor);
 }
@@ -263,8 +523,8 @@ meta_cursor_sprite_xcursor_finalize (GObject *object)
 {
   MetaCursorSpriteXcursor *sprite_xcursor = META_CURSOR_SPRITE_XCURSOR (object);
 
-  g_clear_pointer (&sprite_xcursor->xcursor_images,
-                   XcursorImagesDestroy);
+  g_clear_pointer (&sprite_xcursor->cache_entry,
+                   xcursor_cache_entry_unref);
 
   G_OBJECT_CLASS (meta_cursor_sprite_xcursor_parent_class)->finalize (object);
 }
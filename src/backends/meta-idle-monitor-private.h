@@ -35,7 +35,7 @@ typedef struct
   GDestroyNotify            notify;
   guint64                   timeout_msec;
   int                       idle_source_id;
-  GSource                  *timeout_source;
+  guint64                   fired_event_time;
 } MetaIdleMonitorWatch;
 
 struct _MetaIdleMonitor
@@ -45,6 +45,9 @@ struct _MetaIdleMonitor
   GDBusProxy *session_proxy;
   gboolean inhibited;
   GHashTable *watches;
+  GList *idle_watches;
+  GList *user_active_watches;
+  GSource *timeout_source;
   int device_id;
   guint64 last_event_time;
 };
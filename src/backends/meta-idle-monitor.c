@@ -84,6 +84,11 @@ meta_idle_monitor_dispose (GObject *object)
   MetaIdleMonitor *monitor = META_IDLE_MONITOR (object);
 
   g_clear_pointer (&monitor->watches, g_hash_table_destroy);
+  if (monitor->timeout_source)
+    {
+      g_source_destroy (monitor->timeout_source);
+      g_clear_pointer (&monitor->timeout_source, g_source_unref);
+    }
   g_clear_object (&monitor->session_proxy);
 
   G_OBJECT_CLASS (meta_idle_monitor_parent_class)->dispose (object);
@@ -162,34 +167,53 @@ free_watch (gpointer data)
   if (watch->notify != NULL)
     watch->notify (watch->user_data);
 
-  if (watch->timeout_source != NULL)
-    g_source_destroy (watch->timeout_source);
+  if (watch->timeout_msec == 0)
+    {
+      monitor->user_active_watches =
+        g_list_remove (monitor->user_active_watches, watch);
+    }
+  else
+    {
+      monitor->idle_watches = g_list_remove (monitor->idle_watches, watch);
+    }
 
   g_object_unref (monitor);
   g_slice_free (MetaIdleMonitorWatch, watch);
 }
 
+/*
+ * All idle watches share the same last event time, so keeping them sorted by
+ * timeout also keeps them sorted by deadline. Only the earliest deadline of a
+ * watch that has not yet fired in the current idle period is armed.
+ */
 static void
-update_inhibited_watch (gpointer key,
-                        gpointer value,
-                        gpointer user_data)
+update_timeout (MetaIdleMonitor *monitor)
 {
-  MetaIdleMonitor *monitor = user_data;
-  MetaIdleMonitorWatch *watch = value;
+  GList *l;
 
-  if (!watch->timeout_source)
+  if (!monitor->timeout_source)
     return;
 
   if (monitor->inhibited)
     {
-      g_source_set_ready_time (watch->timeout_source, -1);
+      g_source_set_ready_time (monitor->timeout_source, -1);
+      return;
     }
-  else
+
+  for (l = monitor->idle_watches; l; l = l->next)
     {
-      g_source_set_ready_time (watch->timeout_source,
+      MetaIdleMonitorWatch *watch = l->data;
+
+      if (watch->fired_event_time == monitor->last_event_time)
+        continue;
+
+      g_source_set_ready_time (monitor->timeout_source,
                                monitor->last_event_time +
                                watch->timeout_msec * 1000);
+      return;
     }
+
+  g_source_set_ready_time (monitor->timeout_source, -1);
 }
 
 static void
@@ -201,9 +225,7 @@ update_inhibited (MetaIdleMonitor *monitor,
 
   monitor->inhibited = inhibited;
 
-  g_hash_table_foreach (monitor->watches,
-                        update_inhibited_watch,
-                        monitor);
+  update_timeout (monitor);
 }
 
 static void
@@ -229,6 +251,66 @@ meta_idle_monitor_inhibited_actions_changed (GDBusProxy  *session,
     }
 }
 
+static gboolean
+idle_monitor_dispatch_timeout (GSource     *source,
+                               GSourceFunc  callback,
+                               gpointer     user_data)
+{
+  MetaIdleMonitor *monitor = META_IDLE_MONITOR (user_data);
+  GList *l, *fire_ids = NULL;
+  int64_t now;
+
+  now = g_source_get_time (source);
+
+  g_source_set_ready_time (source, -1);
+
+  /*
+   * Input events only move the last event time forward, so the armed deadline
+   * may be stale; collect what is actually due and re-arm for the rest.
+   */
+  for (l = monitor->idle_watches; l; l = l->next)
+    {
+      MetaIdleMonitorWatch *watch = l->data;
+      int64_t ready_time;
+
+      ready_time = monitor->last_event_time + watch->timeout_msec * 1000;
+      if (ready_time > now)
+        break;
+
+      if (watch->fired_event_time == monitor->last_event_time)
+        continue;
+
+      watch->fired_event_time = monitor->last_event_time;
+      fire_ids = g_list_prepend (fire_ids, GUINT_TO_POINTER (watch->id));
+    }
+
+  g_object_ref (monitor);
+
+  fire_ids = g_list_reverse (fire_ids);
+  for (l = fire_ids; l; l = l->next)
+    {
+      MetaIdleMonitorWatch *watch;
+
+      watch = g_hash_table_lookup (monitor->watches, l->data);
+      if (watch)
+        meta_idle_monitor_watch_fire (watch);
+    }
+  g_list_free (fire_ids);
+
+  update_timeout (monitor);
+
+  g_object_unref (monitor);
+
+  return G_SOURCE_CONTINUE;
+}
+
+static GSourceFuncs idle_monitor_source_funcs = {
+  .prepare = NULL,
+  .check = NULL,
+  .dispatch = idle_monitor_dispatch_timeout,
+  .finalize = NULL,
+};
+
 static void
 meta_idle_monitor_init (MetaIdleMonitor *monitor)
 {
@@ -237,6 +319,12 @@ meta_idle_monitor_init (MetaIdleMonitor *monitor)
   monitor->watches = g_hash_table_new_full (NULL, NULL, NULL, free_watch);
   monitor->last_event_time = g_get_monotonic_time ();
 
+  monitor->timeout_source = g_source_new (&idle_monitor_source_funcs,
+                                          sizeof (GSource));
+  g_source_set_callback (monitor->timeout_source, NULL, monitor, NULL);
+  g_source_set_name (monitor->timeout_source, "[mutter] Idle monitor");
+  g_source_attach (monitor->timeout_source, NULL);
+
   /* Monitor inhibitors */
   monitor->session_proxy =
     g_dbus_proxy_new_for_bus_sync (G_BUS_TYPE_SESSION,
@@ -304,34 +392,21 @@ get_next_watch_serial (void)
   return serial;
 }
 
-static gboolean
-idle_monitor_dispatch_timeout (GSource     *source,
-                               GSourceFunc  callback,
-                               gpointer     user_data)
+static int
+compare_watch_timeout (gconstpointer a,
+                       gconstpointer b)
 {
-  MetaIdleMonitorWatch *watch = (MetaIdleMonitorWatch *) user_data;
-  int64_t now;
-  int64_t ready_time;
-
-  now = g_source_get_time (source);
-  ready_time = g_source_get_ready_time (source);
-  if (ready_time > now)
-    return G_SOURCE_CONTINUE;
+  const MetaIdleMonitorWatch *watch_a = a;
+  const MetaIdleMonitorWatch *watch_b = b;
 
-  g_source_set_ready_time (watch->timeout_source, -1);
-
-  meta_idle_monitor_watch_fire (watch);
-
-  return G_SOURCE_CONTINUE;
+  if (watch_a->timeout_msec < watch_b->timeout_msec)
+    return -1;
+  else if (watch_a->timeout_msec > watch_b->timeout_msec)
+    return 1;
+  else
+    return 0;
 }
 
-static GSourceFuncs idle_monitor_source_funcs = {
-  .prepare = NULL,
-  .check = NULL,
-  .dispatch = idle_monitor_dispatch_timeout,
-  .finalize = NULL,
-};
-
 static MetaIdleMonitorWatch *
 make_watch (MetaIdleMonitor           *monitor,
             guint64                    timeout_msec,
@@ -350,27 +425,23 @@ make_watch (MetaIdleMonitor           *monitor,
   watch->notify = notify;
   watch->timeout_msec = timeout_msec;
 
+  g_hash_table_insert (monitor->watches,
+                       GUINT_TO_POINTER (watch->id),
+                       watch);
+
   if (timeout_msec != 0)
     {
-      GSource *source = g_source_new (&idle_monitor_source_funcs,
-                                      sizeof (GSource));
-
-      g_source_set_callback (source, NULL, watch, NULL);
-      if (!monitor->inhibited)
-        {
-          g_source_set_ready_time (source,
-                                   monitor->last_event_time +
-                                   timeout_msec * 1000);
-        }
-      g_source_attach (source, NULL);
-      g_source_unref (source);
-
-      watch->timeout_source = source;
+      monitor->idle_watches = g_list_insert_sorted (monitor->idle_watches,
+                                                    watch,
+                                                    compare_watch_timeout);
+      update_timeout (monitor);
+    }
+  else
+    {
+      monitor->user_active_watches =
+        g_list_prepend (monitor->user_active_watches, watch);
     }
 
-  g_hash_table_insert (monitor->watches,
-                       GUINT_TO_POINTER (watch->id),
-                       watch);
   return watch;
 }
 
@@ -488,39 +559,48 @@ meta_idle_monitor_get_idletime (MetaIdleMonitor *monitor)
 void
 meta_idle_monitor_reset_idletime (MetaIdleMonitor *monitor)
 {
-  GList *node, *watch_ids;
+  GList *node, *watch_ids = NULL;
 
   monitor->last_event_time = g_get_monotonic_time ();
 
-  watch_ids = g_hash_table_get_keys (monitor->watches);
+  /*
+   * No idle watch has fired since this event, so the shortest one is due
+   * first. A later deadline still armed for a longer watch would miss it;
+   * an earlier one is fine, the dispatch re-arms for what isn't due yet.
+   */
+  if (!monitor->inhibited && monitor->idle_watches)
+    {
+      MetaIdleMonitorWatch *watch = monitor->idle_watches->data;
+      int64_t ready_time;
+      int64_t armed_ready_time;
+
+      ready_time = monitor->last_event_time + watch->timeout_msec * 1000;
+      armed_ready_time = g_source_get_ready_time (monitor->timeout_source);
+      if (armed_ready_time != -1)
+        ready_time = MIN (ready_time, armed_ready_time);
+
+      g_source_set_ready_time (monitor->timeout_source, ready_time);
+    }
+
+  if (!monitor->user_active_watches)
+    return;
+
+  for (node = monitor->user_active_watches; node != NULL; node = node->next)
+    {
+      MetaIdleMonitorWatch *watch = node->data;
+
+      watch_ids = g_list_prepend (watch_ids, GUINT_TO_POINTER (watch->id));
+    }
 
   for (node = watch_ids; node != NULL; node = node->next)
     {
-      guint watch_id = GPOINTER_TO_UINT (node->data);
       MetaIdleMonitorWatch *watch;
 
-      watch = g_hash_table_lookup (monitor->watches,
-                                   GUINT_TO_POINTER (watch_id));
+      watch = g_hash_table_lookup (monitor->watches, node->data);
       if (!watch)
         continue;
 
-      if (watch->timeout_msec == 0)
-        {
-          meta_idle_monitor_watch_fire (watch);
-        }
-      else
-        {
-          if (monitor->inhibited)
-            {
-              g_source_set_ready_time (watch->timeout_source, -1);
-            }
-          else
-            {
-              g_source_set_ready_time (watch->timeout_source,
-                                       monitor->last_event_time +
-                                       watch->timeout_msec * 1000);
-            }
-        }
+      meta_idle_monitor_watch_fire (watch);
     }
 
   g_list_free (watch_ids);
@@ -2869,44 +2869,108 @@ meta_monitor_manager_rebuild_derived (MetaMonitorManager *manager,
   g_list_free_full (old_logical_monitors, g_object_unref);
 }
 
-void
-meta_output_parse_edid (MetaOutput *output,
-                        GBytes     *edid)
+#define MAX_CACHED_EDIDS 32
+
+typedef struct _MetaEdidInfo
+{
+  char *vendor;
+  char *product;
+  char *serial;
+} MetaEdidInfo;
+
+static void
+meta_edid_info_free (MetaEdidInfo *edid_info)
+{
+  g_free (edid_info->vendor);
+  g_free (edid_info->product);
+  g_free (edid_info->serial);
+  g_free (edid_info);
+}
+
+static MetaEdidInfo *
+meta_edid_info_new (GBytes *edid)
 {
+  MetaEdidInfo *edid_info;
   MonitorInfo *parsed_edid;
   gsize len;
 
-  if (!edid)
-    goto out;
+  edid_info = g_new0 (MetaEdidInfo, 1);
 
   parsed_edid = decode_edid (g_bytes_get_data (edid, &len));
+  if (!parsed_edid)
+    return edid_info;
 
-  if (parsed_edid)
+  edid_info->vendor = g_strndup (parsed_edid->manufacturer_code, 4);
+  if (!g_utf8_validate (edid_info->vendor, -1, NULL))
+    g_clear_pointer (&edid_info->vendor, g_free);
+
+  edid_info->product = g_strndup (parsed_edid->dsc_product_name, 14);
+  if (!g_utf8_validate (edid_info->product, -1, NULL) ||
+      edid_info->product[0] == '\0')
     {
-      output->vendor = g_strndup (parsed_edid->manufacturer_code, 4);
-      if (!g_utf8_validate (output->vendor, -1, NULL))
-        g_clear_pointer (&output->vendor, g_free);
+      g_clear_pointer (&edid_info->product, g_free);
+      edid_info->product = g_strdup_printf ("0x%04x", (unsigned) parsed_edid->product_code);
+    }
 
-      output->product = g_strndup (parsed_edid->dsc_product_name, 14);
-      if (!g_utf8_validate (output->product, -1, NULL) ||
-          output->product[0] == '\0')
-        {
-          g_clear_pointer (&output->product, g_free);
-          output->product = g_strdup_printf ("0x%04x", (unsigned) parsed_edid->product_code);
-        }
+  edid_info->serial = g_strndup (parsed_edid->dsc_serial_number, 14);
+  if (!g_utf8_validate (edid_info->serial, -1, NULL) ||
+      edid_info->serial[0] == '\0')
+    {
+      g_clear_pointer (&edid_info->serial, g_free);
+      edid_info->serial = g_strdup_printf ("0x%08x", parsed_edid->serial_number);
+    }
 
-      output->serial = g_strndup (parsed_edid->dsc_serial_number, 14);
-      if (!g_utf8_validate (output->serial, -1, NULL) ||
-          output->serial[0] == '\0')
-        {
-          g_clear_pointer (&output->serial, g_free);
-          output->serial = g_strdup_printf ("0x%08x", parsed_edid->serial_number);
-        }
+  g_free (parsed_edid);
+
+  return edid_info;
+}
+
+/*
+ * Every hotplug rereads the EDID of every connected monitor, which almost
+ * always are the same ones as last time, so keep the decoded results
+ * around keyed by the EDID contents.
+ */
+static const MetaEdidInfo *
+lookup_edid_info (GBytes *edid)
+{
+  static GHashTable *edid_cache;
+  MetaEdidInfo *edid_info;
+
+  if (!edid_cache)
+    {
+      edid_cache = g_hash_table_new_full (g_bytes_hash,
+                                          g_bytes_equal,
+                                          (GDestroyNotify) g_bytes_unref,
+                                          (GDestroyNotify) meta_edid_info_free);
+    }
+
+  edid_info = g_hash_table_lookup (edid_cache, edid);
+  if (edid_info)
+    return edid_info;
+
+  if (g_hash_table_size (edid_cache) >= MAX_CACHED_EDIDS)
+    g_hash_table_remove_all (edid_cache);
+
+  edid_info = meta_edid_info_new (edid);
+  g_hash_table_insert (edid_cache, g_bytes_ref (edid), edid_info);
+
+  return edid_info;
+}
+
+void
+meta_output_parse_edid (MetaOutput *output,
+                        GBytes     *edid)
+{
+  if (edid)
+    {
+      const MetaEdidInfo *edid_info;
 
-      g_free (parsed_edid);
+      edid_info = lookup_edid_info (edid);
+      output->vendor = g_strdup (edid_info->vendor);
+      output->product = g_strdup (edid_info->product);
+      output->serial = g_strdup (edid_info->serial);
     }
 
- out:
   if (!output->vendor)
     output->vendor = g_strdup ("unknown");
   if (!output->product)
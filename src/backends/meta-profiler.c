@@ -29,6 +29,15 @@
 
 #define META_SYSPROF_PROFILER_DBUS_PATH "/org/gnome/Sysprof3/Profiler"
 
+#define MAX_PENDING_MARKS 64
+
+typedef struct _MetaProfilerMark
+{
+  char *name;
+  int64_t begin_time_us;
+  int64_t end_time_us;
+} MetaProfilerMark;
+
 struct _MetaProfiler
 {
   MetaDBusSysprof3ProfilerSkeleton parent_instance;
@@ -37,17 +46,64 @@ struct _MetaProfiler
   GCancellable *cancellable;
 
   gboolean running;
+
+  /* Marks added before any capture was started, e.g. startup phases */
+  GArray *pending_marks;
+  guint flush_marks_id;
 };
 
 static void
 meta_sysprof_capturer_init_iface (MetaDBusSysprof3ProfilerIface *iface);
 
+static void
+meta_profiler_mark_clear (MetaProfilerMark *mark)
+{
+  g_free (mark->name);
+}
+
 G_DEFINE_TYPE_WITH_CODE (MetaProfiler,
                          meta_profiler,
                          META_DBUS_TYPE_SYSPROF3_PROFILER_SKELETON,
                          G_IMPLEMENT_INTERFACE (META_DBUS_TYPE_SYSPROF3_PROFILER,
                                                 meta_sysprof_capturer_init_iface))
 
+static void
+emit_mark (const char *name,
+           int64_t     begin_time_us,
+           int64_t     end_time_us)
+{
+  CoglTraceHead head;
+
+  head.begin_time = begin_time_us * 1000;
+  head.name = name;
+  cogl_trace_end_at (&head, end_time_us * 1000);
+}
+
+static gboolean
+flush_pending_marks (gpointer user_data)
+{
+  MetaProfiler *profiler = META_PROFILER (user_data);
+  unsigned int i;
+
+  profiler->flush_marks_id = 0;
+
+  /* Tracing is enabled from an idle callback as well; bail if it failed */
+  if (!g_private_get (&cogl_trace_thread_data))
+    return G_SOURCE_REMOVE;
+
+  for (i = 0; i < profiler->pending_marks->len; i++)
+    {
+      MetaProfilerMark *mark =
+        &g_array_index (profiler->pending_marks, MetaProfilerMark, i);
+
+      emit_mark (mark->name, mark->begin_time_us, mark->end_time_us);
+    }
+
+  g_array_set_size (profiler->pending_marks, 0);
+
+  return G_SOURCE_REMOVE;
+}
+
 static gboolean
 handle_start (MetaDBusSysprof3Profiler *dbus_profiler,
               GDBusMethodInvocation    *invocation,
@@ -93,6 +149,9 @@ handle_start (MetaDBusSysprof3Profiler *dbus_profiler,
 
   profiler->running = TRUE;
 
+  if (profiler->pending_marks->len > 0 && !profiler->flush_marks_id)
+    profiler->flush_marks_id = g_idle_add (flush_pending_marks, profiler);
+
   g_debug ("Profiler running");
 
   meta_dbus_sysprof3_profiler_complete_start (dbus_profiler, invocation, NULL);
@@ -171,6 +230,9 @@ meta_profiler_finalize (GObject *object)
 
   g_cancellable_cancel (self->cancellable);
 
+  g_clear_handle_id (&self->flush_marks_id, g_source_remove);
+  g_clear_pointer (&self->pending_marks, g_array_unref);
+
   g_clear_object (&self->cancellable);
   g_clear_object (&self->connection);
 
@@ -190,6 +252,10 @@ meta_profiler_init (MetaProfiler *self)
 {
   self->cancellable = g_cancellable_new ();
 
+  self->pending_marks = g_array_new (FALSE, FALSE, sizeof (MetaProfilerMark));
+  g_array_set_clear_func (self->pending_marks,
+                          (GDestroyNotify) meta_profiler_mark_clear);
+
   g_bus_get (G_BUS_TYPE_SESSION,
              self->cancellable,
              on_bus_acquired_cb,
@@ -201,3 +267,52 @@ meta_profiler_new (void)
 {
   return g_object_new (META_TYPE_PROFILER, NULL);
 }
+
+/**
+ * meta_profiler_is_running:
+ * @profiler: a #MetaProfiler
+ *
+ * Returns: %TRUE if a capture has been started over D-Bus
+ */
+gboolean
+meta_profiler_is_running (MetaProfiler *profiler)
+{
+  return profiler->running;
+}
+
+/**
+ * meta_profiler_add_mark:
+ * @profiler: a #MetaProfiler
+ * @name: the name of the mark
+ * @begin_time_us: the monotonic begin time in microseconds
+ * @end_time_us: the monotonic end time in microseconds
+ *
+ * Adds a mark for something that has already happened. If no capture is
+ * running yet, the mark is kept and written once the first capture starts,
+ * so that phases from before the profiler was started (such as startup)
+ * still end up in the trace. Only the most recent marks are kept.
+ */
+void
+meta_profiler_add_mark (MetaProfiler *profiler,
+                        const char   *name,
+                        int64_t       begin_time_us,
+                        int64_t       end_time_us)
+{
+  MetaProfilerMark mark;
+
+  if (g_private_get (&cogl_trace_thread_data))
+    {
+      emit_mark (name, begin_time_us, end_time_us);
+      return;
+    }
+
+  mark = (MetaProfilerMark) {
+    .name = g_strdup (name),
+    .begin_time_us = begin_time_us,
+    .end_time_us = end_time_us,
+  };
+
+  if (profiler->pending_marks->len == MAX_PENDING_MARKS)
+    g_array_remove_index (profiler->pending_marks, 0);
+  g_array_append_val (profiler->pending_marks, mark);
+}
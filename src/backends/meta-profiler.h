@@ -36,6 +36,13 @@ G_DECLARE_FINAL_TYPE (MetaProfiler,
 
 MetaProfiler * meta_profiler_new (void);
 
+gboolean meta_profiler_is_running (MetaProfiler *profiler);
+
+void meta_profiler_add_mark (MetaProfiler *profiler,
+                             const char   *name,
+                             int64_t       begin_time_us,
+                             int64_t       end_time_us);
+
 G_END_DECLS
 
 #endif /* META_PROFILER_H */
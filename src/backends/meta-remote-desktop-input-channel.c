@@ -0,0 +1,167 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+
+/*
+ * Copyright (C) 2020 Red Hat Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ *
+ */
+
+#include "config.h"
+
+#include "backends/meta-remote-desktop-input-channel.h"
+
+#include <errno.h>
+#include <gio/gio.h>
+#include <glib-unix.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+G_STATIC_ASSERT (sizeof (MetaRemoteDesktopInputRecord) == 32);
+
+/*
+ * Upper bound of records read in one main loop dispatch, so that a flooding
+ * client can't starve the frame clock.
+ */
+#define MAX_RECORDS_PER_DISPATCH 256
+
+struct _MetaRemoteDesktopInputChannel
+{
+  int fd;
+  guint source_id;
+
+  MetaRemoteDesktopInputChannelFunc func;
+  MetaRemoteDesktopInputChannelClosedFunc closed_func;
+  gpointer user_data;
+
+  MetaRemoteDesktopInputRecord records[MAX_RECORDS_PER_DISPATCH];
+  size_t pending_bytes;
+};
+
+/*
+ * The closed callback is allowed to free the channel, so nothing may touch it
+ * after this returns.
+ */
+static void
+close_channel (MetaRemoteDesktopInputChannel *channel)
+{
+  channel->source_id = 0;
+  close (channel->fd);
+  channel->fd = -1;
+
+  channel->closed_func (channel->user_data);
+}
+
+static gboolean
+on_channel_readable (int           fd,
+                     GIOCondition  condition,
+                     gpointer      user_data)
+{
+  MetaRemoteDesktopInputChannel *channel = user_data;
+  uint8_t *buffer = (uint8_t *) channel->records;
+  size_t buffer_size = sizeof (channel->records);
+  size_t n_records;
+  ssize_t ret;
+
+  if (condition & G_IO_IN)
+    {
+      do
+        ret = read (fd,
+                    buffer + channel->pending_bytes,
+                    buffer_size - channel->pending_bytes);
+      while (ret < 0 && errno == EINTR);
+
+      if (ret < 0 && errno == EAGAIN)
+        return G_SOURCE_CONTINUE;
+
+      if (ret <= 0)
+        {
+          if (ret < 0)
+            g_warning ("Failed to read remote desktop input channel: %s",
+                       g_strerror (errno));
+
+          close_channel (channel);
+          return G_SOURCE_REMOVE;
+        }
+
+      channel->pending_bytes += ret;
+      n_records = channel->pending_bytes / sizeof (MetaRemoteDesktopInputRecord);
+      if (n_records > 0)
+        {
+          size_t consumed = n_records * sizeof (MetaRemoteDesktopInputRecord);
+
+          if (!channel->func (channel->records, n_records, channel->user_data))
+            {
+              close_channel (channel);
+              return G_SOURCE_REMOVE;
+            }
+
+          channel->pending_bytes -= consumed;
+          memmove (buffer, buffer + consumed, channel->pending_bytes);
+        }
+
+      return G_SOURCE_CONTINUE;
+    }
+
+  close_channel (channel);
+  return G_SOURCE_REMOVE;
+}
+
+MetaRemoteDesktopInputChannel *
+meta_remote_desktop_input_channel_new (MetaRemoteDesktopInputChannelFunc        func,
+                                       MetaRemoteDesktopInputChannelClosedFunc  closed_func,
+                                       gpointer                                 user_data,
+                                       int                                     *out_client_fd,
+                                       GError                                 **error)
+{
+  MetaRemoteDesktopInputChannel *channel;
+  int fds[2];
+
+  if (socketpair (AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK,
+                  0, fds) < 0)
+    {
+      int errsv = errno;
+
+      g_set_error (error, G_IO_ERROR, g_io_error_from_errno (errsv),
+                   "Failed to create input channel socket: %s",
+                   g_strerror (errsv));
+      return NULL;
+    }
+
+  channel = g_new0 (MetaRemoteDesktopInputChannel, 1);
+  channel->fd = fds[0];
+  channel->func = func;
+  channel->closed_func = closed_func;
+  channel->user_data = user_data;
+  channel->source_id = g_unix_fd_add (channel->fd,
+                                      G_IO_IN | G_IO_HUP | G_IO_ERR,
+                                      on_channel_readable,
+                                      channel);
+
+  *out_client_fd = fds[1];
+
+  return channel;
+}
+
+void
+meta_remote_desktop_input_channel_free (MetaRemoteDesktopInputChannel *channel)
+{
+  g_clear_handle_id (&channel->source_id, g_source_remove);
+  if (channel->fd != -1)
+    close (channel->fd);
+  g_free (channel);
+}
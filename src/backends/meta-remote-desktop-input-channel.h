@@ -0,0 +1,74 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+
+/*
+ * Copyright (C) 2020 Red Hat Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ *
+ */
+
+#ifndef META_REMOTE_DESKTOP_INPUT_CHANNEL_H
+#define META_REMOTE_DESKTOP_INPUT_CHANNEL_H
+
+#include <glib.h>
+#include <stdint.h>
+
+typedef enum _MetaRemoteDesktopInputRecordType
+{
+  META_REMOTE_DESKTOP_INPUT_RECORD_KEYBOARD_KEYCODE = 1,
+  META_REMOTE_DESKTOP_INPUT_RECORD_KEYBOARD_KEYSYM = 2,
+  META_REMOTE_DESKTOP_INPUT_RECORD_POINTER_BUTTON = 3,
+  META_REMOTE_DESKTOP_INPUT_RECORD_POINTER_AXIS = 4,
+  META_REMOTE_DESKTOP_INPUT_RECORD_POINTER_AXIS_DISCRETE = 5,
+  META_REMOTE_DESKTOP_INPUT_RECORD_POINTER_MOTION_RELATIVE = 6,
+  META_REMOTE_DESKTOP_INPUT_RECORD_POINTER_MOTION_ABSOLUTE = 7,
+  META_REMOTE_DESKTOP_INPUT_RECORD_TOUCH_DOWN = 8,
+  META_REMOTE_DESKTOP_INPUT_RECORD_TOUCH_MOTION = 9,
+  META_REMOTE_DESKTOP_INPUT_RECORD_TOUCH_UP = 10,
+} MetaRemoteDesktopInputRecordType;
+
+/*
+ * Wire format of the input channel, in host byte order. See the
+ * OpenInputChannel method in org.gnome.Mutter.RemoteDesktop.xml for how
+ * the fields are used by each record type.
+ */
+typedef struct _MetaRemoteDesktopInputRecord
+{
+  uint32_t type;
+  uint32_t code;
+  int32_t value;
+  uint32_t stream;
+  double x;
+  double y;
+} MetaRemoteDesktopInputRecord;
+
+typedef struct _MetaRemoteDesktopInputChannel MetaRemoteDesktopInputChannel;
+
+typedef gboolean (* MetaRemoteDesktopInputChannelFunc) (const MetaRemoteDesktopInputRecord *records,
+                                                        size_t                              n_records,
+                                                        gpointer                            user_data);
+
+typedef void (* MetaRemoteDesktopInputChannelClosedFunc) (gpointer user_data);
+
+MetaRemoteDesktopInputChannel * meta_remote_desktop_input_channel_new (MetaRemoteDesktopInputChannelFunc        func,
+                                                                       MetaRemoteDesktopInputChannelClosedFunc  closed_func,
+                                                                       gpointer                                 user_data,
+                                                                       int                                     *out_client_fd,
+                                                                       GError                                 **error);
+
+void meta_remote_desktop_input_channel_free (MetaRemoteDesktopInputChannel *channel);
+
+#endif /* META_REMOTE_DESKTOP_INPUT_CHANNEL_H */
@@ -24,13 +24,16 @@
 
 #include "backends/meta-remote-desktop-session.h"
 
+#include <gio/gunixfdlist.h>
 #include <linux/input.h>
 #include <xkbcommon/xkbcommon.h>
 #include <stdlib.h>
+#include <unistd.h>
 
 #include "backends/meta-dbus-session-watcher.h"
 #include "backends/meta-screen-cast-session.h"
 #include "backends/meta-remote-access-controller-private.h"
+#include "backends/meta-remote-desktop-input-channel.h"
 #include "backends/x11/meta-backend-x11.h"
 #include "cogl/cogl.h"
 #include "meta/meta-backend.h"
@@ -60,6 +63,9 @@ struct _MetaRemoteDesktopSession
   ClutterVirtualInputDevice *virtual_keyboard;
   ClutterVirtualInputDevice *virtual_touchscreen;
 
+  MetaRemoteDesktopInputChannel *input_channel;
+  char **input_channel_streams;
+
   MetaRemoteDesktopSessionHandle *handle;
 };
 
@@ -157,6 +163,10 @@ meta_remote_desktop_session_close (MetaRemoteDesktopSession *session)
       session->screen_cast_session = NULL;
     }
 
+  g_clear_pointer (&session->input_channel,
+                   meta_remote_desktop_input_channel_free);
+  g_clear_pointer (&session->input_channel_streams, g_strfreev);
+
   g_clear_object (&session->virtual_pointer);
   g_clear_object (&session->virtual_keyboard);
   g_clear_object (&session->virtual_touchscreen);
@@ -428,6 +438,27 @@ handle_notify_pointer_button (MetaDBusRemoteDesktopSession *skeleton,
   return TRUE;
 }
 
+static void
+notify_pointer_axis (MetaRemoteDesktopSession *session,
+                     double                    dx,
+                     double                    dy,
+                     uint32_t                  flags)
+{
+  ClutterScrollFinishFlags finish_flags = CLUTTER_SCROLL_FINISHED_NONE;
+
+  if (flags & META_REMOTE_DESKTOP_NOTIFY_AXIS_FLAGS_FINISH)
+    {
+      finish_flags |= (CLUTTER_SCROLL_FINISHED_HORIZONTAL |
+                       CLUTTER_SCROLL_FINISHED_VERTICAL);
+    }
+
+  clutter_virtual_input_device_notify_scroll_continuous (session->virtual_pointer,
+                                                         CLUTTER_CURRENT_TIME,
+                                                         dx, dy,
+                                                         CLUTTER_SCROLL_SOURCE_FINGER,
+                                                         finish_flags);
+}
+
 static gboolean
 handle_notify_pointer_axis (MetaDBusRemoteDesktopSession *skeleton,
                             GDBusMethodInvocation        *invocation,
@@ -436,7 +467,6 @@ handle_notify_pointer_axis (MetaDBusRemoteDesktopSession *skeleton,
                             uint32_t                      flags)
 {
   MetaRemoteDesktopSession *session = META_REMOTE_DESKTOP_SESSION (skeleton);
-  ClutterScrollFinishFlags finish_flags = CLUTTER_SCROLL_FINISHED_NONE;
 
   if (!check_permission (session, invocation))
     {
@@ -446,17 +476,7 @@ handle_notify_pointer_axis (MetaDBusRemoteDesktopSession *skeleton,
       return TRUE;
     }
 
-  if (flags & META_REMOTE_DESKTOP_NOTIFY_AXIS_FLAGS_FINISH)
-    {
-      finish_flags |= (CLUTTER_SCROLL_FINISHED_HORIZONTAL |
-                       CLUTTER_SCROLL_FINISHED_VERTICAL);
-    }
-
-  clutter_virtual_input_device_notify_scroll_continuous (session->virtual_pointer,
-                                                         CLUTTER_CURRENT_TIME,
-                                                         dx, dy,
-                                                         CLUTTER_SCROLL_SOURCE_FINGER,
-                                                         finish_flags);
+  notify_pointer_axis (session, dx, dy, flags);
 
   meta_dbus_remote_desktop_session_complete_notify_pointer_axis (skeleton,
                                                                  invocation);
@@ -481,6 +501,28 @@ discrete_steps_to_scroll_direction (unsigned int axis,
   return 0;
 }
 
+static void
+notify_pointer_axis_discrete (MetaRemoteDesktopSession *session,
+                              unsigned int              axis,
+                              int                       steps)
+{
+  ClutterScrollDirection direction;
+  int step_count;
+
+  /*
+   * We don't have the actual scroll source, but only know they should be
+   * considered as discrete steps. The device that produces such scroll events
+   * is the scroll wheel, so pretend that is the scroll source.
+   */
+  direction = discrete_steps_to_scroll_direction (axis, steps);
+
+  for (step_count = 0; step_count < abs (steps); step_count++)
+    clutter_virtual_input_device_notify_discrete_scroll (session->virtual_pointer,
+                                                         CLUTTER_CURRENT_TIME,
+                                                         direction,
+                                                         CLUTTER_SCROLL_SOURCE_WHEEL);
+}
+
 static gboolean
 handle_notify_pointer_axis_discrete (MetaDBusRemoteDesktopSession *skeleton,
                                      GDBusMethodInvocation        *invocation,
@@ -488,8 +530,6 @@ handle_notify_pointer_axis_discrete (MetaDBusRemoteDesktopSession *skeleton,
                                      int                           steps)
 {
   MetaRemoteDesktopSession *session = META_REMOTE_DESKTOP_SESSION (skeleton);
-  ClutterScrollDirection direction;
-  int step_count;
 
   if (!check_permission (session, invocation))
     {
@@ -515,18 +555,7 @@ handle_notify_pointer_axis_discrete (MetaDBusRemoteDesktopSession *skeleton,
       return TRUE;
     }
 
-  /*
-   * We don't have the actual scroll source, but only know they should be
-   * considered as discrete steps. The device that produces such scroll events
-   * is the scroll wheel, so pretend that is the scroll source.
-   */
-  direction = discrete_steps_to_scroll_direction (axis, steps);
-
-  for (step_count = 0; step_count < abs (steps); step_count++)
-    clutter_virtual_input_device_notify_discrete_scroll (session->virtual_pointer,
-                                                         CLUTTER_CURRENT_TIME,
-                                                         direction,
-                                                         CLUTTER_SCROLL_SOURCE_WHEEL);
+  notify_pointer_axis_discrete (session, axis, steps);
 
   meta_dbus_remote_desktop_session_complete_notify_pointer_axis_discrete (skeleton,
                                                                           invocation);
@@ -560,6 +589,38 @@ handle_notify_pointer_motion_relative (MetaDBusRemoteDesktopSession *skeleton,
   return TRUE;
 }
 
+static gboolean
+transform_stream_position (MetaRemoteDesktopSession  *session,
+                           const char                *stream_path,
+                           double                     x,
+                           double                     y,
+                           double                    *abs_x,
+                           double                    *abs_y,
+                           GError                   **error)
+{
+  MetaScreenCastStream *stream;
+
+  if (!session->screen_cast_session)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                   "No screen cast active");
+      return FALSE;
+    }
+
+  stream = meta_screen_cast_session_get_stream (session->screen_cast_session,
+                                                stream_path);
+  if (!stream)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_NOT_FOUND,
+                   "Unknown stream");
+      return FALSE;
+    }
+
+  meta_screen_cast_stream_transform_position (stream, x, y, abs_x, abs_y);
+
+  return TRUE;
+}
+
 static gboolean
 handle_notify_pointer_motion_absolute (MetaDBusRemoteDesktopSession *skeleton,
                                        GDBusMethodInvocation        *invocation,
@@ -568,8 +629,8 @@ handle_notify_pointer_motion_absolute (MetaDBusRemoteDesktopSession *skeleton,
                                        double                        y)
 {
   MetaRemoteDesktopSession *session = META_REMOTE_DESKTOP_SESSION (skeleton);
-  MetaScreenCastStream *stream;
   double abs_x, abs_y;
+  GError *error = NULL;
 
   if (!check_permission (session, invocation))
     {
@@ -579,26 +640,16 @@ handle_notify_pointer_motion_absolute (MetaDBusRemoteDesktopSession *skeleton,
       return TRUE;
     }
 
-  if (!session->screen_cast_session)
-    {
-      g_dbus_method_invocation_return_error (invocation, G_DBUS_ERROR,
-                                             G_DBUS_ERROR_FAILED,
-                                             "No screen cast active");
-      return TRUE;
-    }
-
-  stream = meta_screen_cast_session_get_stream (session->screen_cast_session,
-                                                stream_path);
-  if (!stream)
+  if (!transform_stream_position (session, stream_path, x, y,
+                                  &abs_x, &abs_y, &error))
     {
       g_dbus_method_invocation_return_error (invocation, G_DBUS_ERROR,
                                              G_DBUS_ERROR_FAILED,
-                                             "Unknown stream");
+                                             "%s", error->message);
+      g_error_free (error);
       return TRUE;
     }
 
-  meta_screen_cast_stream_transform_position (stream, x, y, &abs_x, &abs_y);
-
   clutter_virtual_input_device_notify_absolute_motion (session->virtual_pointer,
                                                        CLUTTER_CURRENT_TIME,
                                                        abs_x, abs_y);
@@ -618,8 +669,8 @@ handle_notify_touch_down (MetaDBusRemoteDesktopSession *skeleton,
                           double                        y)
 {
   MetaRemoteDesktopSession *session = META_REMOTE_DESKTOP_SESSION (skeleton);
-  MetaScreenCastStream *stream;
   double abs_x, abs_y;
+  GError *error = NULL;
 
   if (!check_permission (session, invocation))
     {
@@ -629,26 +680,16 @@ handle_notify_touch_down (MetaDBusRemoteDesktopSession *skeleton,
       return TRUE;
     }
 
-  if (!session->screen_cast_session)
+  if (!transform_stream_position (session, stream_path, x, y,
+                                  &abs_x, &abs_y, &error))
     {
       g_dbus_method_invocation_return_error (invocation, G_DBUS_ERROR,
                                              G_DBUS_ERROR_FAILED,
-                                             "No screen cast active");
-      return TRUE;
-    }
-
-  stream = meta_screen_cast_session_get_stream (session->screen_cast_session,
-                                                stream_path);
-  if (!stream)
-    {
-      g_dbus_method_invocation_return_error (invocation, G_DBUS_ERROR,
-                                             G_DBUS_ERROR_FAILED,
-                                             "Unknown stream");
+                                             "%s", error->message);
+      g_error_free (error);
       return TRUE;
     }
 
-  meta_screen_cast_stream_transform_position (stream, x, y, &abs_x, &abs_y);
-
   clutter_virtual_input_device_notify_touch_down (session->virtual_touchscreen,
                                                   CLUTTER_CURRENT_TIME,
                                                   slot,
@@ -669,8 +710,8 @@ handle_notify_touch_motion (MetaDBusRemoteDesktopSession *skeleton,
                             double                        y)
 {
   MetaRemoteDesktopSession *session = META_REMOTE_DESKTOP_SESSION (skeleton);
-  MetaScreenCastStream *stream;
   double abs_x, abs_y;
+  GError *error = NULL;
 
   if (!check_permission (session, invocation))
     {
@@ -680,26 +721,16 @@ handle_notify_touch_motion (MetaDBusRemoteDesktopSession *skeleton,
       return TRUE;
     }
 
-  if (!session->screen_cast_session)
+  if (!transform_stream_position (session, stream_path, x, y,
+                                  &abs_x, &abs_y, &error))
     {
       g_dbus_method_invocation_return_error (invocation, G_DBUS_ERROR,
                                              G_DBUS_ERROR_FAILED,
-                                             "No screen cast active");
-      return TRUE;
-    }
-
-  stream = meta_screen_cast_session_get_stream (session->screen_cast_session,
-                                                stream_path);
-  if (!stream)
-    {
-      g_dbus_method_invocation_return_error (invocation, G_DBUS_ERROR,
-                                             G_DBUS_ERROR_FAILED,
-                                             "Unknown stream");
+                                             "%s", error->message);
+      g_error_free (error);
       return TRUE;
     }
 
-  meta_screen_cast_stream_transform_position (stream, x, y, &abs_x, &abs_y);
-
   clutter_virtual_input_device_notify_touch_motion (session->virtual_touchscreen,
                                                     CLUTTER_CURRENT_TIME,
                                                     slot,
@@ -736,6 +767,218 @@ handle_notify_touch_up (MetaDBusRemoteDesktopSession *skeleton,
   return TRUE;
 }
 
+static gboolean
+transform_input_record_position (MetaRemoteDesktopSession           *session,
+                                 const MetaRemoteDesktopInputRecord *record,
+                                 double                             *abs_x,
+                                 double                             *abs_y)
+{
+  g_autoptr (GError) error = NULL;
+
+  if (record->stream >= g_strv_length (session->input_channel_streams))
+    {
+      g_warning ("Invalid stream index %u in remote desktop input record",
+                 record->stream);
+      return FALSE;
+    }
+
+  if (!transform_stream_position (session,
+                                  session->input_channel_streams[record->stream],
+                                  record->x, record->y,
+                                  abs_x, abs_y,
+                                  &error))
+    {
+      g_warning ("Invalid remote desktop input record: %s", error->message);
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+static gboolean
+process_input_records (const MetaRemoteDesktopInputRecord *records,
+                       size_t                              n_records,
+                       gpointer                            user_data)
+{
+  MetaRemoteDesktopSession *session = user_data;
+  size_t i;
+
+  for (i = 0; i < n_records; i++)
+    {
+      const MetaRemoteDesktopInputRecord *record = &records[i];
+      double abs_x, abs_y;
+
+      switch ((MetaRemoteDesktopInputRecordType) record->type)
+        {
+        case META_REMOTE_DESKTOP_INPUT_RECORD_KEYBOARD_KEYCODE:
+          clutter_virtual_input_device_notify_key (session->virtual_keyboard,
+                                                   CLUTTER_CURRENT_TIME,
+                                                   record->code,
+                                                   record->value ?
+                                                   CLUTTER_KEY_STATE_PRESSED :
+                                                   CLUTTER_KEY_STATE_RELEASED);
+          break;
+        case META_REMOTE_DESKTOP_INPUT_RECORD_KEYBOARD_KEYSYM:
+          clutter_virtual_input_device_notify_keyval (session->virtual_keyboard,
+                                                      CLUTTER_CURRENT_TIME,
+                                                      record->code,
+                                                      record->value ?
+                                                      CLUTTER_KEY_STATE_PRESSED :
+                                                      CLUTTER_KEY_STATE_RELEASED);
+          break;
+        case META_REMOTE_DESKTOP_INPUT_RECORD_POINTER_BUTTON:
+          clutter_virtual_input_device_notify_button (session->virtual_pointer,
+                                                      CLUTTER_CURRENT_TIME,
+                                                      translate_to_clutter_button (record->code),
+                                                      record->value ?
+                                                      CLUTTER_BUTTON_STATE_PRESSED :
+                                                      CLUTTER_BUTTON_STATE_RELEASED);
+          break;
+        case META_REMOTE_DESKTOP_INPUT_RECORD_POINTER_AXIS:
+          notify_pointer_axis (session, record->x, record->y, record->code);
+          break;
+        case META_REMOTE_DESKTOP_INPUT_RECORD_POINTER_AXIS_DISCRETE:
+          if (record->code > 1 || record->value == 0)
+            {
+              g_warning ("Invalid discrete axis remote desktop input record");
+              return FALSE;
+            }
+
+          notify_pointer_axis_discrete (session, record->code, record->value);
+          break;
+        case META_REMOTE_DESKTOP_INPUT_RECORD_POINTER_MOTION_RELATIVE:
+          clutter_virtual_input_device_notify_relative_motion (session->virtual_pointer,
+                                                               CLUTTER_CURRENT_TIME,
+                                                               record->x,
+                                                               record->y);
+          break;
+        case META_REMOTE_DESKTOP_INPUT_RECORD_POINTER_MOTION_ABSOLUTE:
+          if (!transform_input_record_position (session, record,
+                                                &abs_x, &abs_y))
+            return FALSE;
+
+          clutter_virtual_input_device_notify_absolute_motion (session->virtual_pointer,
+                                                               CLUTTER_CURRENT_TIME,
+                                                               abs_x, abs_y);
+          break;
+        case META_REMOTE_DESKTOP_INPUT_RECORD_TOUCH_DOWN:
+          if (!transform_input_record_position (session, record,
+                                                &abs_x, &abs_y))
+            return FALSE;
+
+          clutter_virtual_input_device_notify_touch_down (session->virtual_touchscreen,
+                                                          CLUTTER_CURRENT_TIME,
+                                                          record->code,
+                                                          abs_x, abs_y);
+          break;
+        case META_REMOTE_DESKTOP_INPUT_RECORD_TOUCH_MOTION:
+          if (!transform_input_record_position (session, record,
+                                                &abs_x, &abs_y))
+            return FALSE;
+
+          clutter_virtual_input_device_notify_touch_motion (session->virtual_touchscreen,
+                                                            CLUTTER_CURRENT_TIME,
+                                                            record->code,
+                                                            abs_x, abs_y);
+          break;
+        case META_REMOTE_DESKTOP_INPUT_RECORD_TOUCH_UP:
+          clutter_virtual_input_device_notify_touch_up (session->virtual_touchscreen,
+                                                        CLUTTER_CURRENT_TIME,
+                                                        record->code);
+          break;
+        default:
+          g_warning ("Unknown remote desktop input record type %u",
+                     record->type);
+          return FALSE;
+        }
+    }
+
+  return TRUE;
+}
+
+static void
+on_input_channel_closed (gpointer user_data)
+{
+  MetaRemoteDesktopSession *session = user_data;
+
+  g_clear_pointer (&session->input_channel,
+                   meta_remote_desktop_input_channel_free);
+  g_clear_pointer (&session->input_channel_streams, g_strfreev);
+}
+
+static gboolean
+handle_open_input_channel (MetaDBusRemoteDesktopSession *skeleton,
+                           GDBusMethodInvocation        *invocation,
+                           GUnixFDList                  *in_fd_list,
+                           const char * const           *streams)
+{
+  MetaRemoteDesktopSession *session = META_REMOTE_DESKTOP_SESSION (skeleton);
+  g_autoptr (GUnixFDList) fd_list = NULL;
+  g_autoptr (GError) error = NULL;
+  int client_fd;
+  int fd_index;
+
+  if (!check_permission (session, invocation))
+    {
+      g_dbus_method_invocation_return_error (invocation, G_DBUS_ERROR,
+                                             G_DBUS_ERROR_ACCESS_DENIED,
+                                             "Permission denied");
+      return TRUE;
+    }
+
+  if (!meta_remote_desktop_session_is_running (session))
+    {
+      g_dbus_method_invocation_return_error (invocation, G_DBUS_ERROR,
+                                             G_DBUS_ERROR_FAILED,
+                                             "Session not started");
+      return TRUE;
+    }
+
+  if (session->input_channel)
+    {
+      g_dbus_method_invocation_return_error (invocation, G_DBUS_ERROR,
+                                             G_DBUS_ERROR_FAILED,
+                                             "Input channel already open");
+      return TRUE;
+    }
+
+  session->input_channel =
+    meta_remote_desktop_input_channel_new (process_input_records,
+                                           on_input_channel_closed,
+                                           session,
+                                           &client_fd,
+                                           &error);
+  if (!session->input_channel)
+    {
+      g_dbus_method_invocation_return_error (invocation, G_DBUS_ERROR,
+                                             G_DBUS_ERROR_FAILED,
+                                             "%s", error->message);
+      return TRUE;
+    }
+
+  session->input_channel_streams = g_strdupv ((char **) streams);
+
+  fd_list = g_unix_fd_list_new ();
+  fd_index = g_unix_fd_list_append (fd_list, client_fd, &error);
+  close (client_fd);
+  if (fd_index == -1)
+    {
+      on_input_channel_closed (session);
+      g_dbus_method_invocation_return_error (invocation, G_DBUS_ERROR,
+                                             G_DBUS_ERROR_FAILED,
+                                             "Failed to pass input channel: %s",
+                                             error->message);
+      return TRUE;
+    }
+
+  meta_dbus_remote_desktop_session_complete_open_input_channel (skeleton,
+                                                                invocation,
+                                                                fd_list,
+                                                                g_variant_new_handle (fd_index));
+
+  return TRUE;
+}
+
 static void
 meta_remote_desktop_session_init_iface (MetaDBusRemoteDesktopSessionIface *iface)
 {
@@ -751,6 +994,7 @@ meta_remote_desktop_session_init_iface (MetaDBusRemoteDesktopSessionIface *iface
   iface->handle_notify_touch_down = handle_notify_touch_down;
   iface->handle_notify_touch_motion = handle_notify_touch_motion;
   iface->handle_notify_touch_up = handle_notify_touch_up;
+  iface->handle_open_input_channel = handle_open_input_channel;
 }
 
 static void
@@ -108,6 +108,7 @@ typedef struct _MetaCursorNativeGpuState
   guint active_bo;
   MetaCursorGbmBoState pending_bo_state;
   struct gbm_bo *bos[HW_CURSOR_BUFFER_COUNT];
+  gboolean shared_bos[HW_CURSOR_BUFFER_COUNT];
 } MetaCursorNativeGpuState;
 
 typedef struct _MetaCursorNativePrivate
@@ -117,6 +118,9 @@ typedef struct _MetaCursorNativePrivate
 
 static GQuark quark_cursor_renderer_native_gpu_data = 0;
 
+/* Buffers of themed cursors, shared by all sprites showing the same frame */
+static CoglUserDataKey shared_cursor_bos_key;
+
 G_DEFINE_TYPE_WITH_PRIVATE (MetaCursorRendererNative, meta_cursor_renderer_native, META_TYPE_CURSOR_RENDERER);
 
 static void
@@ -192,10 +196,23 @@ get_active_cursor_sprite_gbm_bo (MetaCursorNativeGpuState *cursor_gpu_state)
   return cursor_gpu_state->bos[cursor_gpu_state->active_bo];
 }
 
+static void
+clear_cursor_sprite_gbm_bo (MetaCursorNativeGpuState *cursor_gpu_state,
+                            guint                     bo_index)
+{
+  if (cursor_gpu_state->bos[bo_index] &&
+      !cursor_gpu_state->shared_bos[bo_index])
+    gbm_bo_destroy (cursor_gpu_state->bos[bo_index]);
+
+  cursor_gpu_state->bos[bo_index] = NULL;
+  cursor_gpu_state->shared_bos[bo_index] = FALSE;
+}
+
 static void
 set_pending_cursor_sprite_gbm_bo (MetaCursorSprite *cursor_sprite,
                                   MetaGpuKms       *gpu_kms,
-                                  struct gbm_bo    *bo)
+                                  struct gbm_bo    *bo,
+                                  gboolean          is_shared)
 {
   MetaCursorNativePrivate *cursor_priv;
   MetaCursorNativeGpuState *cursor_gpu_state;
@@ -206,6 +223,7 @@ set_pending_cursor_sprite_gbm_bo (MetaCursorSprite *cursor_sprite,
 
   pending_bo = get_pending_cursor_sprite_gbm_bo_index (cursor_gpu_state);
   cursor_gpu_state->bos[pending_bo] = bo;
+  cursor_gpu_state->shared_bos[pending_bo] = is_shared;
   cursor_gpu_state->pending_bo_state = META_CURSOR_GBM_BO_STATE_SET;
 }
 
@@ -777,7 +795,7 @@ cursor_gpu_state_free (MetaCursorNativeGpuState *cursor_gpu_state)
     unset_crtc_cursor_renderer_privates (cursor_gpu_state->gpu, active_bo);
 
   for (i = 0; i < HW_CURSOR_BUFFER_COUNT; i++)
-    g_clear_pointer (&cursor_gpu_state->bos[i], gbm_bo_destroy);
+    clear_cursor_sprite_gbm_bo (cursor_gpu_state, i);
   g_free (cursor_gpu_state);
 }
 
@@ -817,8 +835,7 @@ on_cursor_sprite_texture_changed (MetaCursorSprite *cursor_sprite)
     {
       guint pending_bo;
       pending_bo = get_pending_cursor_sprite_gbm_bo_index (cursor_gpu_state);
-      g_clear_pointer (&cursor_gpu_state->bos[pending_bo],
-                       gbm_bo_destroy);
+      clear_cursor_sprite_gbm_bo (cursor_gpu_state, pending_bo);
       cursor_gpu_state->pending_bo_state = META_CURSOR_GBM_BO_STATE_INVALIDATED;
     }
 }
@@ -862,15 +879,13 @@ ensure_cursor_priv (MetaCursorSprite *cursor_sprite)
   return cursor_priv;
 }
 
-static void
-load_cursor_sprite_gbm_buffer_for_gpu (MetaCursorRendererNative *native,
-                                       MetaGpuKms               *gpu_kms,
-                                       MetaCursorSprite         *cursor_sprite,
-                                       uint8_t                  *pixels,
-                                       uint                      width,
-                                       uint                      height,
-                                       int                       rowstride,
-                                       uint32_t                  gbm_format)
+static struct gbm_bo *
+create_cursor_gbm_bo (MetaGpuKms *gpu_kms,
+                      uint8_t    *pixels,
+                      uint        width,
+                      uint        height,
+                      int         rowstride,
+                      uint32_t    gbm_format)
 {
   uint64_t cursor_width, cursor_height;
   MetaCursorRendererNativeGpuData *cursor_renderer_gpu_data;
@@ -879,7 +894,7 @@ load_cursor_sprite_gbm_buffer_for_gpu (MetaCursorRendererNative *native,
   cursor_renderer_gpu_data =
     meta_cursor_renderer_native_gpu_data_from_gpu (gpu_kms);
   if (!cursor_renderer_gpu_data)
-    return;
+    return NULL;
 
   cursor_width = (uint64_t) cursor_renderer_gpu_data->cursor_width;
   cursor_height = (uint64_t) cursor_renderer_gpu_data->cursor_height;
@@ -888,7 +903,7 @@ load_cursor_sprite_gbm_buffer_for_gpu (MetaCursorRendererNative *native,
     {
       meta_warning ("Invalid theme cursor size (must be at most %ux%u)\n",
                     (unsigned int)cursor_width, (unsigned int)cursor_height);
-      return;
+      return NULL;
     }
 
   gbm_device = meta_gbm_device_from_gpu (gpu_kms);
@@ -904,7 +919,7 @@ load_cursor_sprite_gbm_buffer_for_gpu (MetaCursorRendererNative *native,
       if (!bo)
         {
           meta_warning ("Failed to allocate HW cursor buffer\n");
-          return;
+          return NULL;
         }
 
       memset (buf, 0, sizeof(buf));
@@ -915,17 +930,88 @@ load_cursor_sprite_gbm_buffer_for_gpu (MetaCursorRendererNative *native,
           meta_warning ("Failed to write cursors buffer data: %s",
                         g_strerror (errno));
           gbm_bo_destroy (bo);
-          return;
+          return NULL;
         }
 
-      set_pending_cursor_sprite_gbm_bo (cursor_sprite, gpu_kms, bo);
+      return bo;
     }
   else
     {
       meta_warning ("HW cursor for format %d not supported\n", gbm_format);
+      return NULL;
     }
 }
 
+static void
+load_cursor_sprite_gbm_buffer_for_gpu (MetaCursorRendererNative *native,
+                                       MetaGpuKms               *gpu_kms,
+                                       MetaCursorSprite         *cursor_sprite,
+                                       uint8_t                  *pixels,
+                                       uint                      width,
+                                       uint                      height,
+                                       int                       rowstride,
+                                       uint32_t                  gbm_format)
+{
+  struct gbm_bo *bo;
+
+  bo = create_cursor_gbm_bo (gpu_kms, pixels, width, height, rowstride,
+                             gbm_format);
+  if (bo)
+    set_pending_cursor_sprite_gbm_bo (cursor_sprite, gpu_kms, bo, FALSE);
+}
+
+static void
+shared_cursor_bos_free (GHashTable *shared_bos)
+{
+  GHashTableIter iter;
+  MetaGpu *gpu;
+  struct gbm_bo *bo;
+
+  g_hash_table_iter_init (&iter, shared_bos);
+  while (g_hash_table_iter_next (&iter, (gpointer *) &gpu, (gpointer *) &bo))
+    {
+      unset_crtc_cursor_renderer_privates (gpu, bo);
+      gbm_bo_destroy (bo);
+    }
+
+  g_hash_table_destroy (shared_bos);
+}
+
+static struct gbm_bo *
+ensure_shared_cursor_gbm_bo (MetaGpuKms   *gpu_kms,
+                             CoglTexture  *texture,
+                             XcursorImage *xc_image)
+{
+  GHashTable *shared_bos;
+  struct gbm_bo *bo;
+
+  shared_bos = cogl_object_get_user_data (COGL_OBJECT (texture),
+                                          &shared_cursor_bos_key);
+  if (!shared_bos)
+    {
+      shared_bos = g_hash_table_new (NULL, NULL);
+      cogl_object_set_user_data (COGL_OBJECT (texture),
+                                 &shared_cursor_bos_key,
+                                 shared_bos,
+                                 (CoglUserDataDestroyCallback) shared_cursor_bos_free);
+    }
+
+  bo = g_hash_table_lookup (shared_bos, gpu_kms);
+  if (bo)
+    return bo;
+
+  bo = create_cursor_gbm_bo (gpu_kms,
+                             (uint8_t *) xc_image->pixels,
+                             xc_image->width,
+                             xc_image->height,
+                             xc_image->width * 4,
+                             GBM_FORMAT_ARGB8888);
+  if (bo)
+    g_hash_table_insert (shared_bos, gpu_kms, bo);
+
+  return bo;
+}
+
 static gboolean
 is_cursor_hw_state_valid (MetaCursorSprite *cursor_sprite,
                           MetaGpuKms       *gpu_kms)
@@ -1062,7 +1148,7 @@ realize_cursor_sprite_from_wl_buffer_for_gpu (MetaCursorRenderer      *renderer,
           return;
         }
 
-      set_pending_cursor_sprite_gbm_bo (cursor_sprite, gpu_kms, bo);
+      set_pending_cursor_sprite_gbm_bo (cursor_sprite, gpu_kms, bo, FALSE);
     }
 }
 #endif
@@ -1076,6 +1162,7 @@ realize_cursor_sprite_from_xcursor_for_gpu (MetaCursorRenderer      *renderer,
   MetaCursorRendererNativeGpuData *cursor_renderer_gpu_data;
   MetaCursorSprite *cursor_sprite = META_CURSOR_SPRITE (sprite_xcursor);
   XcursorImage *xc_image;
+  CoglTexture *texture;
 
   cursor_renderer_gpu_data =
     meta_cursor_renderer_native_gpu_data_from_gpu (gpu_kms);
@@ -1087,6 +1174,21 @@ realize_cursor_sprite_from_xcursor_for_gpu (MetaCursorRenderer      *renderer,
 
   xc_image = meta_cursor_sprite_xcursor_get_current_image (sprite_xcursor);
 
+  /*
+   * Theme cursor frames and their textures are shared between sprites, so
+   * upload each frame once per GPU, and keep the buffer with the texture.
+   */
+  texture = meta_cursor_sprite_get_cogl_texture (cursor_sprite);
+  if (texture)
+    {
+      struct gbm_bo *bo;
+
+      bo = ensure_shared_cursor_gbm_bo (gpu_kms, texture, xc_image);
+      if (bo)
+        set_pending_cursor_sprite_gbm_bo (cursor_sprite, gpu_kms, bo, TRUE);
+      return;
+    }
+
   load_cursor_sprite_gbm_buffer_for_gpu (native,
                                          gpu_kms,
                                          cursor_sprite,
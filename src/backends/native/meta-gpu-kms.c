@@ -200,27 +200,6 @@ meta_crtc_mode_destroy_notify (MetaCrtcMode *mode)
   g_slice_free (drmModeModeInfo, mode->driver_private);
 }
 
-gboolean
-meta_drm_mode_equal (const drmModeModeInfo *one,
-                     const drmModeModeInfo *two)
-{
-  return (one->clock == two->clock &&
-          one->hdisplay == two->hdisplay &&
-          one->hsync_start == two->hsync_start &&
-          one->hsync_end == two->hsync_end &&
-          one->htotal == two->htotal &&
-          one->hskew == two->hskew &&
-          one->vdisplay == two->vdisplay &&
-          one->vsync_start == two->vsync_start &&
-          one->vsync_end == two->vsync_end &&
-          one->vtotal == two->vtotal &&
-          one->vscan == two->vscan &&
-          one->vrefresh == two->vrefresh &&
-          one->flags == two->flags &&
-          one->type == two->type &&
-          strncmp (one->name, two->name, DRM_DISPLAY_MODE_LEN) == 0);
-}
-
 static guint
 drm_mode_hash (gconstpointer ptr)
 {
@@ -35,6 +35,9 @@ struct _MetaKeymapNative
   ClutterKeymap parent_instance;
 
   struct xkb_keymap *keymap;
+
+  /* Per layout keysym -> packed (keycode, level) lookup tables */
+  GPtrArray *keycode_indices;
 };
 
 G_DEFINE_TYPE (MetaKeymapNative, meta_keymap_native,
@@ -46,6 +49,7 @@ meta_keymap_native_finalize (GObject *object)
   MetaKeymapNative *keymap = META_KEYMAP_NATIVE (object);
 
   xkb_keymap_unref (keymap->keymap);
+  g_clear_pointer (&keymap->keycode_indices, g_ptr_array_unref);
 
   G_OBJECT_CLASS (meta_keymap_native_parent_class)->finalize (object);
 }
@@ -119,6 +123,8 @@ meta_keymap_native_set_keyboard_map (MetaKeymapNative  *keymap,
   if (keymap->keymap)
     xkb_keymap_unref (keymap->keymap);
   keymap->keymap = xkb_keymap_ref (xkb_keymap);
+
+  g_clear_pointer (&keymap->keycode_indices, g_ptr_array_unref);
 }
 
 struct xkb_keymap *
@@ -126,3 +132,104 @@ meta_keymap_native_get_keyboard_map (MetaKeymapNative *keymap)
 {
   return keymap->keymap;
 }
+
+#define PACK_KEYCODE_LEVEL(keycode, level) \
+  (GUINT_TO_POINTER (((level) << 24) | ((keycode) & 0xffffff)))
+#define UNPACK_KEYCODE(packed) (GPOINTER_TO_UINT (packed) & 0xffffff)
+#define UNPACK_LEVEL(packed) (GPOINTER_TO_UINT (packed) >> 24)
+
+static GHashTable *
+build_keycode_index (struct xkb_keymap  *xkb_keymap,
+                     xkb_layout_index_t  layout)
+{
+  GHashTable *keycode_index;
+  xkb_keycode_t min_keycode, max_keycode;
+  xkb_keycode_t keycode;
+
+  keycode_index = g_hash_table_new (NULL, NULL);
+
+  min_keycode = xkb_keymap_min_keycode (xkb_keymap);
+  max_keycode = xkb_keymap_max_keycode (xkb_keymap);
+  for (keycode = min_keycode; keycode < max_keycode; keycode++)
+    {
+      int num_levels, level;
+
+      num_levels = xkb_keymap_num_levels_for_key (xkb_keymap, keycode, layout);
+      for (level = 0; level < num_levels && level < 0xff; level++)
+        {
+          const xkb_keysym_t *syms;
+          int num_syms, sym;
+
+          num_syms = xkb_keymap_key_get_syms_by_level (xkb_keymap, keycode,
+                                                       layout, level, &syms);
+          for (sym = 0; sym < num_syms; sym++)
+            {
+              gpointer key = GUINT_TO_POINTER (syms[sym]);
+
+              /* Prefer the lowest keycode and level, like a linear scan */
+              if (g_hash_table_contains (keycode_index, key))
+                continue;
+
+              g_hash_table_insert (keycode_index, key,
+                                   PACK_KEYCODE_LEVEL (keycode, level));
+            }
+        }
+    }
+
+  return keycode_index;
+}
+
+/**
+ * meta_keymap_native_lookup_keyval:
+ * @keymap: a #MetaKeymapNative
+ * @layout: the xkb layout index to look up @keyval in
+ * @keyval: the keysym to look up
+ * @keycode_out: (out): return location for the keycode
+ * @level_out: (out) (optional): return location for the shift level
+ *
+ * Finds a keycode and shift level producing @keyval in @layout. The
+ * reverse index used for this is built the first time a layout is looked
+ * up, and dropped when the keyboard map changes.
+ *
+ * Returns: %TRUE if a keycode was found
+ */
+gboolean
+meta_keymap_native_lookup_keyval (MetaKeymapNative   *keymap,
+                                  xkb_layout_index_t  layout,
+                                  uint32_t            keyval,
+                                  uint32_t           *keycode_out,
+                                  uint32_t           *level_out)
+{
+  GHashTable *keycode_index;
+  gpointer packed;
+
+  if (layout >= xkb_keymap_num_layouts (keymap->keymap))
+    return FALSE;
+
+  if (!keymap->keycode_indices)
+    {
+      keymap->keycode_indices =
+        g_ptr_array_new_with_free_func ((GDestroyNotify) g_hash_table_unref);
+    }
+
+  if (keymap->keycode_indices->len <= layout)
+    g_ptr_array_set_size (keymap->keycode_indices, layout + 1);
+
+  keycode_index = g_ptr_array_index (keymap->keycode_indices, layout);
+  if (!keycode_index)
+    {
+      keycode_index = build_keycode_index (keymap->keymap, layout);
+      g_ptr_array_index (keymap->keycode_indices, layout) = keycode_index;
+    }
+
+  if (!g_hash_table_lookup_extended (keycode_index,
+                                     GUINT_TO_POINTER (keyval),
+                                     NULL, &packed))
+    return FALSE;
+
+  *keycode_out = UNPACK_KEYCODE (packed);
+  if (level_out)
+    *level_out = UNPACK_LEVEL (packed);
+
+  return TRUE;
+}
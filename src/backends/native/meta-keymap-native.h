@@ -21,12 +21,22 @@
 
 #include "backends/native/meta-xkb-utils.h"
 #include "clutter/clutter.h"
+#include "core/util-private.h"
 
 #define META_TYPE_KEYMAP_NATIVE (meta_keymap_native_get_type ())
+META_EXPORT_TEST
 G_DECLARE_FINAL_TYPE (MetaKeymapNative, meta_keymap_native,
                       META, KEYMAP_NATIVE,
                       ClutterKeymap)
 
+META_EXPORT_TEST
 void                meta_keymap_native_set_keyboard_map (MetaKeymapNative  *keymap,
                                                          struct xkb_keymap *xkb_keymap);
 struct xkb_keymap * meta_keymap_native_get_keyboard_map (MetaKeymapNative *keymap);
+
+META_EXPORT_TEST
+gboolean            meta_keymap_native_lookup_keyval    (MetaKeymapNative   *keymap,
+                                                         xkb_layout_index_t  layout,
+                                                         uint32_t            keyval,
+                                                         uint32_t           *keycode_out,
+                                                         uint32_t           *level_out);
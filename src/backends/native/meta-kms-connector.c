@@ -245,6 +245,7 @@ state_set_edid (MetaKmsConnectorState *state,
 {
   int fd;
   drmModePropertyBlobPtr edid_blob;
+  GBytes *old_edid_data = NULL;
   GBytes *edid_data;
 
   fd = meta_kms_impl_device_get_fd (impl_device);
@@ -256,10 +257,21 @@ state_set_edid (MetaKmsConnectorState *state,
       return;
     }
 
-   edid_data = g_bytes_new (edid_blob->data, edid_blob->length);
-   drmModeFreePropertyBlob (edid_blob);
+  if (connector->current_state)
+    old_edid_data = connector->current_state->edid_data;
 
-   state->edid_data = edid_data;
+  /* The kernel hands out a new blob on every probe, even when the monitor
+   * didn't change; keep sharing the old data so it can be compared cheaply */
+  if (old_edid_data &&
+      g_bytes_get_size (old_edid_data) == edid_blob->length &&
+      memcmp (g_bytes_get_data (old_edid_data, NULL),
+              edid_blob->data, edid_blob->length) == 0)
+    edid_data = g_bytes_ref (old_edid_data);
+  else
+    edid_data = g_bytes_new (edid_blob->data, edid_blob->length);
+  drmModeFreePropertyBlob (edid_blob);
+
+  state->edid_data = edid_data;
 }
 
 static void
@@ -456,10 +468,12 @@ meta_kms_connector_read_state (MetaKmsConnector  *connector,
 {
   MetaKmsConnectorState *state;
 
-  g_clear_pointer (&connector->current_state, meta_kms_connector_state_free);
-
   if (!drm_connector || drm_connector->connection != DRM_MODE_CONNECTED)
-    return;
+    {
+      g_clear_pointer (&connector->current_state,
+                       meta_kms_connector_state_free);
+      return;
+    }
 
   state = meta_kms_connector_state_new ();
 
@@ -476,24 +490,21 @@ meta_kms_connector_read_state (MetaKmsConnector  *connector,
 
   state_set_crtc_state (state, drm_connector, impl_device, drm_resources);
 
+  g_clear_pointer (&connector->current_state, meta_kms_connector_state_free);
   connector->current_state = state;
 }
 
 void
 meta_kms_connector_update_state (MetaKmsConnector *connector,
+                                 drmModeConnector *drm_connector,
                                  drmModeRes       *drm_resources)
 {
   MetaKmsImplDevice *impl_device;
-  drmModeConnector *drm_connector;
 
   impl_device = meta_kms_device_get_impl_device (connector->device);
-  drm_connector = drmModeGetConnector (meta_kms_impl_device_get_fd (impl_device),
-                                       connector->id);
   meta_kms_connector_read_state (connector, impl_device,
                                  drm_connector,
                                  drm_resources);
-  if (drm_connector)
-    drmModeFreeConnector (drm_connector);
 }
 
 void
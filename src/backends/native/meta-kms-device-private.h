@@ -24,7 +24,8 @@
 
 MetaKmsImplDevice * meta_kms_device_get_impl_device (MetaKmsDevice *device);
 
-void meta_kms_device_update_states_in_impl (MetaKmsDevice *device);
+void meta_kms_device_update_states_in_impl (MetaKmsDevice          *device,
+                                            MetaKmsImplDeviceProbe *probe);
 
 void meta_kms_device_predict_states_in_impl (MetaKmsDevice *device,
                                              MetaKmsUpdate *update);
@@ -110,14 +110,15 @@ meta_kms_device_get_primary_plane_for (MetaKmsDevice *device,
 }
 
 void
-meta_kms_device_update_states_in_impl (MetaKmsDevice *device)
+meta_kms_device_update_states_in_impl (MetaKmsDevice          *device,
+                                       MetaKmsImplDeviceProbe *probe)
 {
   MetaKmsImplDevice *impl_device = meta_kms_device_get_impl_device (device);
 
   meta_assert_in_kms_impl (device->kms);
   meta_assert_is_waiting_for_kms_impl_task (device->kms);
 
-  meta_kms_impl_device_update_states (impl_device);
+  meta_kms_impl_device_update_states (impl_device, probe);
 
   g_list_free (device->crtcs);
   device->crtcs = meta_kms_impl_device_copy_crtcs (impl_device);
@@ -49,6 +49,12 @@ struct _MetaKmsImplDevice
   GList *planes;
 };
 
+struct _MetaKmsImplDeviceProbe
+{
+  drmModeRes *drm_resources;
+  drmModeConnector **drm_connectors;
+};
+
 G_DEFINE_TYPE (MetaKmsImplDevice, meta_kms_impl_device, G_TYPE_OBJECT)
 
 MetaKmsDevice *
@@ -214,29 +220,33 @@ find_existing_connector (MetaKmsImplDevice *impl_device,
 }
 
 static void
-update_connectors (MetaKmsImplDevice *impl_device,
-                   drmModeRes        *drm_resources)
+update_connectors (MetaKmsImplDevice      *impl_device,
+                   MetaKmsImplDeviceProbe *probe)
 {
+  drmModeRes *drm_resources = probe->drm_resources;
   GList *connectors = NULL;
   unsigned int i;
 
   for (i = 0; i < drm_resources->count_connectors; i++)
     {
-      drmModeConnector *drm_connector;
+      drmModeConnector *drm_connector = probe->drm_connectors[i];
       MetaKmsConnector *connector;
 
-      drm_connector = drmModeGetConnector (impl_device->fd,
-                                           drm_resources->connectors[i]);
       if (!drm_connector)
         continue;
 
       connector = find_existing_connector (impl_device, drm_connector);
       if (connector)
-        connector = g_object_ref (connector);
+        {
+          connector = g_object_ref (connector);
+          meta_kms_connector_update_state (connector, drm_connector,
+                                           drm_resources);
+        }
       else
-        connector = meta_kms_connector_new (impl_device, drm_connector,
-                                            drm_resources);
-      drmModeFreeConnector (drm_connector);
+        {
+          connector = meta_kms_connector_new (impl_device, drm_connector,
+                                              drm_resources);
+        }
 
       connectors = g_list_prepend (connectors, connector);
     }
@@ -318,22 +328,68 @@ init_planes (MetaKmsImplDevice *impl_device)
   impl_device->planes = g_list_reverse (impl_device->planes);
 }
 
+/*
+ * Probing a connector may involve reading the EDID over a slow DDC bus,
+ * so this only issues the ioctls, and is safe to call from any thread.
+ * The kernel serializes probes on the same device, but different devices
+ * can be probed concurrently.
+ */
+MetaKmsImplDeviceProbe *
+meta_kms_impl_device_probe (MetaKmsImplDevice *impl_device)
+{
+  MetaKmsImplDeviceProbe *probe;
+  int i;
+
+  probe = g_new0 (MetaKmsImplDeviceProbe, 1);
+  probe->drm_resources = drmModeGetResources (impl_device->fd);
+  if (!probe->drm_resources)
+    return probe;
+
+  probe->drm_connectors = g_new0 (drmModeConnector *,
+                                  probe->drm_resources->count_connectors);
+  for (i = 0; i < probe->drm_resources->count_connectors; i++)
+    {
+      probe->drm_connectors[i] =
+        drmModeGetConnector (impl_device->fd,
+                             probe->drm_resources->connectors[i]);
+    }
+
+  return probe;
+}
+
 void
-meta_kms_impl_device_update_states (MetaKmsImplDevice *impl_device)
+meta_kms_impl_device_probe_free (MetaKmsImplDeviceProbe *probe)
 {
-  drmModeRes *drm_resources;
+  int i;
 
-  meta_assert_in_kms_impl (meta_kms_impl_get_kms (impl_device->impl));
+  if (probe->drm_resources)
+    {
+      for (i = 0; i < probe->drm_resources->count_connectors; i++)
+        g_clear_pointer (&probe->drm_connectors[i], drmModeFreeConnector);
+      drmModeFreeResources (probe->drm_resources);
+    }
+
+  g_free (probe->drm_connectors);
+  g_free (probe);
+}
 
-  drm_resources = drmModeGetResources (impl_device->fd);
+void
+meta_kms_impl_device_update_states (MetaKmsImplDevice      *impl_device,
+                                    MetaKmsImplDeviceProbe *probe)
+{
+  meta_assert_in_kms_impl (meta_kms_impl_get_kms (impl_device->impl));
 
-  update_connectors (impl_device, drm_resources);
+  if (!probe->drm_resources)
+    {
+      g_warning ("Failed to probe KMS resources");
+      return;
+    }
 
   g_list_foreach (impl_device->crtcs, (GFunc) meta_kms_crtc_update_state,
                   NULL);
-  g_list_foreach (impl_device->connectors, (GFunc) meta_kms_connector_update_state,
-                  drm_resources);
-  drmModeFreeResources (drm_resources);
+
+  /* Each connector is probed only once, existing ones are updated in place */
+  update_connectors (impl_device, probe);
 }
 
 void
@@ -354,8 +410,8 @@ meta_kms_impl_device_new (MetaKmsDevice  *device,
 {
   MetaKms *kms = meta_kms_impl_get_kms (impl);
   MetaKmsImplDevice *impl_device;
+  MetaKmsImplDeviceProbe *probe;
   int ret;
-  drmModeRes *drm_resources;
 
   meta_assert_in_kms_impl (kms);
 
@@ -368,26 +424,28 @@ meta_kms_impl_device_new (MetaKmsDevice  *device,
       return NULL;
     }
 
-  drm_resources = drmModeGetResources (fd);
-  if (!drm_resources)
+  impl_device = g_object_new (META_TYPE_KMS_IMPL_DEVICE, NULL);
+  impl_device->device = device;
+  impl_device->impl = impl;
+  impl_device->fd = fd;
+
+  probe = meta_kms_impl_device_probe (impl_device);
+  if (!probe->drm_resources)
     {
       g_set_error (error, G_IO_ERROR, g_io_error_from_errno (errno),
                    "Failed to activate universal planes: %s",
                    g_strerror (errno));
+      meta_kms_impl_device_probe_free (probe);
+      g_object_unref (impl_device);
       return NULL;
     }
 
-  impl_device = g_object_new (META_TYPE_KMS_IMPL_DEVICE, NULL);
-  impl_device->device = device;
-  impl_device->impl = impl;
-  impl_device->fd = fd;
-
-  init_crtcs (impl_device, drm_resources);
+  init_crtcs (impl_device, probe->drm_resources);
   init_planes (impl_device);
 
-  update_connectors (impl_device, drm_resources);
+  update_connectors (impl_device, probe);
 
-  drmModeFreeResources (drm_resources);
+  meta_kms_impl_device_probe_free (probe);
 
   impl_device->fd_source =
     meta_kms_register_fd_in_impl (kms, fd,
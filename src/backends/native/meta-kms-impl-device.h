@@ -53,7 +53,12 @@ int meta_kms_impl_device_get_fd (MetaKmsImplDevice *impl_device);
 
 int meta_kms_impl_device_leak_fd (MetaKmsImplDevice *impl_device);
 
-void meta_kms_impl_device_update_states (MetaKmsImplDevice *impl_device);
+MetaKmsImplDeviceProbe * meta_kms_impl_device_probe (MetaKmsImplDevice *impl_device);
+
+void meta_kms_impl_device_probe_free (MetaKmsImplDeviceProbe *probe);
+
+void meta_kms_impl_device_update_states (MetaKmsImplDevice      *impl_device,
+                                         MetaKmsImplDeviceProbe *probe);
 
 void meta_kms_impl_device_predict_states (MetaKmsImplDevice *impl_device,
                                           MetaKmsUpdate     *update);
@@ -177,6 +177,105 @@ fill_connector_ids_array (GList     *connectors,
     }
 }
 
+static gboolean
+connector_lists_equal (GList *connectors,
+                       GList *other_connectors)
+{
+  GList *l;
+
+  if (g_list_length (connectors) != g_list_length (other_connectors))
+    return FALSE;
+
+  for (l = connectors; l; l = l->next)
+    {
+      if (!g_list_find (other_connectors, l->data))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+static MetaKmsPageFlip *
+find_page_flip (MetaKmsUpdate *update,
+                MetaKmsCrtc   *crtc)
+{
+  GList *l;
+
+  for (l = meta_kms_update_get_page_flips (update); l; l = l->next)
+    {
+      MetaKmsPageFlip *page_flip = l->data;
+
+      if (page_flip->crtc == crtc)
+        return page_flip;
+    }
+
+  return NULL;
+}
+
+/*
+ * Reconfiguring monitors results in a mode set for every CRTC, even when
+ * only e.g. the scale or the logical layout changed. Setting the same
+ * mode, connectors and scanout offset again would only blank the CRTC;
+ * in that case the new buffer is presented by the page flip of the same
+ * update instead, which falls back to a mode set itself if the buffer
+ * turns out to be incompatible.
+ */
+static gboolean
+is_mode_set_redundant (MetaKmsImplSimple *impl_simple,
+                       MetaKmsUpdate     *update,
+                       MetaKmsModeSet    *mode_set,
+                       uint32_t           x,
+                       uint32_t           y)
+{
+  MetaKmsCrtc *crtc = mode_set->crtc;
+  MetaKmsDevice *device = meta_kms_crtc_get_device (crtc);
+  MetaKmsImplDevice *impl_device = meta_kms_device_get_impl_device (device);
+  CachedModeSet *cached_mode_set;
+  MetaKmsPageFlip *page_flip;
+  drmModeCrtc *drm_crtc;
+  gboolean is_redundant;
+
+  cached_mode_set = g_hash_table_lookup (impl_simple->cached_mode_sets, crtc);
+
+  if (mode_set->drm_mode)
+    {
+      if (!cached_mode_set ||
+          !connector_lists_equal (cached_mode_set->connectors,
+                                  mode_set->connectors))
+        return FALSE;
+
+      page_flip = find_page_flip (update, crtc);
+      if (!page_flip || page_flip->custom_page_flip_func)
+        return FALSE;
+    }
+
+  /* Someone else might have changed the CRTC, e.g. while VT switched */
+  drm_crtc = drmModeGetCrtc (meta_kms_impl_device_get_fd (impl_device),
+                             meta_kms_crtc_get_id (crtc));
+  if (!drm_crtc)
+    return FALSE;
+
+  if (mode_set->drm_mode)
+    {
+      is_redundant = (drm_crtc->mode_valid &&
+                      drm_crtc->buffer_id != 0 &&
+                      drm_crtc->x == x &&
+                      drm_crtc->y == y &&
+                      meta_drm_mode_equal (&drm_crtc->mode,
+                                           mode_set->drm_mode));
+    }
+  else
+    {
+      is_redundant = (!cached_mode_set &&
+                      !drm_crtc->mode_valid &&
+                      drm_crtc->buffer_id == 0);
+    }
+
+  drmModeFreeCrtc (drm_crtc);
+
+  return is_redundant;
+}
+
 static gboolean
 process_mode_set (MetaKmsImpl     *impl,
                   MetaKmsUpdate   *update,
@@ -237,20 +336,28 @@ process_mode_set (MetaKmsImpl     *impl,
       fb_id = 0;
     }
 
-  fd = meta_kms_impl_device_get_fd (impl_device);
-  ret = drmModeSetCrtc (fd,
-                        meta_kms_crtc_get_id (crtc),
-                        fb_id,
-                        x, y,
-                        connectors, n_connectors,
-                        mode_set->drm_mode);
-  if (ret != 0)
+  if (is_mode_set_redundant (impl_simple, update, mode_set, x, y))
     {
-      g_set_error (error, G_IO_ERROR, g_io_error_from_errno (-ret),
-                   "Failed to set mode on CRTC %u: %s",
-                   meta_kms_crtc_get_id (crtc),
-                   g_strerror (-ret));
-      return FALSE;
+      g_debug ("Skipping redundant mode set on CRTC %u",
+               meta_kms_crtc_get_id (crtc));
+    }
+  else
+    {
+      fd = meta_kms_impl_device_get_fd (impl_device);
+      ret = drmModeSetCrtc (fd,
+                            meta_kms_crtc_get_id (crtc),
+                            fb_id,
+                            x, y,
+                            connectors, n_connectors,
+                            mode_set->drm_mode);
+      if (ret != 0)
+        {
+          g_set_error (error, G_IO_ERROR, g_io_error_from_errno (-ret),
+                       "Failed to set mode on CRTC %u: %s",
+                       meta_kms_crtc_get_id (crtc),
+                       g_strerror (-ret));
+          return FALSE;
+        }
     }
 
   if (mode_set->drm_mode)
@@ -37,6 +37,7 @@ typedef struct _MetaKmsPageFlipFeedback MetaKmsPageFlipFeedback;
 
 typedef struct _MetaKmsImpl MetaKmsImpl;
 typedef struct _MetaKmsImplDevice MetaKmsImplDevice;
+typedef struct _MetaKmsImplDeviceProbe MetaKmsImplDeviceProbe;
 
 /* 16:16 fixed point */
 typedef int32_t MetaFixed16;
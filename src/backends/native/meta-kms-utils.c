@@ -24,6 +24,7 @@
 
 #include <drm_fourcc.h>
 #include <glib.h>
+#include <string.h>
 
 /* added in libdrm 2.4.95 */
 #ifndef DRM_FORMAT_INVALID
@@ -48,6 +49,27 @@ meta_calculate_drm_mode_refresh_rate (const drmModeModeInfo *drm_mode)
   return refresh;
 }
 
+gboolean
+meta_drm_mode_equal (const drmModeModeInfo *one,
+                     const drmModeModeInfo *two)
+{
+  return (one->clock == two->clock &&
+          one->hdisplay == two->hdisplay &&
+          one->hsync_start == two->hsync_start &&
+          one->hsync_end == two->hsync_end &&
+          one->htotal == two->htotal &&
+          one->hskew == two->hskew &&
+          one->vdisplay == two->vdisplay &&
+          one->vsync_start == two->vsync_start &&
+          one->vsync_end == two->vsync_end &&
+          one->vtotal == two->vtotal &&
+          one->vscan == two->vscan &&
+          one->vrefresh == two->vrefresh &&
+          one->flags == two->flags &&
+          one->type == two->type &&
+          strncmp (one->name, two->name, DRM_DISPLAY_MODE_LEN) == 0);
+}
+
 /**
  * meta_drm_format_to_string:
  * @tmp: temporary buffer
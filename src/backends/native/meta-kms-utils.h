@@ -20,6 +20,7 @@
 #ifndef META_KMS_UTILS_H
 #define META_KMS_UTILS_H
 
+#include <glib.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <xf86drmMode.h>
@@ -31,6 +32,9 @@ typedef struct _MetaDrmFormatBuf
 
 float meta_calculate_drm_mode_refresh_rate (const drmModeModeInfo *drm_mode);
 
+gboolean meta_drm_mode_equal (const drmModeModeInfo *one,
+                              const drmModeModeInfo *two);
+
 const char * meta_drm_format_to_string (MetaDrmFormatBuf *tmp,
                                         uint32_t          drm_format);
 
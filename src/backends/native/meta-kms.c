@@ -23,6 +23,7 @@
 
 #include "backends/native/meta-backend-native.h"
 #include "backends/native/meta-kms-device-private.h"
+#include "backends/native/meta-kms-impl-device.h"
 #include "backends/native/meta-kms-impl.h"
 #include "backends/native/meta-kms-impl-simple.h"
 #include "backends/native/meta-kms-update-private.h"
@@ -465,17 +466,64 @@ meta_kms_is_waiting_for_impl_task (MetaKms *kms)
   return kms->waiting_for_impl_task;
 }
 
+static gpointer
+probe_device_thread_func (gpointer user_data)
+{
+  MetaKmsImplDevice *impl_device = user_data;
+
+  return meta_kms_impl_device_probe (impl_device);
+}
+
 static void
 meta_kms_update_states_in_impl (MetaKms *kms)
 {
+  g_autofree GThread **probe_threads = NULL;
+  g_autofree MetaKmsImplDeviceProbe **probes = NULL;
+  unsigned int n_devices;
+  unsigned int i;
+  GList *l;
+
   COGL_TRACE_BEGIN_SCOPED (MetaKmsUpdateStates,
                            "KMS (update states)");
 
   meta_assert_in_kms_impl (kms);
 
-  g_list_foreach (kms->devices,
-                  (GFunc) meta_kms_device_update_states_in_impl,
-                  NULL);
+  n_devices = g_list_length (kms->devices);
+  if (n_devices == 0)
+    return;
+
+  probe_threads = g_new0 (GThread *, n_devices);
+  probes = g_new0 (MetaKmsImplDeviceProbe *, n_devices);
+
+  /*
+   * Probing connectors is what makes hotplugging slow, as it may read EDIDs
+   * from every connected monitor. Only connectors on the same device are
+   * serialized by the kernel, so probe the secondary devices in parallel
+   * while probing the first one here.
+   */
+  for (l = kms->devices->next, i = 1; l; l = l->next, i++)
+    {
+      MetaKmsDevice *device = l->data;
+
+      probe_threads[i] =
+        g_thread_new ("KMS probe",
+                      probe_device_thread_func,
+                      meta_kms_device_get_impl_device (device));
+    }
+
+  probes[0] =
+    meta_kms_impl_device_probe (meta_kms_device_get_impl_device (kms->devices->data));
+
+  for (i = 1; i < n_devices; i++)
+    probes[i] = g_thread_join (probe_threads[i]);
+
+  for (l = kms->devices, i = 0; l; l = l->next, i++)
+    {
+      MetaKmsDevice *device = l->data;
+
+      meta_kms_device_update_states_in_impl (device, probes[i]);
+      meta_kms_impl_device_probe_free (probes[i]);
+    }
 }
 
 static gboolean
@@ -283,41 +283,17 @@ pick_keycode_for_keyval_in_current_group (ClutterVirtualInputDevice *virtual_dev
   MetaVirtualInputDeviceNative *virtual_evdev =
     META_VIRTUAL_INPUT_DEVICE_NATIVE (virtual_device);
   ClutterKeymap *keymap;
-  struct xkb_keymap *xkb_keymap;
   struct xkb_state  *state;
-  guint keycode, layout;
-  xkb_keycode_t min_keycode, max_keycode;
+  guint layout;
 
   keymap = clutter_backend_get_keymap (clutter_get_default_backend ());
-  xkb_keymap = meta_keymap_native_get_keyboard_map (META_KEYMAP_NATIVE (keymap));
   state = virtual_evdev->seat->xkb;
 
   layout = xkb_state_serialize_layout (state, XKB_STATE_LAYOUT_EFFECTIVE);
-  min_keycode = xkb_keymap_min_keycode (xkb_keymap);
-  max_keycode = xkb_keymap_max_keycode (xkb_keymap);
-  for (keycode = min_keycode; keycode < max_keycode; keycode++)
-    {
-      gint num_levels, level;
-      num_levels = xkb_keymap_num_levels_for_key (xkb_keymap, keycode, layout);
-      for (level = 0; level < num_levels; level++)
-        {
-          const xkb_keysym_t *syms;
-          gint num_syms, sym;
-          num_syms = xkb_keymap_key_get_syms_by_level (xkb_keymap, keycode, layout, level, &syms);
-          for (sym = 0; sym < num_syms; sym++)
-            {
-              if (syms[sym] == keyval)
-                {
-                  *keycode_out = keycode;
-                  if (level_out)
-                    *level_out = level;
-                  return TRUE;
-                }
-            }
-        }
-    }
 
-  return FALSE;
+  return meta_keymap_native_lookup_keyval (META_KEYMAP_NATIVE (keymap),
+                                           layout, keyval,
+                                           keycode_out, level_out);
 }
 
 static void
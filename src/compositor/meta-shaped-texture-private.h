@@ -30,6 +30,8 @@
 #include "backends/meta-monitor-manager-private.h"
 #include "meta/meta-shaped-texture.h"
 
+void meta_shaped_texture_init_pipelines (CoglContext *ctx);
+
 MetaShapedTexture *meta_shaped_texture_new (void);
 void meta_shaped_texture_set_texture (MetaShapedTexture *stex,
                                       CoglTexture       *texture);
@@ -37,6 +39,12 @@ void meta_shaped_texture_set_is_y_inverted (MetaShapedTexture *stex,
                                             gboolean           is_y_inverted);
 void meta_shaped_texture_set_snippet (MetaShapedTexture *stex,
                                       CoglSnippet       *snippet);
+void meta_shaped_texture_set_nine_slice_mask_texture (MetaShapedTexture *stex,
+                                                      CoglTexture       *mask_texture,
+                                                      int                left,
+                                                      int                top,
+                                                      int                right,
+                                                      int                bottom);
 void meta_shaped_texture_set_fallback_size (MetaShapedTexture *stex,
                                             int                fallback_width,
                                             int                fallback_height);
@@ -33,6 +33,7 @@
 
 #include <gdk/gdk.h>
 #include <math.h>
+#include <string.h>
 
 #include "cogl/cogl.h"
 #include "compositor/clutter-utils.h"
@@ -56,6 +57,18 @@
  */
 #define MIN_FAST_UPDATES_BEFORE_UNMIPMAP 20
 
+/* The features that change the generated shader programs. Everything
+ * else that varies per window, i.e. y-inversion, buffer transforms and
+ * viewports, only changes the layer matrices, which are uniforms.
+ */
+typedef enum
+{
+  PIPELINE_MASKED = 1 << 0,
+  PIPELINE_UNBLENDED = 1 << 1,
+} PipelineFlags;
+
+#define N_PIPELINES (1 << 2)
+
 static void meta_shaped_texture_dispose  (GObject    *object);
 
 static void clutter_content_iface_init (ClutterContentInterface *iface);
@@ -79,9 +92,15 @@ struct _MetaShapedTexture
   CoglTexture *mask_texture;
   CoglSnippet *snippet;
 
-  CoglPipeline *base_pipeline;
-  CoglPipeline *masked_pipeline;
-  CoglPipeline *unblended_pipeline;
+  /* If set, mask_texture only contains the borders of the mask, see
+   * meta_shaped_texture_set_nine_slice_mask_texture() */
+  gboolean has_mask_slices;
+  int mask_slice_left;
+  int mask_slice_top;
+  int mask_slice_right;
+  int mask_slice_bottom;
+
+  CoglPipeline *pipelines[N_PIPELINES];
 
   gboolean is_y_inverted;
 
@@ -218,9 +237,10 @@ ensure_size_valid (MetaShapedTexture *stex)
 static void
 meta_shaped_texture_reset_pipelines (MetaShapedTexture *stex)
 {
-  g_clear_pointer (&stex->base_pipeline, cogl_object_unref);
-  g_clear_pointer (&stex->masked_pipeline, cogl_object_unref);
-  g_clear_pointer (&stex->unblended_pipeline, cogl_object_unref);
+  int i;
+
+  for (i = 0; i < N_PIPELINES; i++)
+    g_clear_pointer (&stex->pipelines[i], cogl_object_unref);
 }
 
 static void
@@ -245,39 +265,121 @@ meta_shaped_texture_dispose (GObject *object)
 }
 
 static CoglPipeline *
-get_base_pipeline (MetaShapedTexture *stex,
-                   CoglContext       *ctx)
+get_pipeline_template (CoglContext   *ctx,
+                       PipelineFlags  pipeline_flags)
 {
-  CoglPipeline *pipeline;
-  CoglMatrix matrix;
+  static CoglPipeline *templates[N_PIPELINES];
+  CoglPipeline **templatep;
+
+  templatep = &templates[pipeline_flags];
+  if (*templatep == NULL)
+    {
+      CoglPipeline *pipeline;
+
+      /* Window pipelines are copies of these, so they share the programs
+       * Cogl generates for them instead of each looking up its own.
+       */
+      pipeline = cogl_pipeline_new (ctx);
+      cogl_pipeline_set_layer_wrap_mode_s (pipeline, 0,
+                                           COGL_PIPELINE_WRAP_MODE_CLAMP_TO_EDGE);
+      cogl_pipeline_set_layer_wrap_mode_t (pipeline, 0,
+                                           COGL_PIPELINE_WRAP_MODE_CLAMP_TO_EDGE);
+      cogl_pipeline_set_layer_wrap_mode_s (pipeline, 1,
+                                           COGL_PIPELINE_WRAP_MODE_CLAMP_TO_EDGE);
+      cogl_pipeline_set_layer_wrap_mode_t (pipeline, 1,
+                                           COGL_PIPELINE_WRAP_MODE_CLAMP_TO_EDGE);
+
+      if ((pipeline_flags & PIPELINE_MASKED) != 0)
+        {
+          cogl_pipeline_set_layer_combine (pipeline, 1,
+                                           "RGBA = MODULATE (PREVIOUS, TEXTURE[A])",
+                                           NULL);
+        }
+
+      if ((pipeline_flags & PIPELINE_UNBLENDED) != 0)
+        {
+          CoglColor color;
+
+          cogl_color_init_from_4ub (&color, 255, 255, 255, 255);
+          cogl_pipeline_set_blend (pipeline,
+                                   "RGBA = ADD (SRC_COLOR, 0)",
+                                   NULL);
+          cogl_pipeline_set_color (pipeline, &color);
+        }
+
+      *templatep = pipeline;
+    }
+
+  return *templatep;
+}
+
+/**
+ * meta_shaped_texture_init_pipelines:
+ * @ctx: a #CoglContext
+ *
+ * Creates the pipelines all shaped textures are derived from, and draws
+ * with each of them once, so that their programs are compiled before the
+ * first window is painted.
+ */
+void
+meta_shaped_texture_init_pipelines (CoglContext *ctx)
+{
+  CoglTexture *texture;
+  CoglOffscreen *offscreen;
+  CoglFramebuffer *framebuffer;
+  GError *error = NULL;
+  int i;
+
+  texture = COGL_TEXTURE (cogl_texture_2d_new_with_size (ctx, 1, 1));
+  offscreen = cogl_offscreen_new_with_texture (texture);
+  framebuffer = COGL_FRAMEBUFFER (offscreen);
+
+  if (!cogl_framebuffer_allocate (framebuffer, &error))
+    {
+      g_warning ("Failed to compile shaped texture pipelines: %s",
+                 error->message);
+      g_error_free (error);
+      goto out;
+    }
 
-  if (stex->base_pipeline)
-    return stex->base_pipeline;
+  for (i = 0; i < N_PIPELINES; i++)
+    {
+      CoglPipeline *pipeline;
 
-  pipeline = cogl_pipeline_new (ctx);
-  cogl_pipeline_set_layer_wrap_mode_s (pipeline, 0,
-                                       COGL_PIPELINE_WRAP_MODE_CLAMP_TO_EDGE);
-  cogl_pipeline_set_layer_wrap_mode_t (pipeline, 0,
-                                       COGL_PIPELINE_WRAP_MODE_CLAMP_TO_EDGE);
-  cogl_pipeline_set_layer_wrap_mode_s (pipeline, 1,
-                                       COGL_PIPELINE_WRAP_MODE_CLAMP_TO_EDGE);
-  cogl_pipeline_set_layer_wrap_mode_t (pipeline, 1,
-                                       COGL_PIPELINE_WRAP_MODE_CLAMP_TO_EDGE);
+      /* A texture can't be sampled while it's being rendered to */
+      pipeline = cogl_pipeline_copy (get_pipeline_template (ctx, i));
+      cogl_pipeline_set_layer_texture (pipeline, 0, NULL);
+      if ((i & PIPELINE_MASKED) != 0)
+        cogl_pipeline_set_layer_texture (pipeline, 1, NULL);
 
-  cogl_matrix_init_identity (&matrix);
+      cogl_framebuffer_draw_rectangle (framebuffer, pipeline, -1, -1, 1, 1);
+      cogl_object_unref (pipeline);
+    }
+
+  cogl_framebuffer_finish (framebuffer);
+
+out:
+  cogl_object_unref (offscreen);
+  cogl_object_unref (texture);
+}
+
+static void
+get_texture_matrix (MetaShapedTexture *stex,
+                    CoglMatrix        *matrix)
+{
+  cogl_matrix_init_identity (matrix);
 
   if (!stex->is_y_inverted)
     {
-      cogl_matrix_scale (&matrix, 1, -1, 1);
-      cogl_matrix_translate (&matrix, 0, -1, 0);
-      cogl_pipeline_set_layer_matrix (pipeline, 0, &matrix);
+      cogl_matrix_scale (matrix, 1, -1, 1);
+      cogl_matrix_translate (matrix, 0, -1, 0);
     }
 
   if (stex->transform != META_MONITOR_TRANSFORM_NORMAL)
     {
       graphene_euler_t euler;
 
-      cogl_matrix_translate (&matrix, 0.5, 0.5, 0.0);
+      cogl_matrix_translate (matrix, 0.5, 0.5, 0.0);
       switch (stex->transform)
         {
         case META_MONITOR_TRANSFORM_90:
@@ -311,8 +413,8 @@ get_base_pipeline (MetaShapedTexture *stex,
         case META_MONITOR_TRANSFORM_NORMAL:
           g_assert_not_reached ();
         }
-      cogl_matrix_rotate_euler (&matrix, &euler);
-      cogl_matrix_translate (&matrix, -0.5, -0.5, 0.0);
+      cogl_matrix_rotate_euler (matrix, &euler);
+      cogl_matrix_translate (matrix, -0.5, -0.5, 0.0);
     }
 
   if (stex->has_viewport_src_rect)
@@ -322,7 +424,7 @@ get_base_pipeline (MetaShapedTexture *stex,
 
       if (meta_monitor_transform_is_rotated (stex->transform))
         {
-          cogl_matrix_scale (&matrix,
+          cogl_matrix_scale (matrix,
                              stex->viewport_src_rect.size.width /
                              scaled_tex_height,
                              stex->viewport_src_rect.size.height /
@@ -331,7 +433,7 @@ get_base_pipeline (MetaShapedTexture *stex,
         }
       else
         {
-          cogl_matrix_scale (&matrix,
+          cogl_matrix_scale (matrix,
                              stex->viewport_src_rect.size.width /
                              scaled_tex_width,
                              stex->viewport_src_rect.size.height /
@@ -339,79 +441,72 @@ get_base_pipeline (MetaShapedTexture *stex,
                              1);
         }
 
-      cogl_matrix_translate (&matrix,
+      cogl_matrix_translate (matrix,
                              stex->viewport_src_rect.origin.x /
                              stex->viewport_src_rect.size.width,
                              stex->viewport_src_rect.origin.y /
                              stex->viewport_src_rect.size.height,
                              0);
     }
+}
+
+static CoglPipeline *
+get_pipeline (MetaShapedTexture *stex,
+              CoglContext       *ctx,
+              PipelineFlags      pipeline_flags)
+{
+  CoglPipeline *pipeline;
+  CoglMatrix matrix;
 
+  if (stex->pipelines[pipeline_flags])
+    return stex->pipelines[pipeline_flags];
+
+  pipeline = cogl_pipeline_copy (get_pipeline_template (ctx, pipeline_flags));
+
+  get_texture_matrix (stex, &matrix);
   cogl_pipeline_set_layer_matrix (pipeline, 0, &matrix);
+
+  /* Nine-slice mask coordinates are computed per rectangle */
+  if (stex->has_mask_slices)
+    cogl_matrix_init_identity (&matrix);
   cogl_pipeline_set_layer_matrix (pipeline, 1, &matrix);
 
   if (stex->snippet)
     cogl_pipeline_add_layer_snippet (pipeline, 0, stex->snippet);
 
-  stex->base_pipeline = pipeline;
+  stex->pipelines[pipeline_flags] = pipeline;
 
-  return stex->base_pipeline;
+  return pipeline;
 }
 
 static CoglPipeline *
 get_unmasked_pipeline (MetaShapedTexture *stex,
                        CoglContext       *ctx)
 {
-  return get_base_pipeline (stex, ctx);
+  return get_pipeline (stex, ctx, 0);
 }
 
 static CoglPipeline *
 get_masked_pipeline (MetaShapedTexture *stex,
                      CoglContext       *ctx)
 {
-  CoglPipeline *pipeline;
-
-  if (stex->masked_pipeline)
-    return stex->masked_pipeline;
-
-  pipeline = cogl_pipeline_copy (get_base_pipeline (stex, ctx));
-  cogl_pipeline_set_layer_combine (pipeline, 1,
-                                   "RGBA = MODULATE (PREVIOUS, TEXTURE[A])",
-                                   NULL);
-
-  stex->masked_pipeline = pipeline;
-
-  return pipeline;
+  return get_pipeline (stex, ctx, PIPELINE_MASKED);
 }
 
 static CoglPipeline *
 get_unblended_pipeline (MetaShapedTexture *stex,
                         CoglContext       *ctx)
 {
-  CoglPipeline *pipeline;
-  CoglColor color;
-
-  if (stex->unblended_pipeline)
-    return stex->unblended_pipeline;
-
-  pipeline = cogl_pipeline_copy (get_base_pipeline (stex, ctx));
-  cogl_color_init_from_4ub (&color, 255, 255, 255, 255);
-  cogl_pipeline_set_blend (pipeline,
-                           "RGBA = ADD (SRC_COLOR, 0)",
-                           NULL);
-  cogl_pipeline_set_color (pipeline, &color);
-
-  stex->unblended_pipeline = pipeline;
-
-  return pipeline;
+  return get_pipeline (stex, ctx, PIPELINE_UNBLENDED);
 }
 
 static void
-paint_clipped_rectangle_node (MetaShapedTexture     *stex,
-                              ClutterPaintNode      *root_node,
-                              CoglPipeline          *pipeline,
-                              cairo_rectangle_int_t *rect,
-                              ClutterActorBox       *alloc)
+paint_rectangle_node (MetaShapedTexture     *stex,
+                      ClutterPaintNode      *root_node,
+                      CoglPipeline          *pipeline,
+                      cairo_rectangle_int_t *rect,
+                      ClutterActorBox       *alloc,
+                      const float           *mask_coords)
 {
   g_autoptr (ClutterPaintNode) node = NULL;
   float ratio_h, ratio_v;
@@ -436,10 +531,17 @@ paint_clipped_rectangle_node (MetaShapedTexture     *stex,
   coords[2] = (rect->x + rect->width) / alloc_width * ratio_h;
   coords[3] = (rect->y + rect->height) / alloc_height * ratio_v;
 
-  coords[4] = coords[0];
-  coords[5] = coords[1];
-  coords[6] = coords[2];
-  coords[7] = coords[3];
+  if (mask_coords)
+    {
+      memcpy (&coords[4], mask_coords, 4 * sizeof (float));
+    }
+  else
+    {
+      coords[4] = coords[0];
+      coords[5] = coords[1];
+      coords[6] = coords[2];
+      coords[7] = coords[3];
+    }
 
   node = clutter_pipeline_node_new (pipeline);
   clutter_paint_node_set_name (node, "MetaShapedTexture (clipped)");
@@ -455,6 +557,101 @@ paint_clipped_rectangle_node (MetaShapedTexture     *stex,
                                                  coords, 8);
 }
 
+static void
+paint_clipped_rectangle_node (MetaShapedTexture     *stex,
+                              ClutterPaintNode      *root_node,
+                              CoglPipeline          *pipeline,
+                              cairo_rectangle_int_t *rect,
+                              ClutterActorBox       *alloc)
+{
+  paint_rectangle_node (stex, root_node, pipeline, rect, alloc, NULL);
+}
+
+/* Maps a position within slice 0 (start), 1 (stretched center) or
+ * 2 (end) of an axis to a normalized coordinate in the mask texture,
+ * which is inset_start + 1 + inset_end texels long on that axis.
+ */
+static float
+get_mask_slice_coord (int pos,
+                      int slice,
+                      int inset_start,
+                      int inset_end,
+                      int size)
+{
+  float mask_size = inset_start + 1 + inset_end;
+
+  switch (slice)
+    {
+    case 0:
+      return pos / mask_size;
+    case 1:
+      return (inset_start + 0.5f) / mask_size;
+    default:
+      return (pos - (size - inset_end) + inset_start + 1) / mask_size;
+    }
+}
+
+static void
+paint_nine_slice_rectangle_node (MetaShapedTexture     *stex,
+                                 ClutterPaintNode      *root_node,
+                                 CoglPipeline          *pipeline,
+                                 cairo_rectangle_int_t *rect,
+                                 ClutterActorBox       *alloc)
+{
+  int xs[4] = {
+    0,
+    stex->mask_slice_left,
+    stex->dst_width - stex->mask_slice_right,
+    stex->dst_width,
+  };
+  int ys[4] = {
+    0,
+    stex->mask_slice_top,
+    stex->dst_height - stex->mask_slice_bottom,
+    stex->dst_height,
+  };
+  int i, j;
+
+  for (j = 0; j < 3; j++)
+    {
+      for (i = 0; i < 3; i++)
+        {
+          cairo_rectangle_int_t slice_rect = {
+            .x = xs[i],
+            .y = ys[j],
+            .width = xs[i + 1] - xs[i],
+            .height = ys[j + 1] - ys[j],
+          };
+          float mask_coords[4];
+
+          if (!gdk_rectangle_intersect (rect, &slice_rect, &slice_rect))
+            continue;
+
+          mask_coords[0] = get_mask_slice_coord (slice_rect.x, i,
+                                                 stex->mask_slice_left,
+                                                 stex->mask_slice_right,
+                                                 stex->dst_width);
+          mask_coords[1] = get_mask_slice_coord (slice_rect.y, j,
+                                                 stex->mask_slice_top,
+                                                 stex->mask_slice_bottom,
+                                                 stex->dst_height);
+          mask_coords[2] = get_mask_slice_coord (slice_rect.x +
+                                                 slice_rect.width, i,
+                                                 stex->mask_slice_left,
+                                                 stex->mask_slice_right,
+                                                 stex->dst_width);
+          mask_coords[3] = get_mask_slice_coord (slice_rect.y +
+                                                 slice_rect.height, j,
+                                                 stex->mask_slice_top,
+                                                 stex->mask_slice_bottom,
+                                                 stex->dst_height);
+
+          paint_rectangle_node (stex, root_node, pipeline,
+                                &slice_rect, alloc, mask_coords);
+        }
+    }
+}
+
 static void
 set_cogl_texture (MetaShapedTexture *stex,
                   CoglTexture       *cogl_tex)
@@ -658,11 +855,22 @@ do_paint_content (MetaShapedTexture   *stex,
               if (!gdk_rectangle_intersect (&content_rect, &rect, &rect))
                 continue;
 
-              paint_clipped_rectangle_node (stex, root_node,
-                                            blended_pipeline,
-                                            &rect, alloc);
+              if (stex->mask_texture && stex->has_mask_slices)
+                paint_nine_slice_rectangle_node (stex, root_node,
+                                                 blended_pipeline,
+                                                 &rect, alloc);
+              else
+                paint_clipped_rectangle_node (stex, root_node,
+                                              blended_pipeline,
+                                              &rect, alloc);
             }
         }
+      else if (stex->mask_texture && stex->has_mask_slices)
+        {
+          paint_nine_slice_rectangle_node (stex, root_node,
+                                           blended_pipeline,
+                                           &content_rect, alloc);
+        }
       else
         {
           g_autoptr (ClutterPaintNode) node = NULL;
@@ -815,9 +1023,52 @@ meta_shaped_texture_set_mask_texture (MetaShapedTexture *stex,
       cogl_object_ref (stex->mask_texture);
     }
 
+  if (stex->has_mask_slices)
+    {
+      stex->has_mask_slices = FALSE;
+      meta_shaped_texture_reset_pipelines (stex);
+    }
+
   clutter_content_invalidate (CLUTTER_CONTENT (stex));
 }
 
+/**
+ * meta_shaped_texture_set_nine_slice_mask_texture:
+ * @stex: a #MetaShapedTexture
+ * @mask_texture: the corners and edges of the mask
+ * @left: width of the left column of @mask_texture
+ * @top: height of the top row of @mask_texture
+ * @right: width of the right column of @mask_texture
+ * @bottom: height of the bottom row of @mask_texture
+ *
+ * Sets a mask that is sampled as a nine-slice: @mask_texture is
+ * (@left + 1 + @right) x (@top + 1 + @bottom) texels, its borders are
+ * used as-is along the borders of the texture, and its center column and
+ * row are stretched across the rest. This avoids allocating and
+ * uploading a mask the size of the whole texture when only the borders
+ * are shaped, as with window frames.
+ */
+void
+meta_shaped_texture_set_nine_slice_mask_texture (MetaShapedTexture *stex,
+                                                 CoglTexture       *mask_texture,
+                                                 int                left,
+                                                 int                top,
+                                                 int                right,
+                                                 int                bottom)
+{
+  g_return_if_fail (META_IS_SHAPED_TEXTURE (stex));
+  g_return_if_fail (mask_texture != NULL);
+
+  meta_shaped_texture_set_mask_texture (stex, mask_texture);
+
+  stex->has_mask_slices = TRUE;
+  stex->mask_slice_left = left;
+  stex->mask_slice_top = top;
+  stex->mask_slice_right = right;
+  stex->mask_slice_bottom = bottom;
+  meta_shaped_texture_reset_pipelines (stex);
+}
+
 /**
  * meta_shaped_texture_update_area:
  * @stex: #MetaShapedTexture
@@ -1272,6 +1523,69 @@ get_image_via_offscreen (MetaShapedTexture     *stex,
   return surface;
 }
 
+static int
+get_mask_slice_source (int pos,
+                       int inset_start,
+                       int inset_end,
+                       int size)
+{
+  if (pos < inset_start)
+    return pos;
+  else if (pos < size - inset_end)
+    return inset_start;
+  else
+    return pos - (size - inset_end) + inset_start + 1;
+}
+
+static cairo_surface_t *
+create_mask_surface_from_slices (MetaShapedTexture *stex)
+{
+  CoglTexture *mask_texture = stex->mask_texture;
+  int mask_width = cogl_texture_get_width (mask_texture);
+  int mask_height = cogl_texture_get_height (mask_texture);
+  int mask_stride;
+  g_autofree uint8_t *mask_data = NULL;
+  cairo_surface_t *surface;
+  uint8_t *data;
+  int stride;
+  int x, y;
+
+  mask_stride = cairo_format_stride_for_width (CAIRO_FORMAT_A8, mask_width);
+  mask_data = g_malloc (mask_stride * mask_height);
+  cogl_texture_get_data (mask_texture, COGL_PIXEL_FORMAT_A_8,
+                         mask_stride, mask_data);
+
+  surface = cairo_image_surface_create (CAIRO_FORMAT_A8,
+                                        stex->dst_width,
+                                        stex->dst_height);
+  stride = cairo_image_surface_get_stride (surface);
+  data = cairo_image_surface_get_data (surface);
+
+  for (y = 0; y < stex->dst_height; y++)
+    {
+      uint8_t *src_row;
+
+      src_row = mask_data + mask_stride *
+        get_mask_slice_source (y,
+                               stex->mask_slice_top,
+                               stex->mask_slice_bottom,
+                               stex->dst_height);
+
+      for (x = 0; x < stex->dst_width; x++)
+        {
+          data[y * stride + x] =
+            src_row[get_mask_slice_source (x,
+                                           stex->mask_slice_left,
+                                           stex->mask_slice_right,
+                                           stex->dst_width)];
+        }
+    }
+
+  cairo_surface_mark_dirty (surface);
+
+  return surface;
+}
+
 /**
  * meta_shaped_texture_get_image:
  * @stex: A #MetaShapedTexture
@@ -1362,7 +1676,24 @@ meta_shaped_texture_get_image (MetaShapedTexture     *stex,
     cogl_object_unref (texture);
 
   mask_texture = stex->mask_texture;
-  if (mask_texture != NULL)
+  if (mask_texture != NULL && stex->has_mask_slices)
+    {
+      cairo_t *cr;
+      cairo_surface_t *mask_surface;
+
+      mask_surface = create_mask_surface_from_slices (stex);
+
+      cr = cairo_create (surface);
+      cairo_set_source_surface (cr, mask_surface,
+                                image_clip ? -image_clip->x : 0,
+                                image_clip ? -image_clip->y : 0);
+      cairo_set_operator (cr, CAIRO_OPERATOR_DEST_IN);
+      cairo_paint (cr);
+      cairo_destroy (cr);
+
+      cairo_surface_destroy (mask_surface);
+    }
+  else if (mask_texture != NULL)
     {
       cairo_t *cr;
       cairo_surface_t *mask_surface;
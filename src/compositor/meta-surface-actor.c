@@ -20,6 +20,7 @@
 #include "compositor/meta-surface-actor.h"
 
 #include "clutter/clutter.h"
+#include "clutter/clutter-mutter.h"
 #include "compositor/meta-cullable.h"
 #include "compositor/meta-shaped-texture-private.h"
 #include "compositor/meta-window-actor-private.h"
@@ -356,6 +357,8 @@ meta_surface_actor_update_area (MetaSurfaceActor *self,
   gboolean repaint_scheduled = FALSE;
   cairo_rectangle_int_t clip;
 
+  /* Damage only changes what is painted, not what is picked, so queue the
+   * redraw without making the stage pick everything again. */
   if (meta_shaped_texture_update_area (priv->texture, x, y, width, height, &clip))
     {
       cairo_region_t *unobscured_region;
@@ -377,7 +380,8 @@ meta_surface_actor_update_area (MetaSurfaceActor *self,
               cairo_rectangle_int_t damage_rect;
 
               cairo_region_get_extents (intersection, &damage_rect);
-              clutter_actor_queue_redraw_with_clip (CLUTTER_ACTOR (self), &damage_rect);
+              clutter_actor_queue_damage_redraw (CLUTTER_ACTOR (self),
+                                                 &damage_rect);
               repaint_scheduled = TRUE;
             }
 
@@ -385,7 +389,7 @@ meta_surface_actor_update_area (MetaSurfaceActor *self,
         }
       else
         {
-          clutter_actor_queue_redraw_with_clip (CLUTTER_ACTOR (self), &clip);
+          clutter_actor_queue_damage_redraw (CLUTTER_ACTOR (self), &clip);
           repaint_scheduled = TRUE;
         }
     }
@@ -413,6 +417,14 @@ meta_surface_actor_set_input_region (MetaSurfaceActor *self,
 {
   MetaSurfaceActorPrivate *priv =
     meta_surface_actor_get_instance_private (self);
+  ClutterActor *stage;
+
+  if (!priv->input_region && !region)
+    return;
+
+  if (priv->input_region && region &&
+      cairo_region_equal (priv->input_region, region))
+    return;
 
   if (priv->input_region)
     cairo_region_destroy (priv->input_region);
@@ -421,6 +433,11 @@ meta_surface_actor_set_input_region (MetaSurfaceActor *self,
     priv->input_region = cairo_region_reference (region);
   else
     priv->input_region = NULL;
+
+  /* Damage doesn't invalidate the pick, see meta_surface_actor_update_area() */
+  stage = clutter_actor_get_stage (CLUTTER_ACTOR (self));
+  if (stage)
+    clutter_stage_invalidate_pick (CLUTTER_STAGE (stage));
 }
 
 void
@@ -24,6 +24,8 @@
 
 #include "compositor/meta-window-actor-x11.h"
 
+#include <string.h>
+
 #include "backends/meta-logical-monitor.h"
 #include "compositor/compositor-private.h"
 #include "compositor/meta-cullable.h"
@@ -302,7 +304,12 @@ queue_send_frame_messages_timeout (MetaWindowActorX11 *actor_x11)
   current_time =
     meta_compositor_monotonic_time_to_server_time (display,
                                                    g_get_monotonic_time ());
-  interval = (int) (1000000 / refresh_rate) * 6;
+  /* Suspended windows are out of sight; let their clients draw at a
+   * trickle rather than at a fraction of the refresh rate. */
+  if (meta_window_is_suspended (window))
+    interval = G_USEC_PER_SEC;
+  else
+    interval = (int) (1000000 / refresh_rate) * 6;
   offset = MAX (0, actor_x11->frame_drawn_time + interval - current_time) / 1000;
 
  /* The clutter master clock source has already been added with META_PRIORITY_REDRAW,
@@ -468,9 +475,10 @@ meta_window_actor_x11_queue_frame_drawn (MetaWindowActor *actor,
        * pre_paint/post_paint functions get called, enabling us to
        * send a _NET_WM_FRAME_DRAWN. We do a 1-pixel redraw to get
        * consistent timing with non-empty frames. If the window
-       * is completely obscured we fire off the send_frame_messages timeout.
+       * is completely obscured, or suspended (which includes minimized and
+       * on another workspace), we fire off the send_frame_messages timeout.
        */
-      if (is_obscured)
+      if (is_obscured || meta_window_is_suspended (window))
         {
           queue_send_frame_messages_timeout (actor_x11);
         }
@@ -798,6 +806,54 @@ meta_window_actor_x11_process_damage (MetaWindowActorX11 *actor_x11,
   meta_window_actor_notify_damaged (META_WINDOW_ACTOR (actor_x11));
 }
 
+#define BYTES_01 G_GUINT64_CONSTANT (0x0101010101010101)
+#define BYTES_80 G_GUINT64_CONSTANT (0x8080808080808080)
+
+/* Returns the first x in [x, x_end) where the mask is fully opaque,
+ * testing eight pixels at a time for a 0xff byte.
+ */
+static inline int
+find_opaque_pixel (const uint8_t *row,
+                   int            x,
+                   int            x_end)
+{
+  for (; x + 8 <= x_end; x += 8)
+    {
+      uint64_t word;
+
+      memcpy (&word, row + x, sizeof (word));
+      word = ~word;
+      if ((word - BYTES_01) & ~word & BYTES_80)
+        break;
+    }
+
+  while (x < x_end && row[x] != 0xff)
+    x++;
+
+  return x;
+}
+
+/* Returns the first x in [x, x_end) where the mask is not fully opaque */
+static inline int
+find_non_opaque_pixel (const uint8_t *row,
+                       int            x,
+                       int            x_end)
+{
+  for (; x + 8 <= x_end; x += 8)
+    {
+      uint64_t word;
+
+      memcpy (&word, row + x, sizeof (word));
+      if (word != G_MAXUINT64)
+        break;
+    }
+
+  while (x < x_end && row[x] == 0xff)
+    x++;
+
+  return x;
+}
+
 static cairo_region_t *
 scan_visible_region (guchar         *mask_data,
                      int             stride,
@@ -810,24 +866,28 @@ scan_visible_region (guchar         *mask_data,
 
   for (i = 0; i < n_rects; i++)
     {
-      int x, y;
+      int y;
       cairo_rectangle_int_t rect;
 
       cairo_region_get_rectangle (scan_area, i, &rect);
 
       for (y = rect.y; y < (rect.y + rect.height); y++)
         {
-          for (x = rect.x; x < (rect.x + rect.width); x++)
+          const uint8_t *row = mask_data + y * stride;
+          int x_end = rect.x + rect.width;
+          int x = rect.x;
+
+          while (x < x_end)
             {
-              int x2 = x;
-              while (mask_data[y * stride + x2] == 255 && x2 < (rect.x + rect.width))
-                x2++;
-
-              if (x2 > x)
-                {
-                  meta_region_builder_add_rectangle (&builder, x, y, x2 - x, 1);
-                  x = x2;
-                }
+              int run_end;
+
+              x = find_opaque_pixel (row, x, x_end);
+              if (x == x_end)
+                break;
+
+              run_end = find_non_opaque_pixel (row, x, x_end);
+              meta_region_builder_add_rectangle (&builder, x, y, run_end - x, 1);
+              x = run_end;
             }
         }
     }
@@ -835,6 +895,178 @@ scan_visible_region (guchar         *mask_data,
   return meta_region_builder_finish (&builder);
 }
 
+static void
+draw_frame_mask (MetaWindow     *window,
+                 cairo_t        *cr,
+                 cairo_region_t *shape_region,
+                 cairo_region_t *frame_paint_region)
+{
+  gdk_cairo_region (cr, shape_region);
+  cairo_fill (cr);
+
+  if (frame_paint_region)
+    {
+      gdk_cairo_region (cr, frame_paint_region);
+      cairo_clip (cr);
+
+      meta_frame_get_mask (window->frame, cr);
+    }
+}
+
+/*
+ * Decorated windows without a client shape have a mask that is opaque
+ * everywhere but along the frame, and the frame only changes along its
+ * edges near the corners. Such masks are built as nine-slice masks: only
+ * the four corners, plus one row and column through the middle that is
+ * stretched across the rest of the window, are rendered, scanned and
+ * uploaded, which keeps the work independent of the window size.
+ *
+ * The corners are made as wide and as tall as the frame border plus the
+ * title bar height, as an upper bound for the corner radius.
+ */
+static gboolean
+get_frame_mask_slices (MetaWindow            *window,
+                       int                    tex_width,
+                       int                    tex_height,
+                       cairo_rectangle_int_t *client_area,
+                       int                   *left,
+                       int                   *top,
+                       int                   *right,
+                       int                   *bottom)
+{
+  int corner_size;
+
+  if (!window->frame || window->shape_region)
+    return FALSE;
+
+  corner_size = client_area->y;
+
+  *left = client_area->x + corner_size;
+  *top = client_area->y;
+  *right = tex_width - (client_area->x + client_area->width) + corner_size;
+  *bottom = tex_height - (client_area->y + client_area->height) + corner_size;
+
+  return (*left + 1 + *right < tex_width &&
+          *top + 1 + *bottom < tex_height);
+}
+
+static uint8_t *
+build_nine_slice_frame_mask (MetaWindow            *window,
+                             cairo_rectangle_int_t *client_area,
+                             cairo_region_t        *shape_region,
+                             int                    tex_width,
+                             int                    tex_height,
+                             int                    left,
+                             int                    top,
+                             int                    right,
+                             int                    bottom,
+                             int                   *mask_stride)
+{
+  int mask_width = left + 1 + right;
+  int mask_height = top + 1 + bottom;
+  int x_offset = tex_width - right - (left + 1);
+  int y_offset = tex_height - bottom - (top + 1);
+  cairo_rectangle_int_t rect = { 0, 0, tex_width, tex_height };
+  cairo_rectangle_int_t mask_client_area;
+  cairo_region_t *frame_paint_region, *scan_area, *scanned_region;
+  cairo_surface_t *image;
+  MetaRegionBuilder builder;
+  uint8_t *mask_data;
+  int stride;
+  int i, n_rects;
+
+  stride = cairo_format_stride_for_width (CAIRO_FORMAT_A8, mask_width);
+  mask_data = g_malloc0 (stride * mask_height);
+
+  image = cairo_image_surface_create_for_data (mask_data,
+                                               CAIRO_FORMAT_A8,
+                                               mask_width,
+                                               mask_height,
+                                               stride);
+
+  frame_paint_region = cairo_region_create_rectangle (&rect);
+  cairo_region_subtract_rectangle (frame_paint_region, client_area);
+
+  /* Draw each quadrant of the full size mask into its corner of the
+   * nine-slice mask. The device offset, unlike a cairo transform, is not
+   * affected by the device scale meta_frame_get_mask() sets for HiDPI.
+   */
+  for (i = 0; i < 4; i++)
+    {
+      gboolean is_right = (i & 1) != 0;
+      gboolean is_bottom = (i & 2) != 0;
+      cairo_rectangle_int_t quadrant;
+      cairo_t *cr;
+
+      quadrant = (cairo_rectangle_int_t) {
+        .x = is_right ? left + 1 : 0,
+        .y = is_bottom ? top + 1 : 0,
+        .width = is_right ? right : left + 1,
+        .height = is_bottom ? bottom : top + 1,
+      };
+      if (quadrant.width == 0 || quadrant.height == 0)
+        continue;
+
+      cairo_surface_set_device_offset (image,
+                                       is_right ? -x_offset : 0,
+                                       is_bottom ? -y_offset : 0);
+
+      cr = cairo_create (image);
+      cairo_rectangle (cr,
+                       quadrant.x + (is_right ? x_offset : 0),
+                       quadrant.y + (is_bottom ? y_offset : 0),
+                       quadrant.width, quadrant.height);
+      cairo_clip (cr);
+      draw_frame_mask (window, cr, shape_region, frame_paint_region);
+      cairo_destroy (cr);
+    }
+
+  cairo_surface_flush (image);
+  cairo_surface_destroy (image);
+  cairo_region_destroy (frame_paint_region);
+
+  /* Scan the frame part of the nine-slice mask ... */
+  mask_client_area = (cairo_rectangle_int_t) {
+    .x = client_area->x,
+    .y = client_area->y,
+    .width = client_area->width - x_offset,
+    .height = client_area->height - y_offset,
+  };
+  rect = (cairo_rectangle_int_t) { 0, 0, mask_width, mask_height };
+  scan_area = cairo_region_create_rectangle (&rect);
+  cairo_region_subtract_rectangle (scan_area, &mask_client_area);
+
+  scanned_region = scan_visible_region (mask_data, stride, scan_area);
+  cairo_region_destroy (scan_area);
+
+  /* ... and stretch the result back to the size of the window */
+  meta_region_builder_init (&builder);
+  n_rects = cairo_region_num_rectangles (scanned_region);
+  for (i = 0; i < n_rects; i++)
+    {
+      int x1, y1, x2, y2;
+
+      cairo_region_get_rectangle (scanned_region, i, &rect);
+
+      x1 = rect.x <= left ? rect.x : rect.x + x_offset;
+      x2 = rect.x + rect.width <= left ? rect.x + rect.width
+                                       : rect.x + rect.width + x_offset;
+      y1 = rect.y <= top ? rect.y : rect.y + y_offset;
+      y2 = rect.y + rect.height <= top ? rect.y + rect.height
+                                       : rect.y + rect.height + y_offset;
+
+      meta_region_builder_add_rectangle (&builder, x1, y1, x2 - x1, y2 - y1);
+    }
+  cairo_region_destroy (scanned_region);
+
+  scanned_region = meta_region_builder_finish (&builder);
+  cairo_region_union (shape_region, scanned_region);
+  cairo_region_destroy (scanned_region);
+
+  *mask_stride = stride;
+  return mask_data;
+}
+
 static void
 build_and_scan_frame_mask (MetaWindowActorX11    *actor_x11,
                            cairo_rectangle_int_t *client_area,
@@ -848,12 +1080,13 @@ build_and_scan_frame_mask (MetaWindowActorX11    *actor_x11,
     meta_window_actor_get_surface (META_WINDOW_ACTOR (actor_x11));
   uint8_t *mask_data;
   unsigned int tex_width, tex_height;
+  unsigned int mask_width, mask_height;
   MetaShapedTexture *stex;
   CoglTexture *paint_tex;
   CoglTexture2D *mask_texture;
   int stride;
-  cairo_t *cr;
-  cairo_surface_t *image;
+  gboolean is_nine_slice;
+  int left, top, right, bottom;
   GError *error = NULL;
 
   stex = meta_surface_actor_get_texture (surface);
@@ -868,46 +1101,68 @@ build_and_scan_frame_mask (MetaWindowActorX11    *actor_x11,
   tex_width = cogl_texture_get_width (paint_tex);
   tex_height = cogl_texture_get_height (paint_tex);
 
-  stride = cairo_format_stride_for_width (CAIRO_FORMAT_A8, tex_width);
+  is_nine_slice = get_frame_mask_slices (window, tex_width, tex_height,
+                                         client_area,
+                                         &left, &top, &right, &bottom);
+  if (is_nine_slice)
+    {
+      mask_width = left + 1 + right;
+      mask_height = top + 1 + bottom;
+      mask_data = build_nine_slice_frame_mask (window, client_area,
+                                               shape_region,
+                                               tex_width, tex_height,
+                                               left, top, right, bottom,
+                                               &stride);
+    }
+  else
+    {
+      cairo_region_t *frame_paint_region = NULL;
+      cairo_surface_t *image;
+      cairo_t *cr;
 
-  /* Create data for an empty image */
-  mask_data = g_malloc0 (stride * tex_height);
+      mask_width = tex_width;
+      mask_height = tex_height;
 
-  image = cairo_image_surface_create_for_data (mask_data,
-                                               CAIRO_FORMAT_A8,
-                                               tex_width,
-                                               tex_height,
-                                               stride);
-  cr = cairo_create (image);
+      stride = cairo_format_stride_for_width (CAIRO_FORMAT_A8, tex_width);
 
-  gdk_cairo_region (cr, shape_region);
-  cairo_fill (cr);
+      /* Create data for an empty image */
+      mask_data = g_malloc0 (stride * tex_height);
 
-  if (window->frame)
-    {
-      cairo_region_t *frame_paint_region, *scanned_region;
-      cairo_rectangle_int_t rect = { 0, 0, tex_width, tex_height };
+      image = cairo_image_surface_create_for_data (mask_data,
+                                                   CAIRO_FORMAT_A8,
+                                                   tex_width,
+                                                   tex_height,
+                                                   stride);
+      cr = cairo_create (image);
 
-      /* Make sure we don't paint the frame over the client window. */
-      frame_paint_region = cairo_region_create_rectangle (&rect);
-      cairo_region_subtract_rectangle (frame_paint_region, client_area);
+      if (window->frame)
+        {
+          cairo_rectangle_int_t rect = { 0, 0, tex_width, tex_height };
 
-      gdk_cairo_region (cr, frame_paint_region);
-      cairo_clip (cr);
+          /* Make sure we don't paint the frame over the client window. */
+          frame_paint_region = cairo_region_create_rectangle (&rect);
+          cairo_region_subtract_rectangle (frame_paint_region, client_area);
+        }
 
-      meta_frame_get_mask (window->frame, cr);
+      draw_frame_mask (window, cr, shape_region, frame_paint_region);
 
-      cairo_surface_flush (image);
-      scanned_region = scan_visible_region (mask_data, stride, frame_paint_region);
-      cairo_region_union (shape_region, scanned_region);
-      cairo_region_destroy (scanned_region);
-      cairo_region_destroy (frame_paint_region);
-    }
+      if (frame_paint_region)
+        {
+          cairo_region_t *scanned_region;
+
+          cairo_surface_flush (image);
+          scanned_region = scan_visible_region (mask_data, stride,
+                                                frame_paint_region);
+          cairo_region_union (shape_region, scanned_region);
+          cairo_region_destroy (scanned_region);
+          cairo_region_destroy (frame_paint_region);
+        }
 
-  cairo_destroy (cr);
-  cairo_surface_destroy (image);
+      cairo_destroy (cr);
+      cairo_surface_destroy (image);
+    }
 
-  mask_texture = cogl_texture_2d_new_from_data (ctx, tex_width, tex_height,
+  mask_texture = cogl_texture_2d_new_from_data (ctx, mask_width, mask_height,
                                                 COGL_PIXEL_FORMAT_A_8,
                                                 stride, mask_data, &error);
 
@@ -917,7 +1172,15 @@ build_and_scan_frame_mask (MetaWindowActorX11    *actor_x11,
       g_error_free (error);
     }
 
-  if (mask_texture)
+  if (mask_texture && is_nine_slice)
+    {
+      meta_shaped_texture_set_nine_slice_mask_texture (stex,
+                                                       COGL_TEXTURE (mask_texture),
+                                                       left, top,
+                                                       right, bottom);
+      cogl_object_unref (mask_texture);
+    }
+  else if (mask_texture)
     {
       meta_shaped_texture_set_mask_texture (stex, COGL_TEXTURE (mask_texture));
       cogl_object_unref (mask_texture);
@@ -41,6 +41,9 @@
 #include "wayland/meta-wayland-surface.h"
 #endif
 
+/* How long a window has to stay out of sight before it is suspended */
+#define SUSPEND_DELAY_MS 2000
+
 typedef enum
 {
   INITIALLY_FROZEN,
@@ -70,6 +73,9 @@ typedef struct _MetaWindowActorPrivate
 
   guint             freeze_count;
 
+  MetaWindowVisibility culled_visibility;
+  guint             suspend_timeout_id;
+
   guint		    visible                : 1;
   guint		    disposed               : 1;
 
@@ -110,6 +116,9 @@ static void meta_window_actor_get_property (GObject      *object,
 static void meta_window_actor_real_assign_surface_actor (MetaWindowActor  *self,
                                                          MetaSurfaceActor *surface_actor);
 
+static void meta_window_actor_paint (ClutterActor        *actor,
+                                     ClutterPaintContext *paint_context);
+
 static void cullable_iface_init (MetaCullableInterface *iface);
 
 static void screen_cast_window_iface_init (MetaScreenCastWindowInterface *iface);
@@ -123,6 +132,7 @@ static void
 meta_window_actor_class_init (MetaWindowActorClass *klass)
 {
   GObjectClass *object_class = G_OBJECT_CLASS (klass);
+  ClutterActorClass *actor_class = CLUTTER_ACTOR_CLASS (klass);
   GParamSpec   *pspec;
 
   object_class->dispose      = meta_window_actor_dispose;
@@ -130,6 +140,8 @@ meta_window_actor_class_init (MetaWindowActorClass *klass)
   object_class->get_property = meta_window_actor_get_property;
   object_class->constructed  = meta_window_actor_constructed;
 
+  actor_class->paint = meta_window_actor_paint;
+
   klass->assign_surface_actor = meta_window_actor_real_assign_surface_actor;
 
   /**
@@ -389,6 +401,8 @@ meta_window_actor_dispose (GObject *object)
 
   priv->disposed = TRUE;
 
+  g_clear_handle_id (&priv->suspend_timeout_id, g_source_remove);
+
   meta_compositor_remove_window_actor (compositor, self);
 
   g_clear_object (&priv->window);
@@ -946,6 +960,120 @@ see_region (cairo_region_t *region,
 #endif
 
 
+static gboolean
+suspend_timeout (gpointer user_data)
+{
+  MetaWindowActor *self = META_WINDOW_ACTOR (user_data);
+  MetaWindowActorPrivate *priv =
+    meta_window_actor_get_instance_private (self);
+
+  priv->suspend_timeout_id = 0;
+
+  meta_window_set_visibility (priv->window, priv->culled_visibility);
+
+  return G_SOURCE_REMOVE;
+}
+
+/* Windows coming into view are resumed right away, while windows going out
+ * of view are only suspended once they stayed out of view for a while, so
+ * that e.g. switching between windows doesn't make clients flip-flop. */
+static void
+update_visibility (MetaWindowActor      *self,
+                   MetaWindowVisibility  visibility)
+{
+  MetaWindowActorPrivate *priv =
+    meta_window_actor_get_instance_private (self);
+
+  priv->culled_visibility = visibility;
+
+  if (visibility == META_WINDOW_VISIBILITY_VISIBLE ||
+      visibility == META_WINDOW_VISIBILITY_PARTIALLY_VISIBLE)
+    {
+      g_clear_handle_id (&priv->suspend_timeout_id, g_source_remove);
+      meta_window_set_visibility (priv->window, visibility);
+    }
+  else if (meta_window_is_suspended (priv->window))
+    {
+      meta_window_set_visibility (priv->window, visibility);
+    }
+  else if (!priv->suspend_timeout_id)
+    {
+      priv->suspend_timeout_id = g_timeout_add (SUSPEND_DELAY_MS,
+                                                suspend_timeout,
+                                                self);
+      g_source_set_name_by_id (priv->suspend_timeout_id,
+                               "[mutter] suspend_timeout");
+    }
+}
+
+static MetaWindowVisibility
+get_culled_visibility (MetaWindowActor *self,
+                       cairo_region_t  *unobscured_region)
+{
+  MetaWindowActorPrivate *priv =
+    meta_window_actor_get_instance_private (self);
+  ClutterActor *actor;
+  MetaRectangle frame_rect;
+  MetaRectangle buffer_rect;
+  cairo_rectangle_int_t rect;
+
+  if (!clutter_actor_is_visible (CLUTTER_ACTOR (self)))
+    return META_WINDOW_VISIBILITY_HIDDEN;
+
+  /* Clones show the window no matter what is stacked on top of it */
+  for (actor = CLUTTER_ACTOR (self); actor; actor = clutter_actor_get_parent (actor))
+    {
+      if (clutter_actor_has_mapped_clones (actor))
+        return META_WINDOW_VISIBILITY_VISIBLE;
+    }
+
+  /* Not culled, e.g. due to effects or transformations */
+  if (!unobscured_region)
+    return META_WINDOW_VISIBILITY_VISIBLE;
+
+  meta_window_get_frame_rect (priv->window, &frame_rect);
+  meta_window_get_buffer_rect (priv->window, &buffer_rect);
+
+  if (meta_rectangle_area (&frame_rect) == 0)
+    return META_WINDOW_VISIBILITY_VISIBLE;
+
+  rect = (cairo_rectangle_int_t) {
+    .x = frame_rect.x - buffer_rect.x,
+    .y = frame_rect.y - buffer_rect.y,
+    .width = frame_rect.width,
+    .height = frame_rect.height,
+  };
+
+  switch (cairo_region_contains_rectangle (unobscured_region, &rect))
+    {
+    case CAIRO_REGION_OVERLAP_IN:
+      return META_WINDOW_VISIBILITY_VISIBLE;
+    case CAIRO_REGION_OVERLAP_PART:
+      return META_WINDOW_VISIBILITY_PARTIALLY_VISIBLE;
+    case CAIRO_REGION_OVERLAP_OUT:
+      return META_WINDOW_VISIBILITY_OCCLUDED;
+    }
+
+  g_assert_not_reached ();
+}
+
+static void
+meta_window_actor_paint (ClutterActor        *actor,
+                         ClutterPaintContext *paint_context)
+{
+  MetaWindowActor *self = META_WINDOW_ACTOR (actor);
+  MetaWindowActorPrivate *priv =
+    meta_window_actor_get_instance_private (self);
+
+  /* Culling only sees the window group; a window painted through a clone
+   * elsewhere on the stage must not stay suspended. */
+  if (!priv->disposed && clutter_actor_is_in_clone_paint (actor))
+    update_visibility (self, META_WINDOW_VISIBILITY_VISIBLE);
+
+  CLUTTER_ACTOR_CLASS (meta_window_actor_parent_class)->paint (actor,
+                                                               paint_context);
+}
+
 static void
 meta_window_actor_cull_out (MetaCullable   *cullable,
                             cairo_region_t *unobscured_region,
@@ -955,6 +1083,9 @@ meta_window_actor_cull_out (MetaCullable   *cullable,
   MetaWindowActorPrivate *priv =
     meta_window_actor_get_instance_private (self);
 
+  if (!priv->disposed)
+    update_visibility (self, get_culled_visibility (self, unobscured_region));
+
   meta_cullable_cull_out_children (cullable, unobscured_region, clip_region);
 
   if ((unobscured_region || clip_region) && meta_window_actor_is_opaque (self))
@@ -237,8 +237,9 @@ struct _MetaDisplay
   MetaSoundPlayer *sound_player;
 
   MetaSelectionSource *selection_source;
-  GBytes *saved_clipboard;
+  int saved_clipboard_fd;
   gchar *saved_clipboard_mimetype;
+  GCancellable *saved_clipboard_cancellable;
   MetaSelection *selection;
 };
 
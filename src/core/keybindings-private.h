@@ -129,6 +129,8 @@ typedef struct
   ClutterModifierType window_grab_modifiers;
 } MetaKeyBindingManager;
 
+void     meta_keybindings_precompile_keymaps (void);
+
 void     meta_display_init_keys             (MetaDisplay *display);
 void     meta_display_shutdown_keys         (MetaDisplay *display);
 void     meta_window_grab_keys              (MetaWindow  *window);
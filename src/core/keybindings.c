@@ -719,13 +719,22 @@ clear_active_keyboard_layouts (MetaKeyBindingManager *keys)
     }
 }
 
-static MetaKeyBindingKeyboardLayout
-create_us_layout (void)
+/* The US layout never changes, so it is compiled once and shared. It may
+ * be compiled on a startup thread; xkb_keymap refcounting is not atomic,
+ * so references are only taken while holding the lock.
+ */
+G_LOCK_DEFINE_STATIC (us_keymap);
+static struct xkb_keymap *us_keymap;
+
+static struct xkb_keymap *
+ensure_us_keymap_locked (void)
 {
   struct xkb_rule_names names;
-  struct xkb_keymap *keymap;
   struct xkb_context *context;
 
+  if (us_keymap)
+    return us_keymap;
+
   names.rules = DEFAULT_XKB_RULES_FILE;
   names.model = DEFAULT_XKB_MODEL;
   names.layout = "us";
@@ -733,9 +742,36 @@ create_us_layout (void)
   names.options = "";
 
   context = xkb_context_new (XKB_CONTEXT_NO_FLAGS);
-  keymap = xkb_keymap_new_from_names (context, &names, XKB_KEYMAP_COMPILE_NO_FLAGS);
+  us_keymap = xkb_keymap_new_from_names (context, &names,
+                                         XKB_KEYMAP_COMPILE_NO_FLAGS);
   xkb_context_unref (context);
 
+  return us_keymap;
+}
+
+/**
+ * meta_keybindings_precompile_keymaps:
+ *
+ * Compiles the fallback US keymap used for resolving keybindings on
+ * non-Latin layouts. Safe to call from any thread.
+ */
+void
+meta_keybindings_precompile_keymaps (void)
+{
+  G_LOCK (us_keymap);
+  ensure_us_keymap_locked ();
+  G_UNLOCK (us_keymap);
+}
+
+static MetaKeyBindingKeyboardLayout
+create_us_layout (void)
+{
+  struct xkb_keymap *keymap;
+
+  G_LOCK (us_keymap);
+  keymap = xkb_keymap_ref (ensure_us_keymap_locked ());
+  G_UNLOCK (us_keymap);
+
   return (MetaKeyBindingKeyboardLayout) {
     .keymap = keymap,
     .n_levels = calculate_n_layout_levels (keymap, 0),
@@ -78,8 +78,11 @@
 #include "backends/x11/cm/meta-backend-x11-cm.h"
 #include "backends/x11/meta-backend-x11.h"
 #include "clutter/clutter.h"
+#include "compositor/meta-shaped-texture-private.h"
 #include "core/display-private.h"
+#include "core/keybindings-private.h"
 #include "core/main-private.h"
+#include "core/meta-startup-scheduler.h"
 #include "core/util-private.h"
 #include "meta/compositor.h"
 #include "meta/meta-backend.h"
@@ -655,6 +658,52 @@ meta_register_with_session (void)
   g_free (opt_client_id);
 }
 
+static gboolean
+init_prefs (gpointer   user_data,
+            GError   **error)
+{
+  meta_prefs_init ();
+  meta_prefs_add_listener (prefs_changed_callback, NULL);
+
+  return TRUE;
+}
+
+static gboolean
+compile_keymaps (gpointer   user_data,
+                 GError   **error)
+{
+  meta_keybindings_precompile_keymaps ();
+
+  return TRUE;
+}
+
+static gboolean
+warm_up_shaders (gpointer   user_data,
+                 GError   **error)
+{
+  MetaBackend *backend = meta_get_backend ();
+  ClutterBackend *clutter_backend = meta_backend_get_clutter_backend (backend);
+  CoglContext *cogl_context = clutter_backend_get_cogl_context (clutter_backend);
+
+  meta_shaped_texture_init_pipelines (cogl_context);
+
+  return TRUE;
+}
+
+static gboolean
+open_display (gpointer   user_data,
+              GError   **error)
+{
+  if (!meta_display_open ())
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                   "Failed to open display");
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
 /**
  * meta_run: (skip)
  *
@@ -666,12 +715,35 @@ meta_register_with_session (void)
 int
 meta_run (void)
 {
-  /* Load prefs */
-  meta_prefs_init ();
-  meta_prefs_add_listener (prefs_changed_callback, NULL);
+  g_autoptr (MetaStartupScheduler) scheduler = NULL;
+  g_autoptr (GError) error = NULL;
+
+  scheduler = meta_startup_scheduler_new ();
+  meta_startup_scheduler_add_task (scheduler, "prefs",
+                                   META_STARTUP_TASK_FLAG_NONE,
+                                   init_prefs, NULL,
+                                   NULL);
+  /* Only a head start, the keymap is compiled on demand if still missing */
+  meta_startup_scheduler_add_task (scheduler, "keymap",
+                                   META_STARTUP_TASK_FLAG_THREAD,
+                                   compile_keymaps, NULL,
+                                   NULL);
+  meta_startup_scheduler_add_task (scheduler, "shader-warm-up",
+                                   META_STARTUP_TASK_FLAG_NONE,
+                                   warm_up_shaders, NULL,
+                                   NULL);
+  meta_startup_scheduler_add_task (scheduler, "display",
+                                   META_STARTUP_TASK_FLAG_NONE,
+                                   open_display, NULL,
+                                   "prefs", NULL);
+
+  if (!meta_startup_scheduler_run (scheduler, &error))
+    {
+      meta_warning ("%s\n", error->message);
+      meta_exit (META_EXIT_ERROR);
+    }
 
-  if (!meta_display_open ())
-    meta_exit (META_EXIT_ERROR);
+  g_clear_pointer (&scheduler, meta_startup_scheduler_free);
 
   g_main_loop_run (meta_main_loop);
 
@@ -21,12 +21,28 @@
 
 #include "config.h"
 
+#include <errno.h>
+#include <unistd.h>
+
 #include "core/meta-clipboard-manager.h"
-#include "meta/meta-selection-source-memory.h"
+#include "core/meta-selection-source-memfd.h"
+#include "meta/prefs.h"
 
 #define MAX_TEXT_SIZE (4 * 1024 * 1024) /* 4MB */
 #define MAX_IMAGE_SIZE (200 * 1024 * 1024) /* 200MB */
 
+#define TRANSFER_CHUNK_SIZE (64 * 1024)
+
+typedef struct
+{
+  MetaDisplay *display;
+  GInputStream *stream;
+  GCancellable *cancellable;
+  int fd;
+  gssize max_size;
+  gssize size;
+} ClipboardSave;
+
 /* Supported mimetype globs, from least to most preferred */
 static struct {
   const char *mimetype_glob;
@@ -58,25 +74,188 @@ mimetype_match (const char *mimetype,
 }
 
 static void
-transfer_cb (MetaSelection *selection,
-             GAsyncResult  *result,
-             GOutputStream *output)
+clipboard_save_free (ClipboardSave *save)
 {
-  MetaDisplay *display = meta_get_display ();
-  GError *error = NULL;
+  g_clear_object (&save->stream);
+  g_clear_object (&save->cancellable);
+  if (save->fd != -1)
+    close (save->fd);
+  g_free (save);
+}
 
-  if (!meta_selection_transfer_finish (selection, result, &error))
+static void
+clipboard_save_failed (ClipboardSave *save,
+                       GError        *error)
+{
+  MetaDisplay *display = save->display;
+
+  if (!g_cancellable_is_cancelled (save->cancellable))
     {
       g_warning ("Failed to store clipboard: %s", error->message);
-      g_error_free (error);
-      g_object_unref (output);
+      g_clear_object (&display->saved_clipboard_cancellable);
+      g_clear_pointer (&display->saved_clipboard_mimetype, g_free);
+    }
+
+  g_error_free (error);
+  clipboard_save_free (save);
+}
+
+static void
+take_over_clipboard (MetaDisplay *display)
+{
+  MetaSelection *selection = meta_display_get_selection (display);
+  MetaSelectionSource *source;
+
+  source = meta_selection_source_memfd_new (display->saved_clipboard_mimetype,
+                                            display->saved_clipboard_fd);
+  display->saved_clipboard_fd = -1;
+  g_set_object (&display->selection_source, source);
+  meta_selection_set_owner (selection, META_SELECTION_CLIPBOARD, source);
+  g_object_unref (source);
+}
+
+static void
+clipboard_save_done (ClipboardSave *save)
+{
+  MetaDisplay *display = save->display;
+  MetaSelection *selection = meta_display_get_selection (display);
+  GList *mimetypes;
+
+  g_clear_object (&display->saved_clipboard_cancellable);
+
+  display->saved_clipboard_fd = save->fd;
+  save->fd = -1;
+  clipboard_save_free (save);
+
+  /* The owner might have gone away while its contents were being saved */
+  mimetypes = meta_selection_get_mimetypes (selection,
+                                            META_SELECTION_CLIPBOARD);
+  if (!mimetypes)
+    take_over_clipboard (display);
+  g_list_free_full (mimetypes, g_free);
+}
+
+static void
+read_chunk_cb (GInputStream  *stream,
+               GAsyncResult  *result,
+               ClipboardSave *save)
+{
+  GError *error = NULL;
+  GBytes *bytes;
+  const uint8_t *data;
+  gsize len;
+
+  bytes = g_input_stream_read_bytes_finish (stream, result, &error);
+  if (!bytes)
+    {
+      clipboard_save_failed (save, error);
+      return;
+    }
+
+  if (g_cancellable_is_cancelled (save->cancellable))
+    {
+      g_bytes_unref (bytes);
+      clipboard_save_free (save);
+      return;
+    }
+
+  data = g_bytes_get_data (bytes, &len);
+  if (len == 0)
+    {
+      g_bytes_unref (bytes);
+      clipboard_save_done (save);
+      return;
+    }
+
+  if (save->size + len > save->max_size)
+    {
+      g_bytes_unref (bytes);
+      g_set_error (&error, G_IO_ERROR, G_IO_ERROR_NO_SPACE,
+                   "Clipboard contents exceed %" G_GSSIZE_FORMAT " bytes",
+                   save->max_size);
+      clipboard_save_failed (save, error);
+      return;
+    }
+
+  /* The file is memory backed, so writing to it doesn't block */
+  while (len > 0)
+    {
+      ssize_t ret;
+
+      ret = write (save->fd, data, len);
+      if (ret < 0)
+        {
+          int errsv = errno;
+
+          if (errsv == EINTR)
+            continue;
+
+          g_bytes_unref (bytes);
+          g_set_error (&error, G_IO_ERROR, g_io_error_from_errno (errsv),
+                       "%s", g_strerror (errsv));
+          clipboard_save_failed (save, error);
+          return;
+        }
+
+      data += ret;
+      len -= ret;
+      save->size += ret;
+    }
+
+  g_bytes_unref (bytes);
+
+  g_input_stream_read_bytes_async (save->stream,
+                                   TRANSFER_CHUNK_SIZE,
+                                   G_PRIORITY_LOW,
+                                   save->cancellable,
+                                   (GAsyncReadyCallback) read_chunk_cb,
+                                   save);
+}
+
+static void
+source_read_cb (MetaSelectionSource *source,
+                GAsyncResult        *result,
+                ClipboardSave       *save)
+{
+  GError *error = NULL;
+
+  save->stream = meta_selection_source_read_finish (source, result, &error);
+  if (!save->stream)
+    {
+      clipboard_save_failed (save, error);
       return;
     }
 
-  g_output_stream_close (output, NULL, NULL);
-  display->saved_clipboard =
-    g_memory_output_stream_steal_as_bytes (G_MEMORY_OUTPUT_STREAM (output));
-  g_object_unref (output);
+  if (g_cancellable_is_cancelled (save->cancellable))
+    {
+      clipboard_save_free (save);
+      return;
+    }
+
+  g_input_stream_read_bytes_async (save->stream,
+                                   TRANSFER_CHUNK_SIZE,
+                                   G_PRIORITY_LOW,
+                                   save->cancellable,
+                                   (GAsyncReadyCallback) read_chunk_cb,
+                                   save);
+}
+
+static void
+clear_saved_clipboard (MetaDisplay *display)
+{
+  if (display->saved_clipboard_cancellable)
+    {
+      g_cancellable_cancel (display->saved_clipboard_cancellable);
+      g_clear_object (&display->saved_clipboard_cancellable);
+    }
+
+  if (display->saved_clipboard_fd != -1)
+    {
+      close (display->saved_clipboard_fd);
+      display->saved_clipboard_fd = -1;
+    }
+
+  g_clear_pointer (&display->saved_clipboard_mimetype, g_free);
 }
 
 static void
@@ -90,18 +269,24 @@ owner_changed_cb (MetaSelection       *selection,
 
   if (new_owner && new_owner != display->selection_source)
     {
-      GOutputStream *output;
+      ClipboardSave *save;
       GList *mimetypes, *l;
       int best_idx = -1;
       const char *best = NULL;
       ssize_t transfer_size = -1;
+      gssize size_limit;
+      GError *error = NULL;
+      int fd;
 
       /* New selection source, find the best mimetype in order to
        * keep a copy of it.
        */
       g_clear_object (&display->selection_source);
-      g_clear_pointer (&display->saved_clipboard_mimetype, g_free);
-      g_clear_pointer (&display->saved_clipboard, g_bytes_unref);
+      clear_saved_clipboard (display);
+
+      size_limit = (gssize) meta_prefs_get_clipboard_size_limit () * 1024 * 1024;
+      if (size_limit <= 0)
+        return;
 
       mimetypes = meta_selection_get_mimetypes (selection, selection_type);
 
@@ -122,26 +307,40 @@ owner_changed_cb (MetaSelection       *selection,
         }
 
       if (best_idx < 0)
-        return;
+        {
+          g_list_free_full (mimetypes, g_free);
+          return;
+        }
+
+      fd = meta_selection_source_memfd_create_fd (&error);
+      if (fd == -1)
+        {
+          g_warning ("Failed to store clipboard: %s", error->message);
+          g_error_free (error);
+          g_list_free_full (mimetypes, g_free);
+          return;
+        }
 
       display->saved_clipboard_mimetype = g_strdup (best);
-      output = g_memory_output_stream_new_resizable ();
-      meta_selection_transfer_async (selection,
-                                     META_SELECTION_CLIPBOARD,
-                                     best,
-                                     transfer_size,
-                                     output,
-                                     NULL,
-                                     (GAsyncReadyCallback) transfer_cb,
-                                     output);
+      display->saved_clipboard_cancellable = g_cancellable_new ();
+      g_list_free_full (mimetypes, g_free);
+
+      save = g_new0 (ClipboardSave, 1);
+      save->display = display;
+      save->cancellable = g_object_ref (display->saved_clipboard_cancellable);
+      save->fd = fd;
+      save->max_size = MIN (transfer_size, size_limit);
+
+      meta_selection_source_read_async (new_owner,
+                                        display->saved_clipboard_mimetype,
+                                        save->cancellable,
+                                        (GAsyncReadyCallback) source_read_cb,
+                                        save);
     }
-  else if (!new_owner && display->saved_clipboard)
+  else if (!new_owner && display->saved_clipboard_fd != -1)
     {
       /* Old owner is gone, time to take over */
-      new_owner = meta_selection_source_memory_new (display->saved_clipboard_mimetype,
-                                                    display->saved_clipboard);
-      g_set_object (&display->selection_source, new_owner);
-      meta_selection_set_owner (selection, selection_type, new_owner);
+      take_over_clipboard (display);
     }
 }
 
@@ -150,6 +349,8 @@ meta_clipboard_manager_init (MetaDisplay *display)
 {
   MetaSelection *selection;
 
+  display->saved_clipboard_fd = -1;
+
   selection = meta_display_get_selection (display);
   g_signal_connect_after (selection, "owner-changed",
                           G_CALLBACK (owner_changed_cb), display);
@@ -160,8 +361,7 @@ meta_clipboard_manager_shutdown (MetaDisplay *display)
 {
   MetaSelection *selection;
 
-  g_clear_pointer (&display->saved_clipboard, g_bytes_unref);
-  g_clear_pointer (&display->saved_clipboard_mimetype, g_free);
+  clear_saved_clipboard (display);
   selection = meta_display_get_selection (display);
   g_signal_handlers_disconnect_by_func (selection, owner_changed_cb, display);
 }
@@ -0,0 +1,213 @@
+/*
+ * Copyright (C) 2020 Red Hat
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ */
+
+#include "config.h"
+
+#include "core/meta-selection-source-memfd.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <gio/gunixinputstream.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+struct _MetaSelectionSourceMemfd
+{
+  MetaSelectionSource parent_instance;
+  char *mimetype;
+  int fd;
+};
+
+G_DEFINE_TYPE (MetaSelectionSourceMemfd,
+               meta_selection_source_memfd,
+               META_TYPE_SELECTION_SOURCE)
+
+static void
+meta_selection_source_memfd_read_async (MetaSelectionSource *source,
+                                        const char          *mimetype,
+                                        GCancellable        *cancellable,
+                                        GAsyncReadyCallback  callback,
+                                        gpointer             user_data)
+{
+  MetaSelectionSourceMemfd *source_memfd = META_SELECTION_SOURCE_MEMFD (source);
+  g_autofree char *path = NULL;
+  GInputStream *stream;
+  GTask *task;
+  int fd;
+
+  if (g_strcmp0 (mimetype, source_memfd->mimetype) != 0)
+    {
+      g_task_report_new_error (source, callback, user_data,
+                               meta_selection_source_memfd_read_async,
+                               G_IO_ERROR, G_IO_ERROR_FAILED,
+                               "Mimetype not in selection");
+      return;
+    }
+
+  /*
+   * Reopen the file rather than dup() it, so each reader gets its own
+   * file offset.
+   */
+  path = g_strdup_printf ("/proc/self/fd/%d", source_memfd->fd);
+  fd = open (path, O_RDONLY | O_CLOEXEC);
+  if (fd == -1)
+    {
+      int errsv = errno;
+
+      g_task_report_new_error (source, callback, user_data,
+                               meta_selection_source_memfd_read_async,
+                               G_IO_ERROR, g_io_error_from_errno (errsv),
+                               "Failed to open clipboard contents: %s",
+                               g_strerror (errsv));
+      return;
+    }
+
+  task = g_task_new (source, cancellable, callback, user_data);
+  g_task_set_source_tag (task, meta_selection_source_memfd_read_async);
+
+  stream = g_unix_input_stream_new (fd, TRUE);
+  g_task_return_pointer (task, stream, g_object_unref);
+  g_object_unref (task);
+}
+
+static GInputStream *
+meta_selection_source_memfd_read_finish (MetaSelectionSource  *source,
+                                         GAsyncResult         *result,
+                                         GError              **error)
+{
+  g_assert (g_task_get_source_tag (G_TASK (result)) ==
+            meta_selection_source_memfd_read_async);
+  return g_task_propagate_pointer (G_TASK (result), error);
+}
+
+static GList *
+meta_selection_source_memfd_get_mimetypes (MetaSelectionSource *source)
+{
+  MetaSelectionSourceMemfd *source_memfd = META_SELECTION_SOURCE_MEMFD (source);
+
+  return g_list_prepend (NULL, g_strdup (source_memfd->mimetype));
+}
+
+static void
+meta_selection_source_memfd_finalize (GObject *object)
+{
+  MetaSelectionSourceMemfd *source_memfd = META_SELECTION_SOURCE_MEMFD (object);
+
+  if (source_memfd->fd != -1)
+    close (source_memfd->fd);
+  g_free (source_memfd->mimetype);
+
+  G_OBJECT_CLASS (meta_selection_source_memfd_parent_class)->finalize (object);
+}
+
+static void
+meta_selection_source_memfd_class_init (MetaSelectionSourceMemfdClass *klass)
+{
+  MetaSelectionSourceClass *source_class = META_SELECTION_SOURCE_CLASS (klass);
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->finalize = meta_selection_source_memfd_finalize;
+
+  source_class->read_async = meta_selection_source_memfd_read_async;
+  source_class->read_finish = meta_selection_source_memfd_read_finish;
+  source_class->get_mimetypes = meta_selection_source_memfd_get_mimetypes;
+}
+
+static void
+meta_selection_source_memfd_init (MetaSelectionSourceMemfd *source)
+{
+  source->fd = -1;
+}
+
+/**
+ * meta_selection_source_memfd_create_fd:
+ * @error: Return location for errors
+ *
+ * Creates an anonymous, memory backed file suitable for storing selection
+ * contents in, to be passed to meta_selection_source_memfd_new() once
+ * filled.
+ *
+ * Returns: the file descriptor, or -1 on error
+ */
+int
+meta_selection_source_memfd_create_fd (GError **error)
+{
+  int fd;
+
+#ifdef HAVE_MEMFD_CREATE
+  fd = memfd_create ("mutter-selection", MFD_CLOEXEC);
+  if (fd == -1)
+    {
+      int errsv = errno;
+
+      g_set_error (error, G_IO_ERROR, g_io_error_from_errno (errsv),
+                   "Failed to create selection storage: %s",
+                   g_strerror (errsv));
+    }
+#else
+  char *path;
+
+  fd = g_file_open_tmp ("mutter-selection-XXXXXX", &path, error);
+  if (fd == -1)
+    return -1;
+
+  unlink (path);
+  g_free (path);
+
+  if (fcntl (fd, F_SETFD, FD_CLOEXEC) == -1)
+    {
+      int errsv = errno;
+
+      g_set_error (error, G_IO_ERROR, g_io_error_from_errno (errsv),
+                   "Failed to create selection storage: %s",
+                   g_strerror (errsv));
+      close (fd);
+      return -1;
+    }
+#endif
+
+  return fd;
+}
+
+/**
+ * meta_selection_source_memfd_new:
+ * @mimetype: Mimetype of the contents
+ * @fd: File holding the contents, as returned by
+ *   meta_selection_source_memfd_create_fd()
+ *
+ * Creates a selection source serving the contents of @fd. Ownership of @fd
+ * is transferred to the source.
+ *
+ * Returns: (transfer full): a new #MetaSelectionSource
+ */
+MetaSelectionSource *
+meta_selection_source_memfd_new (const char *mimetype,
+                                 int         fd)
+{
+  MetaSelectionSourceMemfd *source;
+
+  g_return_val_if_fail (mimetype != NULL, NULL);
+  g_return_val_if_fail (fd >= 0, NULL);
+
+  source = g_object_new (META_TYPE_SELECTION_SOURCE_MEMFD, NULL);
+  source->mimetype = g_strdup (mimetype);
+  source->fd = fd;
+
+  return META_SELECTION_SOURCE (source);
+}
@@ -0,0 +1,37 @@
+/*
+ * Copyright (C) 2020 Red Hat
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ */
+
+#ifndef META_SELECTION_SOURCE_MEMFD_H
+#define META_SELECTION_SOURCE_MEMFD_H
+
+#include "meta/meta-selection-source.h"
+
+#define META_TYPE_SELECTION_SOURCE_MEMFD (meta_selection_source_memfd_get_type ())
+
+G_DECLARE_FINAL_TYPE (MetaSelectionSourceMemfd,
+                      meta_selection_source_memfd,
+                      META, SELECTION_SOURCE_MEMFD,
+                      MetaSelectionSource)
+
+int                   meta_selection_source_memfd_create_fd (GError **error);
+
+MetaSelectionSource * meta_selection_source_memfd_new       (const char *mimetype,
+                                                             int         fd);
+
+#endif /* META_SELECTION_SOURCE_MEMFD_H */
@@ -23,6 +23,12 @@
 
 #include "meta/meta-selection.h"
 
+#include <errno.h>
+#include <gio/gfiledescriptorbased.h>
+#include <unistd.h>
+
+#define SPLICE_CHUNK_SIZE (1024 * 1024)
+
 typedef struct TransferRequest TransferRequest;
 
 struct _MetaSelection
@@ -239,6 +245,191 @@ read_cb (GInputStream *stream,
   g_bytes_unref (bytes);
 }
 
+static void
+transfer_streams (GTask *task)
+{
+  TransferRequest *request = g_task_get_task_data (task);
+
+  if (request->len < 0)
+    {
+      g_output_stream_splice_async (request->ostream,
+                                    request->istream,
+                                    G_OUTPUT_STREAM_SPLICE_CLOSE_SOURCE |
+                                    G_OUTPUT_STREAM_SPLICE_CLOSE_TARGET,
+                                    G_PRIORITY_DEFAULT,
+                                    g_task_get_cancellable (task),
+                                    (GAsyncReadyCallback) splice_cb,
+                                    task);
+    }
+  else
+    {
+      g_input_stream_read_bytes_async (request->istream,
+                                       (gsize) request->len,
+                                       G_PRIORITY_DEFAULT,
+                                       g_task_get_cancellable (task),
+                                       (GAsyncReadyCallback) read_cb,
+                                       task);
+    }
+}
+
+static gboolean
+wait_for_fd (int            fd,
+             GIOCondition   condition,
+             GCancellable  *cancellable,
+             GError       **error)
+{
+  GPollFD poll_fds[2];
+  int n_fds = 1;
+  int ret;
+
+  poll_fds[0].fd = fd;
+  poll_fds[0].events = condition;
+
+  if (g_cancellable_make_pollfd (cancellable, &poll_fds[1]))
+    n_fds++;
+
+  do
+    ret = g_poll (poll_fds, n_fds, -1);
+  while (ret < 0 && errno == EINTR);
+
+  if (n_fds > 1)
+    g_cancellable_release_fd (cancellable);
+
+  if (g_cancellable_set_error_if_cancelled (cancellable, error))
+    return FALSE;
+
+  if (ret < 0)
+    {
+      int errsv = errno;
+
+      g_set_error (error, G_IO_ERROR, g_io_error_from_errno (errsv),
+                   "Failed to wait for selection transfer: %s",
+                   g_strerror (errsv));
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+static void
+splice_fds_thread (GTask        *task,
+                   gpointer      source_object,
+                   gpointer      task_data,
+                   GCancellable *cancellable)
+{
+  TransferRequest *request = task_data;
+  gboolean wait_for_output = FALSE;
+  gssize transferred = 0;
+  GError *error = NULL;
+  int in_fd, out_fd;
+
+  in_fd = g_file_descriptor_based_get_fd (G_FILE_DESCRIPTOR_BASED (request->istream));
+  out_fd = g_file_descriptor_based_get_fd (G_FILE_DESCRIPTOR_BASED (request->ostream));
+
+  while (request->len < 0 || transferred < request->len)
+    {
+      size_t chunk_size = SPLICE_CHUNK_SIZE;
+      ssize_t ret;
+      int errsv;
+
+      if (g_cancellable_set_error_if_cancelled (cancellable, &error))
+        {
+          g_task_return_error (task, error);
+          return;
+        }
+
+      if (request->len >= 0)
+        chunk_size = MIN (chunk_size, (size_t) (request->len - transferred));
+
+      ret = splice (in_fd, NULL, out_fd, NULL, chunk_size,
+                    SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+      if (ret > 0)
+        {
+          transferred += ret;
+          wait_for_output = FALSE;
+          continue;
+        }
+      else if (ret == 0)
+        {
+          break;
+        }
+
+      errsv = errno;
+      if (errsv == EINTR)
+        continue;
+
+      if (errsv == EAGAIN)
+        {
+          /*
+           * Either end might be the one blocking, so alternate between
+           * waiting for input to arrive and for output to drain.
+           */
+          if (!wait_for_fd (wait_for_output ? out_fd : in_fd,
+                            wait_for_output ? G_IO_OUT : G_IO_IN,
+                            cancellable, &error))
+            {
+              g_task_return_error (task, error);
+              return;
+            }
+
+          wait_for_output = !wait_for_output;
+          continue;
+        }
+
+      if (errsv == EINVAL && transferred == 0)
+        {
+          /* Neither end is a pipe, let GIO move the data instead */
+          g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                                   "splice() not supported between streams");
+          return;
+        }
+
+      g_task_return_new_error (task, G_IO_ERROR, g_io_error_from_errno (errsv),
+                               "Failed to transfer selection: %s",
+                               g_strerror (errsv));
+      return;
+    }
+
+  g_task_return_int (task, transferred);
+}
+
+static void
+splice_fds_cb (GObject      *object,
+               GAsyncResult *result,
+               gpointer      user_data)
+{
+  GTask *task = user_data;
+  TransferRequest *request = g_task_get_task_data (task);
+  GError *error = NULL;
+
+  if (g_task_propagate_int (G_TASK (result), &error) < 0)
+    {
+      if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED))
+        {
+          g_error_free (error);
+          transfer_streams (task);
+          return;
+        }
+
+      g_task_return_error (task, error);
+      g_object_unref (task);
+      return;
+    }
+
+  g_input_stream_close (request->istream, NULL, NULL);
+  g_output_stream_close (request->ostream, NULL, NULL);
+
+  g_task_return_boolean (task, TRUE);
+  g_object_unref (task);
+}
+
+static gboolean
+can_splice_fds (TransferRequest *request)
+{
+  return (G_IS_FILE_DESCRIPTOR_BASED (request->istream) &&
+          G_IS_FILE_DESCRIPTOR_BASED (request->ostream));
+}
+
 static void
 source_read_cb (MetaSelectionSource *source,
                 GAsyncResult        *result,
@@ -252,31 +443,32 @@ source_read_cb (MetaSelectionSource *source,
   if (!stream)
     {
       g_task_return_error (task, error);
+      g_object_unref (task);
       return;
     }
 
   request = g_task_get_task_data (task);
   request->istream = stream;
 
-  if (request->len < 0)
+  if (can_splice_fds (request))
     {
-      g_output_stream_splice_async (request->ostream,
-                                    request->istream,
-                                    G_OUTPUT_STREAM_SPLICE_CLOSE_SOURCE |
-                                    G_OUTPUT_STREAM_SPLICE_CLOSE_TARGET,
-                                    G_PRIORITY_DEFAULT,
-                                    g_task_get_cancellable (task),
-                                    (GAsyncReadyCallback) splice_cb,
-                                    task);
+      GTask *splice_task;
+
+      /*
+       * Both ends are file descriptors (e.g. Wayland client pipes), let the
+       * kernel move the data without it passing through user space.
+       */
+      splice_task = g_task_new (g_task_get_source_object (task),
+                                g_task_get_cancellable (task),
+                                splice_fds_cb,
+                                task);
+      g_task_set_task_data (splice_task, request, NULL);
+      g_task_run_in_thread (splice_task, splice_fds_thread);
+      g_object_unref (splice_task);
     }
   else
     {
-      g_input_stream_read_bytes_async (request->istream,
-                                       (gsize) request->len,
-                                       G_PRIORITY_DEFAULT,
-                                       g_task_get_cancellable (task),
-                                       (GAsyncReadyCallback) read_cb,
-                                       task);
+      transfer_streams (task);
     }
 }
 
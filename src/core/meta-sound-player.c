@@ -28,20 +28,42 @@
 #define EVENT_SOUNDS_KEY "event-sounds"
 #define THEME_NAME_KEY   "theme-name"
 
+/* Must be a power of two, so the ring indices survive wrapping around */
+#define PLAY_QUEUE_SIZE 16
+
+#define MAX_CACHED_SOUNDS 64
+
 typedef struct _MetaPlayRequest MetaPlayRequest;
+typedef struct _MetaSoundEntry MetaSoundEntry;
 
 struct _MetaSoundPlayer
 {
   GObject parent;
-  GThreadPool *queue;
+  GThreadPool *pool;
   GSettings *settings;
   ca_context *context;
   uint32_t id_pool;
+
+  /* Sound key -> MetaSoundEntry, only accessed from the main thread */
+  GHashTable *sounds;
+
+  /* Single producer (main thread), single consumer (pool thread) ring */
+  MetaPlayRequest *play_queue[PLAY_QUEUE_SIZE];
+  guint play_queue_head;
+  guint play_queue_tail;
+  gint draining;
 };
 
-struct _MetaPlayRequest
+struct _MetaSoundEntry
 {
+  gatomicrefcount ref_count;
   ca_proplist *props;
+  gint n_queued;
+};
+
+struct _MetaPlayRequest
+{
+  MetaSoundEntry *sound;
   uint32_t id;
   gulong cancel_id;
   GCancellable *cancellable;
@@ -59,15 +81,44 @@ const char * const cache_whitelist[] = {
 
 G_DEFINE_TYPE (MetaSoundPlayer, meta_sound_player, G_TYPE_OBJECT)
 
+static MetaSoundEntry *
+meta_sound_entry_new (ca_proplist *props)
+{
+  MetaSoundEntry *sound;
+
+  sound = g_new0 (MetaSoundEntry, 1);
+  g_atomic_ref_count_init (&sound->ref_count);
+  sound->props = props;
+
+  return sound;
+}
+
+static MetaSoundEntry *
+meta_sound_entry_ref (MetaSoundEntry *sound)
+{
+  g_atomic_ref_count_inc (&sound->ref_count);
+  return sound;
+}
+
+static void
+meta_sound_entry_unref (MetaSoundEntry *sound)
+{
+  if (g_atomic_ref_count_dec (&sound->ref_count))
+    {
+      ca_proplist_destroy (sound->props);
+      g_free (sound);
+    }
+}
+
 static MetaPlayRequest *
 meta_play_request_new (MetaSoundPlayer *player,
-                       ca_proplist     *props,
+                       MetaSoundEntry  *sound,
                        GCancellable    *cancellable)
 {
   MetaPlayRequest *req;
 
   req = g_new0 (MetaPlayRequest, 1);
-  req->props = props;
+  req->sound = meta_sound_entry_ref (sound);
   req->player = player;
   g_set_object (&req->cancellable, cancellable);
 
@@ -78,18 +129,65 @@ static void
 meta_play_request_free (MetaPlayRequest *req)
 {
   g_clear_object (&req->cancellable);
-  ca_proplist_destroy (req->props);
+  meta_sound_entry_unref (req->sound);
   g_free (req);
 }
 
+static gboolean
+play_queue_push (MetaSoundPlayer *player,
+                 MetaPlayRequest *req)
+{
+  guint head, tail;
+
+  tail = player->play_queue_tail;
+  head = g_atomic_int_get (&player->play_queue_head);
+  if (tail - head >= PLAY_QUEUE_SIZE)
+    return FALSE;
+
+  player->play_queue[tail % PLAY_QUEUE_SIZE] = req;
+  g_atomic_int_set (&player->play_queue_tail, tail + 1);
+
+  return TRUE;
+}
+
+static MetaPlayRequest *
+play_queue_pop (MetaSoundPlayer *player)
+{
+  MetaPlayRequest *req;
+  guint head, tail;
+
+  head = player->play_queue_head;
+  tail = g_atomic_int_get (&player->play_queue_tail);
+  if (head == tail)
+    return NULL;
+
+  req = player->play_queue[head % PLAY_QUEUE_SIZE];
+  g_atomic_int_set (&player->play_queue_head, head + 1);
+
+  return req;
+}
+
+static gboolean
+play_queue_is_empty (MetaSoundPlayer *player)
+{
+  return (g_atomic_int_get (&player->play_queue_head) ==
+          g_atomic_int_get (&player->play_queue_tail));
+}
+
 static void
 meta_sound_player_finalize (GObject *object)
 {
   MetaSoundPlayer *player = META_SOUND_PLAYER (object);
+  MetaPlayRequest *req;
 
   g_object_unref (player->settings);
-  g_thread_pool_free (player->queue, FALSE, TRUE);
+  g_thread_pool_free (player->pool, FALSE, TRUE);
+
+  while ((req = play_queue_pop (player)))
+    meta_play_request_free (req);
+
   ca_context_destroy (player->context);
+  g_hash_table_unref (player->sounds);
 
   G_OBJECT_CLASS (meta_sound_player_parent_class)->finalize (object);
 }
@@ -131,7 +229,10 @@ play_sound (MetaPlayRequest *req,
 {
   req->id = player->id_pool++;
 
-  if (ca_context_play_full (player->context, req->id, req->props,
+  /* From here on, identical requests are queued again instead of coalesced */
+  g_atomic_int_add (&req->sound->n_queued, -1);
+
+  if (ca_context_play_full (player->context, req->id, req->sound->props,
                             finish_cb, req) != CA_SUCCESS)
     {
       meta_play_request_free (req);
@@ -146,6 +247,99 @@ play_sound (MetaPlayRequest *req,
     }
 }
 
+static void
+drain_play_queue (gpointer         data,
+                  MetaSoundPlayer *player)
+{
+  MetaPlayRequest *req;
+
+  while (TRUE)
+    {
+      while ((req = play_queue_pop (player)))
+        play_sound (req, player);
+
+      g_atomic_int_set (&player->draining, FALSE);
+
+      /* Requests pushed after the queue was found empty may not have
+       * kicked the pool, pick them up unless another drain already did.
+       */
+      if (play_queue_is_empty (player) ||
+          !g_atomic_int_compare_and_exchange (&player->draining, FALSE, TRUE))
+        break;
+    }
+}
+
+static void
+queue_sound (MetaSoundPlayer *player,
+             MetaSoundEntry  *sound,
+             GCancellable    *cancellable)
+{
+  MetaPlayRequest *req;
+
+  /* Requests that can be cancelled individually are never merged */
+  if (!cancellable && g_atomic_int_get (&sound->n_queued) > 0)
+    return;
+
+  req = meta_play_request_new (player, sound, cancellable);
+  g_atomic_int_inc (&sound->n_queued);
+
+  if (!play_queue_push (player, req))
+    {
+      /* Too many sounds in flight, dropping this one is preferable */
+      g_atomic_int_add (&sound->n_queued, -1);
+      meta_play_request_free (req);
+      return;
+    }
+
+  if (g_atomic_int_compare_and_exchange (&player->draining, FALSE, TRUE))
+    g_thread_pool_push (player->pool, player, NULL);
+}
+
+static void
+build_ca_proplist (ca_proplist  *props,
+                   const char   *event_property,
+                   const char   *event_id,
+                   const char   *event_description)
+{
+  ca_proplist_sets (props, event_property, event_id);
+  ca_proplist_sets (props, CA_PROP_EVENT_DESCRIPTION, event_description);
+}
+
+static MetaSoundEntry *
+lookup_sound (MetaSoundPlayer *player,
+              const char      *event_property,
+              const char      *event_id,
+              const char      *event_description,
+              const char      *cache_control)
+{
+  MetaSoundEntry *sound;
+  ca_proplist *props;
+  char *key;
+
+  key = g_strdup_printf ("%s\x1f%s\x1f%s", event_property, event_id,
+                         event_description ? event_description : "");
+
+  sound = g_hash_table_lookup (player->sounds, key);
+  if (sound)
+    {
+      g_free (key);
+      return sound;
+    }
+
+  ca_proplist_create (&props);
+  build_ca_proplist (props, event_property, event_id, event_description);
+  ca_proplist_sets (props, CA_PROP_CANBERRA_CACHE_CONTROL, cache_control);
+
+  /* Sounds played from arbitrary files could grow the cache without end */
+  if (g_hash_table_size (player->sounds) >= MAX_CACHED_SOUNDS)
+    g_hash_table_remove_all (player->sounds);
+
+  sound = meta_sound_entry_new (props);
+  g_hash_table_insert (player->sounds, key, sound);
+
+  return sound;
+}
+
 static void
 settings_changed_cb (GSettings       *settings,
                      const char      *key,
@@ -167,6 +361,9 @@ settings_changed_cb (GSettings       *settings,
       ca_context_change_props (player->context, CA_PROP_CANBERRA_XDG_THEME_NAME,
                                theme_name, NULL);
       g_free (theme_name);
+
+      /* Sounds resolve differently in the new theme */
+      g_hash_table_remove_all (player->sounds);
     }
 }
 
@@ -205,8 +402,11 @@ create_context (GSettings *settings)
 static void
 meta_sound_player_init (MetaSoundPlayer *player)
 {
-  player->queue = g_thread_pool_new ((GFunc) play_sound,
-				     player, 1, FALSE, NULL);
+  player->pool = g_thread_pool_new ((GFunc) drain_play_queue,
+                                    player, 1, FALSE, NULL);
+  player->sounds =
+    g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                           (GDestroyNotify) meta_sound_entry_unref);
   player->settings = g_settings_new ("org.gnome.desktop.sound");
   player->context = create_context (player->settings);
 
@@ -214,16 +414,6 @@ meta_sound_player_init (MetaSoundPlayer *player)
                     G_CALLBACK (settings_changed_cb), player);
 }
 
-static void
-build_ca_proplist (ca_proplist  *props,
-                   const char   *event_property,
-                   const char   *event_id,
-                   const char   *event_description)
-{
-  ca_proplist_sets (props, event_property, event_id);
-  ca_proplist_sets (props, CA_PROP_EVENT_DESCRIPTION, event_description);
-}
-
 /**
  * meta_sound_player_play_from_theme:
  * @player: a #MetaSoundPlayer
@@ -239,23 +429,21 @@ meta_sound_player_play_from_theme (MetaSoundPlayer *player,
                                    const char      *description,
                                    GCancellable    *cancellable)
 {
-  MetaPlayRequest *req;
-  ca_proplist *props;
+  MetaSoundEntry *sound;
+  const char *cache_control;
 
   g_return_if_fail (META_IS_SOUND_PLAYER (player));
   g_return_if_fail (name != NULL);
   g_return_if_fail (!cancellable || G_IS_CANCELLABLE (cancellable));
 
-  ca_proplist_create (&props);
-  build_ca_proplist (props, CA_PROP_EVENT_ID, name, description);
-
   if (g_strv_contains (cache_whitelist, name))
-    ca_proplist_sets (props, CA_PROP_CANBERRA_CACHE_CONTROL, "permanent");
+    cache_control = "permanent";
   else
-    ca_proplist_sets (props, CA_PROP_CANBERRA_CACHE_CONTROL, "volatile");
+    cache_control = "volatile";
 
-  req = meta_play_request_new (player, props, cancellable);
-  g_thread_pool_push (player->queue, req, NULL);
+  sound = lookup_sound (player, CA_PROP_EVENT_ID, name, description,
+                        cache_control);
+  queue_sound (player, sound, cancellable);
 }
 
 /**
@@ -273,8 +461,7 @@ meta_sound_player_play_from_file (MetaSoundPlayer *player,
                                   const char      *description,
                                   GCancellable    *cancellable)
 {
-  MetaPlayRequest *req;
-  ca_proplist *props;
+  MetaSoundEntry *sound;
   char *path;
 
   g_return_if_fail (META_IS_SOUND_PLAYER (player));
@@ -284,11 +471,8 @@ meta_sound_player_play_from_file (MetaSoundPlayer *player,
   path = g_file_get_path (file);
   g_return_if_fail (path != NULL);
 
-  ca_proplist_create (&props);
-  build_ca_proplist (props, CA_PROP_MEDIA_FILENAME, path, description);
-  ca_proplist_sets (props, CA_PROP_CANBERRA_CACHE_CONTROL, "volatile");
+  sound = lookup_sound (player, CA_PROP_MEDIA_FILENAME, path, description,
+                        "volatile");
+  queue_sound (player, sound, cancellable);
   g_free (path);
-
-  req = meta_play_request_new (player, props, cancellable);
-  g_thread_pool_push (player->queue, req, NULL);
 }
@@ -0,0 +1,350 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+
+/*
+ * Copyright (C) 2020 Red Hat
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * The startup scheduler runs the initialisation steps of the compositor
+ * as a small dependency graph. Tasks flagged with
+ * META_STARTUP_TASK_FLAG_THREAD only touch state of their own and are
+ * run on a thread pool as soon as their dependencies are done; every other
+ * task runs on the main thread, in the order they were added. The main
+ * loop is not iterated while the scheduler runs, so no events or D-Bus
+ * calls are dispatched before startup has completed.
+ */
+
+#include "config.h"
+
+#include "core/meta-startup-scheduler.h"
+
+#include <gio/gio.h>
+
+#include "backends/meta-backend-private.h"
+#include "core/util-private.h"
+
+typedef struct _MetaStartupTask
+{
+  char *name;
+  MetaStartupTaskFlags flags;
+  MetaStartupTaskFunc func;
+  gpointer user_data;
+
+  GPtrArray *dependents;
+  int n_pending_dependencies;
+
+  int64_t begin_time_us;
+  int64_t end_time_us;
+  GError *error;
+} MetaStartupTask;
+
+struct _MetaStartupScheduler
+{
+  GPtrArray *tasks;
+  GHashTable *tasks_by_name;
+
+  GQueue ready_tasks;
+  int n_running_thread_tasks;
+
+  GMutex mutex;
+  GCond cond;
+  GQueue finished_thread_tasks;
+};
+
+static void
+meta_startup_task_free (MetaStartupTask *task)
+{
+  g_clear_error (&task->error);
+  g_ptr_array_free (task->dependents, TRUE);
+  g_free (task->name);
+  g_free (task);
+}
+
+static void
+run_task (MetaStartupTask *task)
+{
+  task->begin_time_us = g_get_monotonic_time ();
+  if (!task->func (task->user_data, &task->error))
+    {
+      if (!task->error)
+        {
+          g_set_error (&task->error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                       "Startup task '%s' failed", task->name);
+        }
+    }
+  task->end_time_us = g_get_monotonic_time ();
+}
+
+static void
+run_thread_task (gpointer data,
+                 gpointer user_data)
+{
+  MetaStartupTask *task = data;
+  MetaStartupScheduler *scheduler = user_data;
+
+  run_task (task);
+
+  g_mutex_lock (&scheduler->mutex);
+  g_queue_push_tail (&scheduler->finished_thread_tasks, task);
+  g_cond_signal (&scheduler->cond);
+  g_mutex_unlock (&scheduler->mutex);
+}
+
+static void
+dispatch_task (MetaStartupScheduler *scheduler,
+               GThreadPool          *thread_pool,
+               MetaStartupTask      *task)
+{
+  if (task->flags & META_STARTUP_TASK_FLAG_THREAD)
+    {
+      scheduler->n_running_thread_tasks++;
+      g_thread_pool_push (thread_pool, task, NULL);
+    }
+  else
+    {
+      g_queue_push_tail (&scheduler->ready_tasks, task);
+    }
+}
+
+static void
+add_mark (const char *name,
+          int64_t     begin_time_us,
+          int64_t     end_time_us)
+{
+#ifdef HAVE_PROFILER
+  MetaBackend *backend = meta_get_backend ();
+  MetaProfiler *profiler;
+
+  if (!backend)
+    return;
+
+  profiler = meta_backend_get_profiler (backend);
+  if (profiler)
+    meta_profiler_add_mark (profiler, name, begin_time_us, end_time_us);
+#endif
+}
+
+static void
+add_task_mark (MetaStartupTask *task)
+{
+  g_autofree char *name = NULL;
+
+  meta_topic (META_DEBUG_STARTUP,
+              "Startup task '%s' took %.2f ms%s\n",
+              task->name,
+              (task->end_time_us - task->begin_time_us) / 1000.0,
+              task->flags & META_STARTUP_TASK_FLAG_THREAD ?
+              " (threaded)" : "");
+
+  name = g_strdup_printf ("Startup (%s)", task->name);
+  add_mark (name, task->begin_time_us, task->end_time_us);
+}
+
+MetaStartupScheduler *
+meta_startup_scheduler_new (void)
+{
+  MetaStartupScheduler *scheduler;
+
+  scheduler = g_new0 (MetaStartupScheduler, 1);
+  scheduler->tasks =
+    g_ptr_array_new_with_free_func ((GDestroyNotify) meta_startup_task_free);
+  scheduler->tasks_by_name = g_hash_table_new (g_str_hash, g_str_equal);
+  g_queue_init (&scheduler->ready_tasks);
+  g_queue_init (&scheduler->finished_thread_tasks);
+  g_mutex_init (&scheduler->mutex);
+  g_cond_init (&scheduler->cond);
+
+  return scheduler;
+}
+
+void
+meta_startup_scheduler_free (MetaStartupScheduler *scheduler)
+{
+  g_assert (scheduler->n_running_thread_tasks == 0);
+
+  g_cond_clear (&scheduler->cond);
+  g_mutex_clear (&scheduler->mutex);
+  g_queue_clear (&scheduler->finished_thread_tasks);
+  g_queue_clear (&scheduler->ready_tasks);
+  g_hash_table_destroy (scheduler->tasks_by_name);
+  g_ptr_array_free (scheduler->tasks, TRUE);
+  g_free (scheduler);
+}
+
+/**
+ * meta_startup_scheduler_add_task:
+ * @scheduler: a #MetaStartupScheduler
+ * @name: a unique name, also used for the profiler mark
+ * @flags: #MetaStartupTaskFlags
+ * @func: the function doing the work
+ * @user_data: data passed to @func
+ * @first_dependency: name of the first task that must complete before
+ *   this one, followed by more names, terminated by %NULL
+ *
+ * Adds a task to the scheduler. Dependencies must have been added before
+ * the tasks depending on them, which keeps the graph free of cycles.
+ */
+void
+meta_startup_scheduler_add_task (MetaStartupScheduler *scheduler,
+                                 const char           *name,
+                                 MetaStartupTaskFlags  flags,
+                                 MetaStartupTaskFunc   func,
+                                 gpointer              user_data,
+                                 const char           *first_dependency,
+                                 ...)
+{
+  MetaStartupTask *task;
+  const char *dependency_name;
+  va_list args;
+
+  g_return_if_fail (!g_hash_table_contains (scheduler->tasks_by_name, name));
+
+  task = g_new0 (MetaStartupTask, 1);
+  task->name = g_strdup (name);
+  task->flags = flags;
+  task->func = func;
+  task->user_data = user_data;
+  task->dependents = g_ptr_array_new ();
+
+  va_start (args, first_dependency);
+  for (dependency_name = first_dependency;
+       dependency_name;
+       dependency_name = va_arg (args, const char *))
+    {
+      MetaStartupTask *dependency;
+
+      dependency = g_hash_table_lookup (scheduler->tasks_by_name,
+                                        dependency_name);
+      if (!dependency)
+        {
+          g_warning ("Startup task '%s' depends on unknown task '%s'",
+                     name, dependency_name);
+          continue;
+        }
+
+      g_ptr_array_add (dependency->dependents, task);
+      task->n_pending_dependencies++;
+    }
+  va_end (args);
+
+  g_ptr_array_add (scheduler->tasks, task);
+  g_hash_table_insert (scheduler->tasks_by_name, task->name, task);
+}
+
+/**
+ * meta_startup_scheduler_run:
+ * @scheduler: a #MetaStartupScheduler
+ * @error: return location for a #GError
+ *
+ * Runs all tasks and blocks until they have completed. If a task fails, no
+ * further tasks are started; tasks already running on other threads are
+ * waited for before the error of the first failed task is returned.
+ *
+ * Returns: %TRUE if all tasks completed successfully
+ */
+gboolean
+meta_startup_scheduler_run (MetaStartupScheduler  *scheduler,
+                            GError               **error)
+{
+  g_autoptr (GError) local_error = NULL;
+  GThreadPool *thread_pool;
+  int64_t begin_time_us;
+  int64_t end_time_us;
+  unsigned int i;
+
+  begin_time_us = g_get_monotonic_time ();
+
+  thread_pool = g_thread_pool_new (run_thread_task, scheduler,
+                                   g_get_num_processors (), FALSE,
+                                   NULL);
+
+  for (i = 0; i < scheduler->tasks->len; i++)
+    {
+      MetaStartupTask *task = g_ptr_array_index (scheduler->tasks, i);
+
+      if (task->n_pending_dependencies == 0)
+        dispatch_task (scheduler, thread_pool, task);
+    }
+
+  while (TRUE)
+    {
+      MetaStartupTask *task;
+
+      g_mutex_lock (&scheduler->mutex);
+      task = g_queue_pop_head (&scheduler->finished_thread_tasks);
+      g_mutex_unlock (&scheduler->mutex);
+
+      if (task)
+        {
+          scheduler->n_running_thread_tasks--;
+        }
+      else if (!local_error &&
+               (task = g_queue_pop_head (&scheduler->ready_tasks)))
+        {
+          run_task (task);
+        }
+      else if (scheduler->n_running_thread_tasks > 0)
+        {
+          g_mutex_lock (&scheduler->mutex);
+          while (g_queue_is_empty (&scheduler->finished_thread_tasks))
+            g_cond_wait (&scheduler->cond, &scheduler->mutex);
+          task = g_queue_pop_head (&scheduler->finished_thread_tasks);
+          g_mutex_unlock (&scheduler->mutex);
+
+          scheduler->n_running_thread_tasks--;
+        }
+      else
+        {
+          break;
+        }
+
+      add_task_mark (task);
+
+      if (task->error)
+        {
+          if (!local_error)
+            local_error = g_steal_pointer (&task->error);
+          continue;
+        }
+
+      /* After a failure, only the tasks still running are waited for */
+      if (local_error)
+        continue;
+
+      for (i = 0; i < task->dependents->len; i++)
+        {
+          MetaStartupTask *dependent = g_ptr_array_index (task->dependents, i);
+
+          if (--dependent->n_pending_dependencies == 0)
+            dispatch_task (scheduler, thread_pool, dependent);
+        }
+    }
+
+  g_thread_pool_free (thread_pool, FALSE, TRUE);
+
+  end_time_us = g_get_monotonic_time ();
+  meta_topic (META_DEBUG_STARTUP, "Startup took %.2f ms\n",
+              (end_time_us - begin_time_us) / 1000.0);
+  add_mark ("Startup", begin_time_us, end_time_us);
+
+  if (local_error)
+    {
+      g_propagate_error (error, g_steal_pointer (&local_error));
+      return FALSE;
+    }
+
+  return TRUE;
+}
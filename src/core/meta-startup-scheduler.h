@@ -0,0 +1,54 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+
+/*
+ * Copyright (C) 2020 Red Hat
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef META_STARTUP_SCHEDULER_H
+#define META_STARTUP_SCHEDULER_H
+
+#include <glib.h>
+
+typedef enum _MetaStartupTaskFlags
+{
+  META_STARTUP_TASK_FLAG_NONE = 0,
+  META_STARTUP_TASK_FLAG_THREAD = 1 << 0,
+} MetaStartupTaskFlags;
+
+typedef gboolean (* MetaStartupTaskFunc) (gpointer   user_data,
+                                          GError   **error);
+
+typedef struct _MetaStartupScheduler MetaStartupScheduler;
+
+MetaStartupScheduler * meta_startup_scheduler_new (void);
+
+void meta_startup_scheduler_free (MetaStartupScheduler *scheduler);
+
+void meta_startup_scheduler_add_task (MetaStartupScheduler *scheduler,
+                                      const char           *name,
+                                      MetaStartupTaskFlags  flags,
+                                      MetaStartupTaskFunc   func,
+                                      gpointer              user_data,
+                                      const char           *first_dependency,
+                                      ...) G_GNUC_NULL_TERMINATED;
+
+gboolean meta_startup_scheduler_run (MetaStartupScheduler  *scheduler,
+                                     GError               **error);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (MetaStartupScheduler,
+                               meta_startup_scheduler_free)
+
+#endif /* META_STARTUP_SCHEDULER_H */
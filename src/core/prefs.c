@@ -109,6 +109,7 @@ static char *cursor_theme = NULL;
  */
 static int   cursor_size = 24;
 static int   draggable_border_width = 10;
+static int   clipboard_size_limit = 200;
 static int   drag_threshold;
 static gboolean resize_with_right_button = FALSE;
 static gboolean edge_tiling = FALSE;
@@ -494,6 +495,13 @@ static MetaIntPreference preferences_int[] =
       },
       &draggable_border_width
     },
+    {
+      { "clipboard-size-limit",
+        SCHEMA_MUTTER,
+        META_PREF_CLIPBOARD_SIZE_LIMIT,
+      },
+      &clipboard_size_limit
+    },
     {
       { "drag-threshold",
         SCHEMA_MOUSE,
@@ -1695,6 +1703,9 @@ meta_preference_to_string (MetaPreference pref)
 
     case META_PREF_LOCATE_POINTER:
       return "LOCATE_POINTER";
+
+    case META_PREF_CLIPBOARD_SIZE_LIMIT:
+      return "CLIPBOARD_SIZE_LIMIT";
     }
 
   return "(unknown)";
@@ -2146,6 +2157,12 @@ meta_prefs_get_draggable_border_width (void)
   return draggable_border_width;
 }
 
+int
+meta_prefs_get_clipboard_size_limit (void)
+{
+  return clipboard_size_limit;
+}
+
 int
 meta_prefs_get_drag_threshold (void)
 {
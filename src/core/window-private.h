@@ -156,6 +156,14 @@ typedef enum
   META_EDGE_CONSTRAINT_MONITOR = 2,
 } MetaEdgeConstraint;
 
+typedef enum _MetaWindowVisibility
+{
+  META_WINDOW_VISIBILITY_VISIBLE,
+  META_WINDOW_VISIBILITY_PARTIALLY_VISIBLE,
+  META_WINDOW_VISIBILITY_OCCLUDED,
+  META_WINDOW_VISIBILITY_HIDDEN,
+} MetaWindowVisibility;
+
 struct _MetaWindow
 {
   GObject parent_instance;
@@ -425,6 +433,10 @@ struct _MetaWindow
   /* whether focus should be restored on map */
   guint restore_focus_on_map : 1;
 
+  /* how much of the window the compositor last saw on screen; occluded and
+   * hidden windows are suspended */
+  MetaWindowVisibility visibility;
+
   /* if non-NULL, the bounds of the window frame */
   cairo_region_t *frame_bounds;
 
@@ -593,6 +605,8 @@ struct _MetaWindowClass
 
   void (* map)   (MetaWindow *window);
   void (* unmap) (MetaWindow *window);
+
+  void (*suspend_state_changed) (MetaWindow *window);
 };
 
 /* These differ from window->has_foo_func in that they consider
@@ -856,4 +870,9 @@ void meta_window_force_restore_shortcuts (MetaWindow         *window,
 gboolean meta_window_shortcuts_inhibited (MetaWindow         *window,
                                           ClutterInputDevice *source);
 gboolean meta_window_is_stackable (MetaWindow *window);
+
+void meta_window_set_visibility (MetaWindow           *window,
+                                 MetaWindowVisibility  visibility);
+
+gboolean meta_window_is_suspended (MetaWindow *window);
 #endif
@@ -8592,3 +8592,45 @@ meta_window_get_client_type (MetaWindow *window)
 {
   return window->client_type;
 }
+
+/**
+ * meta_window_set_visibility:
+ * @window: a #MetaWindow
+ * @visibility: the #MetaWindowVisibility last seen by the compositor
+ *
+ * Updates how much of @window is on screen. Windows that are occluded or
+ * hidden are considered suspended, and clients are told so whenever that
+ * changes so they can stop producing frames nobody will see.
+ */
+void
+meta_window_set_visibility (MetaWindow           *window,
+                            MetaWindowVisibility  visibility)
+{
+  gboolean was_suspended;
+
+  if (window->visibility == visibility)
+    return;
+
+  was_suspended = meta_window_is_suspended (window);
+  window->visibility = visibility;
+
+  if (was_suspended == meta_window_is_suspended (window))
+    return;
+
+  meta_topic (META_DEBUG_WINDOW_STATE,
+              "Window %s is now %s\n",
+              window->desc, was_suspended ? "resumed" : "suspended");
+
+  if (window->unmanaging)
+    return;
+
+  if (META_WINDOW_GET_CLASS (window)->suspend_state_changed)
+    META_WINDOW_GET_CLASS (window)->suspend_state_changed (window);
+}
+
+gboolean
+meta_window_is_suspended (MetaWindow *window)
+{
+  return (window->visibility == META_WINDOW_VISIBILITY_OCCLUDED ||
+          window->visibility == META_WINDOW_VISIBILITY_HIDDEN);
+}
@@ -66,6 +66,7 @@
  * @META_PREF_CENTER_NEW_WINDOWS: center new windows
  * @META_PREF_DRAG_THRESHOLD: drag threshold
  * @META_PREF_LOCATE_POINTER: show pointer location
+ * @META_PREF_CLIPBOARD_SIZE_LIMIT: clipboard size limit
  */
 
 /* Keep in sync with GSettings schemas! */
@@ -105,6 +106,7 @@ typedef enum
   META_PREF_CENTER_NEW_WINDOWS,
   META_PREF_DRAG_THRESHOLD,
   META_PREF_LOCATE_POINTER,
+  META_PREF_CLIPBOARD_SIZE_LIMIT,
 } MetaPreference;
 
 typedef void (* MetaPrefsChangedFunc) (MetaPreference pref,
@@ -235,6 +237,9 @@ int      meta_prefs_get_draggable_border_width (void);
 META_EXPORT
 int      meta_prefs_get_drag_threshold (void);
 
+META_EXPORT
+int      meta_prefs_get_clipboard_size_limit (void);
+
 /**
  * MetaKeyBindingAction:
  * @META_KEYBINDING_ACTION_NONE: FILLME
@@ -1,6 +1,7 @@
 #define CLUTTER_DISABLE_DEPRECATION_WARNINGS
 #include <clutter/clutter.h>
 
+#include "clutter/clutter-mutter.h"
 #include "tests/clutter-test-utils.h"
 
 #define STAGE_WIDTH  640
@@ -211,6 +212,79 @@ actor_pick (void)
   g_assert (state.pass);
 }
 
+typedef struct _DamageState
+{
+  ClutterActor *stage;
+  ClutterActor *actor;
+  int n_picks;
+} DamageState;
+
+static void
+on_pick (ClutterActor       *actor,
+         ClutterPickContext *pick_context,
+         DamageState        *state)
+{
+  state->n_picks++;
+}
+
+static int
+pick_actor (DamageState *state)
+{
+  ClutterActor *actor;
+
+  actor = clutter_stage_get_actor_at_pos (CLUTTER_STAGE (state->stage),
+                                          CLUTTER_PICK_ALL, 10, 10);
+  g_assert (actor == state->actor);
+
+  return state->n_picks;
+}
+
+static gboolean
+on_damage_idle (gpointer data)
+{
+  DamageState *state = data;
+  cairo_rectangle_int_t damage = { 0, 0, 10, 10 };
+  int n_picks;
+
+  n_picks = pick_actor (state);
+  g_assert_cmpint (n_picks, >, 0);
+
+  /* Picking again at the same position uses the cached pick stack */
+  g_assert_cmpint (pick_actor (state), ==, n_picks);
+
+  /* New contents alone, as when a client commits damage, keep it */
+  clutter_actor_queue_damage_redraw (state->actor, &damage);
+  g_assert_cmpint (pick_actor (state), ==, n_picks);
+
+  /* A regular redraw may have moved the actor, so it picks again */
+  clutter_actor_queue_redraw (state->actor);
+  g_assert_cmpint (pick_actor (state), ==, n_picks + 1);
+
+  clutter_main_quit ();
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+actor_pick_damage (void)
+{
+  DamageState state = { 0 };
+
+  state.stage = clutter_test_get_stage ();
+
+  state.actor = clutter_actor_new ();
+  clutter_actor_set_size (state.actor, 100, 100);
+  clutter_actor_add_child (state.stage, state.actor);
+  g_signal_connect (state.actor, "pick", G_CALLBACK (on_pick), &state);
+
+  clutter_actor_show (state.stage);
+
+  clutter_threads_add_idle (on_damage_idle, &state);
+
+  clutter_main ();
+}
+
 CLUTTER_TEST_SUITE (
   CLUTTER_TEST_UNIT ("/actor/pick", actor_pick)
+  CLUTTER_TEST_UNIT ("/actor/pick/damage", actor_pick_damage)
 )
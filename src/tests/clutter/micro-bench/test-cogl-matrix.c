@@ -0,0 +1,157 @@
+#include <glib.h>
+#include <clutter/clutter.h>
+#include <cogl/cogl.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define N_ITERATIONS 1000000
+#define STACK_DEPTH 8
+
+static int n_iterations = N_ITERATIONS;
+
+static GOptionEntry entries[] = {
+  {
+    "iterations", 'i',
+    0,
+    G_OPTION_ARG_INT, &n_iterations,
+    "Number of iterations of each test", "ITERATIONS"
+  },
+  { NULL }
+};
+
+static void
+report (const char *name,
+        GTimer     *timer)
+{
+  double elapsed = g_timer_elapsed (timer, NULL);
+
+  printf ("%-24s %10.2f ns/op\n", name, elapsed * 1e9 / n_iterations);
+}
+
+static void
+init_general_matrix (CoglMatrix *matrix,
+                     float       seed)
+{
+  float v[16];
+  int i;
+
+  for (i = 0; i < 16; i++)
+    v[i] = 1.0f / (i + seed) + (i % 5 == 0 ? 1.0f : 0.0f);
+
+  cogl_matrix_init_from_array (matrix, v);
+}
+
+static void
+test_multiply (void)
+{
+  CoglMatrix a, b, result;
+  GTimer *timer;
+  int i;
+
+  init_general_matrix (&a, 1.0f);
+  init_general_matrix (&b, 2.0f);
+
+  timer = g_timer_new ();
+  for (i = 0; i < n_iterations; i++)
+    {
+      cogl_matrix_multiply (&result, &a, &b);
+      /* Keep the compiler from hoisting the product out of the loop */
+      a.xw = result.xx * 1e-9f;
+    }
+  report ("multiply", timer);
+  g_timer_destroy (timer);
+}
+
+static void
+test_transform_multiply (void)
+{
+  CoglMatrix matrix;
+  GTimer *timer;
+  int i;
+
+  timer = g_timer_new ();
+  for (i = 0; i < n_iterations; i++)
+    {
+      cogl_matrix_init_identity (&matrix);
+      cogl_matrix_translate (&matrix, i, 2.0f * i, 0.0f);
+      cogl_matrix_rotate (&matrix, 30.0f, 0.0f, 0.0f, 1.0f);
+      cogl_matrix_scale (&matrix, 2.0f, 0.5f, 1.0f);
+    }
+  report ("translate-rotate-scale", timer);
+  g_timer_destroy (timer);
+}
+
+static void
+test_invert (void)
+{
+  CoglMatrix matrix, inverse;
+  GTimer *timer;
+  int i;
+
+  timer = g_timer_new ();
+  for (i = 0; i < n_iterations; i++)
+    {
+      /* Reloading the matrix forces the type and inverse to be recomputed */
+      init_general_matrix (&matrix, 1.0f + (i & 0xff));
+      cogl_matrix_get_inverse (&matrix, &inverse);
+    }
+  report ("invert-general", timer);
+  g_timer_destroy (timer);
+}
+
+static void
+test_stack_get (CoglContext *ctx)
+{
+  CoglMatrixStack *stack;
+  CoglMatrixEntry *entry;
+  CoglMatrix matrix;
+  GTimer *timer;
+  int i;
+
+  stack = cogl_matrix_stack_new (ctx);
+  for (i = 0; i < STACK_DEPTH; i++)
+    {
+      cogl_matrix_stack_translate (stack, i, i, 0.0f);
+      cogl_matrix_stack_rotate (stack, 10.0f, 0.0f, 0.0f, 1.0f);
+      cogl_matrix_stack_scale (stack, 1.01f, 1.01f, 1.0f);
+    }
+
+  entry = cogl_matrix_stack_get_entry (stack);
+
+  timer = g_timer_new ();
+  for (i = 0; i < n_iterations; i++)
+    cogl_matrix_entry_get (entry, &matrix);
+  report ("matrix-stack-get", timer);
+  g_timer_destroy (timer);
+
+  cogl_object_unref (stack);
+}
+
+int
+main (int argc, char *argv[])
+{
+  ClutterBackend *backend;
+  CoglContext *ctx;
+  GError *error = NULL;
+
+  if (clutter_init_with_args (&argc, &argv,
+                              NULL,
+                              entries,
+                              NULL,
+                              &error) != CLUTTER_INIT_SUCCESS)
+    {
+      g_warning ("Failed to initialize clutter: %s", error->message);
+      g_error_free (error);
+      return EXIT_FAILURE;
+    }
+
+  backend = clutter_get_default_backend ();
+  ctx = clutter_backend_get_cogl_context (backend);
+
+  test_multiply ();
+  test_transform_multiply ();
+  test_invert ();
+  test_stack_get (ctx);
+
+  return EXIT_SUCCESS;
+}
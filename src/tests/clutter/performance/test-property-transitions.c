@@ -0,0 +1,136 @@
+#include <stdlib.h>
+#include <clutter/clutter.h>
+#include "test-common.h"
+
+#define STAGE_WIDTH  800
+#define STAGE_HEIGHT 600
+
+#define ACTOR_SIZE   16
+
+#define COLS  (STAGE_WIDTH / (ACTOR_SIZE * 2))
+#define ROWS  (STAGE_HEIGHT / (ACTOR_SIZE * 2))
+#define TOTAL (ROWS * COLS)
+
+#define DURATION_MS 1000
+
+static guint n_notifies = 0;
+
+static void
+on_notify (GObject    *gobject,
+           GParamSpec *pspec,
+           gpointer    data)
+{
+  n_notifies++;
+}
+
+static void
+add_transition (ClutterActor *actor,
+                const char   *property_name,
+                GType         value_type,
+                double        from,
+                double        to,
+                guint         delay)
+{
+  ClutterTransition *transition;
+  GValue from_value = G_VALUE_INIT;
+  GValue to_value = G_VALUE_INIT;
+
+  g_value_init (&from_value, G_TYPE_DOUBLE);
+  g_value_init (&to_value, G_TYPE_DOUBLE);
+  g_value_set_double (&from_value, from);
+  g_value_set_double (&to_value, to);
+
+  transition = clutter_property_transition_new (property_name);
+  clutter_transition_set_interval (transition,
+                                   clutter_interval_new_with_values (value_type,
+                                                                     NULL,
+                                                                     NULL));
+  clutter_transition_set_from_value (transition, &from_value);
+  clutter_transition_set_to_value (transition, &to_value);
+
+  clutter_timeline_set_duration (CLUTTER_TIMELINE (transition), DURATION_MS);
+  clutter_timeline_set_delay (CLUTTER_TIMELINE (transition), delay);
+  clutter_timeline_set_repeat_count (CLUTTER_TIMELINE (transition), -1);
+  clutter_timeline_set_auto_reverse (CLUTTER_TIMELINE (transition), TRUE);
+  clutter_timeline_set_progress_mode (CLUTTER_TIMELINE (transition),
+                                      CLUTTER_EASE_IN_OUT_QUAD);
+
+  clutter_actor_add_transition (actor, property_name, transition);
+  g_object_unref (transition);
+
+  g_value_unset (&from_value);
+  g_value_unset (&to_value);
+}
+
+static ClutterActor *
+new_actor (int row,
+           int col)
+{
+  ClutterColor color = { 0xff * col / COLS, 0x80, 0xff * row / ROWS, 0xff };
+  ClutterActor *actor;
+  guint delay;
+
+  actor = clutter_actor_new ();
+  clutter_actor_set_background_color (actor, &color);
+  clutter_actor_set_size (actor, ACTOR_SIZE, ACTOR_SIZE);
+  clutter_actor_set_position (actor,
+                              col * ACTOR_SIZE * 2 + ACTOR_SIZE / 2,
+                              row * ACTOR_SIZE * 2 + ACTOR_SIZE / 2);
+  clutter_actor_set_pivot_point (actor, 0.5, 0.5);
+
+  /* Something listening to the actor, as in an overview */
+  g_signal_connect (actor, "notify", G_CALLBACK (on_notify), NULL);
+
+  /* Stagger the transitions so they don't all line up */
+  delay = (row * COLS + col) % 50;
+
+  add_transition (actor, "opacity", G_TYPE_UINT, 64, 255, delay);
+  add_transition (actor, "scale-x", G_TYPE_DOUBLE, 0.5, 1.5, delay);
+  add_transition (actor, "scale-y", G_TYPE_DOUBLE, 0.5, 1.5, delay);
+  add_transition (actor, "translation-x", G_TYPE_FLOAT,
+                  -ACTOR_SIZE / 2, ACTOR_SIZE / 2, delay);
+  add_transition (actor, "translation-y", G_TYPE_FLOAT,
+                  -ACTOR_SIZE / 2, ACTOR_SIZE / 2, delay);
+
+  return actor;
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  ClutterActor *stage;
+  GTimer *timer;
+  int row, col;
+
+  clutter_perf_fps_init ();
+  if (CLUTTER_INIT_SUCCESS != clutter_init (&argc, &argv))
+    g_error ("Failed to initialize Clutter");
+
+  stage = clutter_stage_new ();
+  clutter_stage_set_title (CLUTTER_STAGE (stage), "Property Transitions");
+  clutter_stage_set_color (CLUTTER_STAGE (stage), CLUTTER_COLOR_Black);
+  clutter_actor_set_size (stage, STAGE_WIDTH, STAGE_HEIGHT);
+  g_signal_connect (stage, "destroy", G_CALLBACK (clutter_main_quit), NULL);
+
+  for (row = 0; row < ROWS; row++)
+    for (col = 0; col < COLS; col++)
+      clutter_actor_add_child (stage, new_actor (row, col));
+
+  g_print ("%d actors, %d transitions\n", TOTAL, TOTAL * 5);
+
+  clutter_actor_show (stage);
+
+  timer = g_timer_new ();
+
+  clutter_perf_fps_start (CLUTTER_STAGE (stage));
+  clutter_main ();
+  clutter_perf_fps_report ("test-property-transitions");
+
+  g_print ("@ notifications: %.0f/s\n",
+           n_notifies / g_timer_elapsed (timer, NULL));
+
+  g_timer_destroy (timer);
+
+  return EXIT_SUCCESS;
+}
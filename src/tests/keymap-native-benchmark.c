@@ -0,0 +1,159 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+
+/*
+ * Copyright (C) 2020 Red Hat
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Measures the keyval lookups done by native virtual keyboards when
+ * injecting text, both with the per-layout index already built and when it
+ * has to be rebuilt after the keyboard map was replaced.
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "backends/native/meta-keymap-native.h"
+
+#define N_ITERATIONS 2000
+
+static const char *text =
+  "The quick brown fox jumps over the lazy dog. "
+  "Pack my box with five dozen liquor jugs! "
+  "Sphinx of black quartz, judge my vow? "
+  "0123456789 ~!@#$%^&*()_+-=[]{};':\",./<>?\\|`";
+
+static int n_iterations = N_ITERATIONS;
+static char *layouts = "us,de,fr";
+
+static GOptionEntry entries[] = {
+  {
+    "iterations", 'i',
+    0,
+    G_OPTION_ARG_INT, &n_iterations,
+    "Number of times the text is looked up", "ITERATIONS"
+  },
+  {
+    "layouts", 'l',
+    0,
+    G_OPTION_ARG_STRING, &layouts,
+    "Comma separated XKB layouts of the keymap", "LAYOUTS"
+  },
+  { NULL }
+};
+
+static unsigned int
+lookup_text (MetaKeymapNative   *keymap,
+             xkb_layout_index_t  layout)
+{
+  unsigned int n_found = 0;
+  const char *p;
+
+  for (p = text; *p; p = g_utf8_next_char (p))
+    {
+      uint32_t keyval;
+      uint32_t keycode;
+      uint32_t level;
+
+      keyval = clutter_unicode_to_keysym (g_utf8_get_char (p));
+      if (meta_keymap_native_lookup_keyval (keymap, layout, keyval,
+                                            &keycode, &level))
+        n_found++;
+    }
+
+  return n_found;
+}
+
+static void
+report (const char   *name,
+        unsigned int  n_lookups,
+        double        elapsed)
+{
+  printf ("%s: %u lookups in %f seconds (%.0f lookups/s)\n",
+          name, n_lookups, elapsed, n_lookups / elapsed);
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_autoptr (GOptionContext) context = NULL;
+  g_autoptr (GError) error = NULL;
+  g_autoptr (GTimer) timer = NULL;
+  MetaKeymapNative *keymap;
+  struct xkb_context *xkb_context;
+  struct xkb_keymap *xkb_keymap;
+  struct xkb_rule_names names = { 0 };
+  xkb_layout_index_t n_layouts;
+  unsigned int n_text_keyvals;
+  unsigned int n_found = 0;
+  int i;
+
+  context = g_option_context_new (NULL);
+  g_option_context_add_main_entries (context, entries, NULL);
+  if (!g_option_context_parse (context, &argc, &argv, &error))
+    {
+      g_printerr ("Invalid arguments: %s\n", error->message);
+      return EXIT_FAILURE;
+    }
+
+  names.rules = "evdev";
+  names.model = "pc105";
+  names.layout = layouts;
+
+  xkb_context = xkb_context_new (XKB_CONTEXT_NO_FLAGS);
+  xkb_keymap = xkb_keymap_new_from_names (xkb_context, &names,
+                                          XKB_KEYMAP_COMPILE_NO_FLAGS);
+  xkb_context_unref (xkb_context);
+  if (!xkb_keymap)
+    {
+      g_printerr ("Failed to compile keymap with layouts '%s'\n", layouts);
+      return EXIT_FAILURE;
+    }
+
+  keymap = g_object_new (META_TYPE_KEYMAP_NATIVE, NULL);
+  meta_keymap_native_set_keyboard_map (keymap, xkb_keymap);
+
+  n_layouts = xkb_keymap_num_layouts (xkb_keymap);
+  n_text_keyvals = g_utf8_strlen (text, -1);
+  timer = g_timer_new ();
+
+  /* Indices built on first use, as after every keymap change. */
+  g_timer_start (timer);
+  for (i = 0; i < n_iterations; i++)
+    {
+      meta_keymap_native_set_keyboard_map (keymap, xkb_keymap);
+      n_found += lookup_text (keymap, i % n_layouts);
+    }
+  report ("cold", n_iterations * n_text_keyvals,
+          g_timer_elapsed (timer, NULL));
+
+  /* Indices already built, as while typing. */
+  g_timer_start (timer);
+  for (i = 0; i < n_iterations; i++)
+    n_found += lookup_text (keymap, i % n_layouts);
+  report ("warm", n_iterations * n_text_keyvals,
+          g_timer_elapsed (timer, NULL));
+
+  printf ("%u of %u keyvals found\n",
+          n_found, 2 * n_iterations * n_text_keyvals);
+
+  g_object_unref (keymap);
+  xkb_keymap_unref (xkb_keymap);
+
+  return EXIT_SUCCESS;
+}
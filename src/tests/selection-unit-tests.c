@@ -0,0 +1,375 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+
+/*
+ * Copyright (C) 2019 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "tests/selection-unit-tests.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <gio/gunixinputstream.h>
+#include <gio/gunixoutputstream.h>
+#include <glib-unix.h>
+#include <unistd.h>
+
+#include "meta/meta-selection.h"
+#include "meta/meta-selection-source-memory.h"
+
+#define TEST_MIMETYPE "application/x-mutter-test"
+#define TEST_BLOCK_SIZE (64 * 1024)
+
+struct _MetaTestPipeSource
+{
+  MetaSelectionSource parent;
+
+  gsize size;
+  GThread *writer_thread;
+};
+
+#define META_TYPE_TEST_PIPE_SOURCE (meta_test_pipe_source_get_type ())
+G_DECLARE_FINAL_TYPE (MetaTestPipeSource, meta_test_pipe_source,
+                      META, TEST_PIPE_SOURCE, MetaSelectionSource)
+
+G_DEFINE_TYPE (MetaTestPipeSource, meta_test_pipe_source,
+               META_TYPE_SELECTION_SOURCE)
+
+typedef struct
+{
+  int fd;
+  gsize size;
+} PipeWriter;
+
+typedef struct
+{
+  gsize n_read;
+  gboolean valid;
+} PipeReader;
+
+typedef struct
+{
+  GMainLoop *loop;
+  gboolean done;
+  GError *error;
+} TransferData;
+
+static inline guint8
+pattern_byte (gsize offset)
+{
+  /* Use a prime period, so misplaced pages or chunks don't go unnoticed */
+  return offset % 251;
+}
+
+static void
+fill_pattern (guint8 *buffer,
+              gsize   offset,
+              gsize   len)
+{
+  gsize i;
+
+  for (i = 0; i < len; i++)
+    buffer[i] = pattern_byte (offset + i);
+}
+
+static gpointer
+pipe_writer_thread_func (gpointer user_data)
+{
+  PipeWriter *writer = user_data;
+  guint8 *buffer;
+  gsize offset = 0;
+
+  buffer = g_malloc (TEST_BLOCK_SIZE);
+
+  while (offset < writer->size)
+    {
+      gsize len = MIN (TEST_BLOCK_SIZE, writer->size - offset);
+      gsize written = 0;
+
+      fill_pattern (buffer, offset, len);
+
+      while (written < len)
+        {
+          ssize_t ret;
+
+          ret = write (writer->fd, buffer + written, len - written);
+          if (ret < 0 && errno == EINTR)
+            continue;
+
+          /* The reading end may stop early on sized transfers */
+          if (ret < 0)
+            goto out;
+
+          written += ret;
+        }
+
+      offset += len;
+    }
+
+out:
+  close (writer->fd);
+  g_free (buffer);
+  g_free (writer);
+
+  return NULL;
+}
+
+static void
+meta_test_pipe_source_read_async (MetaSelectionSource *source,
+                                  const char          *mimetype,
+                                  GCancellable        *cancellable,
+                                  GAsyncReadyCallback  callback,
+                                  gpointer             user_data)
+{
+  MetaTestPipeSource *pipe_source = META_TEST_PIPE_SOURCE (source);
+  PipeWriter *writer;
+  GInputStream *stream;
+  GError *error = NULL;
+  GTask *task;
+  int fds[2];
+
+  task = g_task_new (source, cancellable, callback, user_data);
+  g_task_set_source_tag (task, meta_test_pipe_source_read_async);
+
+  if (!g_unix_open_pipe (fds, FD_CLOEXEC, &error))
+    {
+      g_task_return_error (task, error);
+      g_object_unref (task);
+      return;
+    }
+
+  writer = g_new0 (PipeWriter, 1);
+  writer->fd = fds[1];
+  writer->size = pipe_source->size;
+
+  g_assert_null (pipe_source->writer_thread);
+  pipe_source->writer_thread = g_thread_new ("selection test writer",
+                                             pipe_writer_thread_func,
+                                             writer);
+
+  stream = g_unix_input_stream_new (fds[0], TRUE);
+  g_task_return_pointer (task, stream, g_object_unref);
+  g_object_unref (task);
+}
+
+static GInputStream *
+meta_test_pipe_source_read_finish (MetaSelectionSource  *source,
+                                   GAsyncResult         *result,
+                                   GError              **error)
+{
+  g_assert (g_task_get_source_tag (G_TASK (result)) ==
+            meta_test_pipe_source_read_async);
+  return g_task_propagate_pointer (G_TASK (result), error);
+}
+
+static GList *
+meta_test_pipe_source_get_mimetypes (MetaSelectionSource *source)
+{
+  return g_list_prepend (NULL, g_strdup (TEST_MIMETYPE));
+}
+
+static void
+meta_test_pipe_source_finalize (GObject *object)
+{
+  MetaTestPipeSource *pipe_source = META_TEST_PIPE_SOURCE (object);
+
+  g_clear_pointer (&pipe_source->writer_thread, g_thread_join);
+
+  G_OBJECT_CLASS (meta_test_pipe_source_parent_class)->finalize (object);
+}
+
+static void
+meta_test_pipe_source_class_init (MetaTestPipeSourceClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+  MetaSelectionSourceClass *source_class = META_SELECTION_SOURCE_CLASS (klass);
+
+  object_class->finalize = meta_test_pipe_source_finalize;
+
+  source_class->read_async = meta_test_pipe_source_read_async;
+  source_class->read_finish = meta_test_pipe_source_read_finish;
+  source_class->get_mimetypes = meta_test_pipe_source_get_mimetypes;
+}
+
+static void
+meta_test_pipe_source_init (MetaTestPipeSource *pipe_source)
+{
+}
+
+static MetaSelectionSource *
+meta_test_pipe_source_new (gsize size)
+{
+  MetaTestPipeSource *pipe_source;
+
+  pipe_source = g_object_new (META_TYPE_TEST_PIPE_SOURCE, NULL);
+  pipe_source->size = size;
+
+  return META_SELECTION_SOURCE (pipe_source);
+}
+
+static gpointer
+pipe_reader_thread_func (gpointer user_data)
+{
+  int fd = GPOINTER_TO_INT (user_data);
+  PipeReader *reader;
+  guint8 *buffer;
+  gsize offset = 0;
+  gboolean valid = TRUE;
+
+  buffer = g_malloc (TEST_BLOCK_SIZE);
+
+  while (TRUE)
+    {
+      ssize_t ret, i;
+
+      ret = read (fd, buffer, TEST_BLOCK_SIZE);
+      if (ret < 0 && errno == EINTR)
+        continue;
+      if (ret <= 0)
+        {
+          valid = valid && ret == 0;
+          break;
+        }
+
+      for (i = 0; valid && i < ret; i++)
+        valid = buffer[i] == pattern_byte (offset + i);
+
+      offset += ret;
+    }
+
+  close (fd);
+  g_free (buffer);
+
+  reader = g_new0 (PipeReader, 1);
+  reader->n_read = offset;
+  reader->valid = valid;
+
+  return reader;
+}
+
+static void
+transfer_cb (MetaSelection *selection,
+             GAsyncResult  *result,
+             TransferData  *data)
+{
+  meta_selection_transfer_finish (selection, result, &data->error);
+  data->done = TRUE;
+  g_main_loop_quit (data->loop);
+}
+
+static void
+run_transfer (MetaSelectionSource *source,
+              gssize               size,
+              gsize                expected_size)
+{
+  MetaSelection *selection;
+  GOutputStream *output;
+  TransferData data = { 0 };
+  GThread *reader_thread;
+  PipeReader *reader;
+  GError *error = NULL;
+  int fds[2];
+
+  selection = meta_selection_new (NULL);
+  meta_selection_set_owner (selection, META_SELECTION_CLIPBOARD, source);
+
+  g_assert_true (g_unix_open_pipe (fds, FD_CLOEXEC, &error));
+  g_assert_no_error (error);
+
+  data.loop = g_main_loop_new (NULL, FALSE);
+  reader_thread = g_thread_new ("selection test reader",
+                                pipe_reader_thread_func,
+                                GINT_TO_POINTER (fds[0]));
+
+  output = g_unix_output_stream_new (fds[1], TRUE);
+  meta_selection_transfer_async (selection,
+                                 META_SELECTION_CLIPBOARD,
+                                 TEST_MIMETYPE,
+                                 size,
+                                 output,
+                                 NULL,
+                                 (GAsyncReadyCallback) transfer_cb,
+                                 &data);
+  g_object_unref (output);
+
+  if (!data.done)
+    g_main_loop_run (data.loop);
+  g_main_loop_unref (data.loop);
+
+  g_assert_no_error (data.error);
+
+  /* The reader only sees EOF once the transfer dropped the write end */
+  reader = g_thread_join (reader_thread);
+  g_assert_true (reader->valid);
+  g_assert_cmpuint (reader->n_read, ==, expected_size);
+  g_free (reader);
+
+  meta_selection_unset_owner (selection, META_SELECTION_CLIPBOARD, source);
+  g_object_unref (selection);
+}
+
+static void
+meta_test_selection_transfer_splice (void)
+{
+  MetaSelectionSource *source;
+  gsize size = 256 * 1024 * 1024;
+
+  source = meta_test_pipe_source_new (size);
+  run_transfer (source, -1, size);
+  g_object_unref (source);
+}
+
+static void
+meta_test_selection_transfer_splice_sized (void)
+{
+  MetaSelectionSource *source;
+  gsize size = 4 * 1024 * 1024;
+
+  source = meta_test_pipe_source_new (size);
+  run_transfer (source, size / 4 + 3, size / 4 + 3);
+  g_object_unref (source);
+}
+
+static void
+meta_test_selection_transfer_memory (void)
+{
+  MetaSelectionSource *source;
+  GBytes *bytes;
+  guint8 *buffer;
+  gsize size = 16 * 1024 * 1024;
+
+  /* Memory sources aren't fd backed, this takes the GIO fallback */
+  buffer = g_malloc (size);
+  fill_pattern (buffer, 0, size);
+  bytes = g_bytes_new_take (buffer, size);
+
+  source = meta_selection_source_memory_new (TEST_MIMETYPE, bytes);
+  run_transfer (source, -1, size);
+  g_object_unref (source);
+  g_bytes_unref (bytes);
+}
+
+void
+init_selection_tests (void)
+{
+  g_test_add_func ("/core/selection/transfer/splice",
+                   meta_test_selection_transfer_splice);
+  g_test_add_func ("/core/selection/transfer/splice-sized",
+                   meta_test_selection_transfer_splice_sized);
+  g_test_add_func ("/core/selection/transfer/memory",
+                   meta_test_selection_transfer_memory);
+}
@@ -52,6 +52,60 @@ window_export_handle_cb (GdkWindow  *window,
   gdk_window_set_modal_hint (gdk_window, TRUE);
 }
 
+static gboolean
+animate_tick_cb (GtkWidget     *window,
+                 GdkFrameClock *frame_clock,
+                 gpointer       user_data)
+{
+  gtk_widget_queue_draw (window);
+
+  return G_SOURCE_CONTINUE;
+}
+
+static gboolean
+animate_draw_cb (GtkWidget *window,
+                 cairo_t   *cr,
+                 gpointer   user_data)
+{
+  GdkFrameClock *frame_clock = gtk_widget_get_frame_clock (window);
+  gint64 frame = gdk_frame_clock_get_frame_counter (frame_clock);
+
+  /* Change the contents every frame, so each commit carries new damage */
+  cairo_set_source_rgb (cr, (frame % 64) / 63.0, 0.5, 1.0 - (frame % 64) / 63.0);
+  cairo_paint (cr);
+
+  return TRUE;
+}
+
+static void
+window_set_animated (GtkWidget *window,
+                     gboolean   animated)
+{
+  guint tick_id;
+
+  tick_id = GPOINTER_TO_UINT (g_object_get_data (G_OBJECT (window),
+                                                 "animate-tick-id"));
+  if (animated == (tick_id != 0))
+    return;
+
+  if (animated)
+    {
+      tick_id = gtk_widget_add_tick_callback (window, animate_tick_cb,
+                                              NULL, NULL);
+      g_signal_connect (window, "draw", G_CALLBACK (animate_draw_cb), NULL);
+    }
+  else
+    {
+      gtk_widget_remove_tick_callback (window, tick_id);
+      g_signal_handlers_disconnect_by_func (window, animate_draw_cb, NULL);
+      tick_id = 0;
+      gtk_widget_queue_draw (window);
+    }
+
+  g_object_set_data (G_OBJECT (window), "animate-tick-id",
+                     GUINT_TO_POINTER (tick_id));
+}
+
 static GtkWidget *
 lookup_window (const char *window_id)
 {
@@ -567,6 +621,23 @@ process_line (const char *line)
       int height = atoi (argv[3]);
       gtk_window_resize (GTK_WINDOW (window), width, height);
     }
+  else if (strcmp (argv[0], "animate") == 0)
+    {
+      if (argc != 3 ||
+          (g_ascii_strcasecmp (argv[2], "true") != 0 &&
+           g_ascii_strcasecmp (argv[2], "false") != 0))
+        {
+          g_print ("usage: animate <id> [true|false]");
+          goto out;
+        }
+
+      GtkWidget *window = lookup_window (argv[1]);
+      if (!window)
+        goto out;
+
+      window_set_animated (window,
+                           g_ascii_strcasecmp (argv[2], "true") == 0);
+    }
   else if (strcmp (argv[0], "raise") == 0)
     {
       if (argc != 2)
@@ -20,13 +20,18 @@
 #include "config.h"
 
 #include <gio/gio.h>
+#include <json-glib/json-glib.h>
+#include <math.h>
 #include <stdarg.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 
 #include "compositor/meta-plugin-manager.h"
 #include "core/window-private.h"
 #include "meta/main.h"
+#include "meta/meta-backend.h"
 #include "meta/util.h"
 #include "meta/window.h"
 #include "tests/test-utils.h"
@@ -34,13 +39,32 @@
 #include "wayland/meta-wayland.h"
 #include "x11/meta-x11-display-private.h"
 
+#define BENCHMARK_INPUT_INTERVAL_MS 16
+
+typedef struct {
+  GArray *frame_times;
+  GArray *input_latencies;
+
+  gint64 last_paint_us;
+  gint64 input_sent_us;
+  gboolean input_seen;
+  float pointer_x;
+
+  long resident_start_kb;
+  long resident_end_kb;
+} Benchmark;
+
 typedef struct {
+  char *name;
   GHashTable *clients;
   AsyncWaiter *waiter;
   GString *warning_messages;
   GMainLoop *loop;
+  Benchmark *benchmark;
 } TestCase;
 
+static JsonBuilder *benchmark_results;
+
 static gboolean
 test_case_alarm_filter (MetaX11Display        *x11_display,
                         XSyncAlarmNotifyEvent *event,
@@ -62,10 +86,12 @@ test_case_alarm_filter (MetaX11Display        *x11_display,
 }
 
 static TestCase *
-test_case_new (void)
+test_case_new (const char *name)
 {
   TestCase *test = g_new0 (TestCase, 1);
 
+  test->name = g_strdup (name);
+
   meta_x11_display_set_alarm_filter (meta_get_display ()->x11_display,
                                      test_case_alarm_filter, test);
 
@@ -150,6 +176,314 @@ test_case_sleep (TestCase  *test,
       return FALSE;                                                     \
   } G_STMT_END
 
+static void
+benchmark_free (Benchmark *benchmark)
+{
+  g_array_free (benchmark->frame_times, TRUE);
+  g_array_free (benchmark->input_latencies, TRUE);
+  g_free (benchmark);
+}
+
+static long
+read_resident_kb (void)
+{
+  g_autofree char *contents = NULL;
+  long size, resident;
+
+  if (!g_file_get_contents ("/proc/self/statm", &contents, NULL, NULL))
+    return 0;
+
+  if (sscanf (contents, "%ld %ld", &size, &resident) != 2)
+    return 0;
+
+  return resident * (sysconf (_SC_PAGESIZE) / 1024);
+}
+
+static int
+compare_doubles (gconstpointer a,
+                 gconstpointer b)
+{
+  double da = *(const double *) a;
+  double db = *(const double *) b;
+
+  return da < db ? -1 : da > db ? 1 : 0;
+}
+
+/* Nearest-rank percentile; sorts @values in place */
+static double
+get_percentile (GArray *values,
+                double  percentile)
+{
+  unsigned int rank;
+
+  g_assert (values->len > 0);
+
+  g_array_sort (values, compare_doubles);
+
+  rank = (unsigned int) ceil (percentile / 100.0 * values->len);
+  rank = CLAMP (rank, 1, values->len);
+
+  return g_array_index (values, double, rank - 1);
+}
+
+static void
+benchmark_after_paint (ClutterStage *stage,
+                       Benchmark    *benchmark)
+{
+  gint64 now_us = g_get_monotonic_time ();
+  double ms;
+
+  if (benchmark->last_paint_us != 0)
+    {
+      ms = (now_us - benchmark->last_paint_us) / 1000.0;
+      g_array_append_val (benchmark->frame_times, ms);
+    }
+  benchmark->last_paint_us = now_us;
+
+  if (benchmark->input_seen)
+    {
+      ms = (now_us - benchmark->input_sent_us) / 1000.0;
+      g_array_append_val (benchmark->input_latencies, ms);
+
+      benchmark->input_seen = FALSE;
+      benchmark->input_sent_us = 0;
+    }
+}
+
+static gboolean
+benchmark_event_filter (const ClutterEvent *event,
+                        gpointer            user_data)
+{
+  Benchmark *benchmark = user_data;
+
+  if (event->type == CLUTTER_MOTION && benchmark->input_sent_us != 0)
+    benchmark->input_seen = TRUE;
+
+  return CLUTTER_EVENT_PROPAGATE;
+}
+
+static gboolean
+benchmark_send_input (gpointer user_data)
+{
+  Benchmark *benchmark = user_data;
+  ClutterActor *stage = meta_backend_get_stage (meta_get_backend ());
+  ClutterDeviceManager *device_manager;
+  ClutterEvent *event;
+  float width, height;
+
+  /* Only measure one event at a time, until a frame shows it */
+  if (benchmark->input_sent_us != 0)
+    return G_SOURCE_CONTINUE;
+
+  device_manager = clutter_device_manager_get_default ();
+  clutter_actor_get_size (stage, &width, &height);
+
+  benchmark->pointer_x += 7.0f;
+  if (benchmark->pointer_x >= width)
+    benchmark->pointer_x = 0.0f;
+
+  event = clutter_event_new (CLUTTER_MOTION);
+  event->motion.stage = CLUTTER_STAGE (stage);
+  event->motion.time = g_get_monotonic_time () / 1000;
+  event->motion.x = benchmark->pointer_x;
+  event->motion.y = height / 2;
+  clutter_event_set_device (event,
+                            clutter_device_manager_get_core_device (device_manager,
+                                                                    CLUTTER_POINTER_DEVICE));
+
+  benchmark->input_sent_us = g_get_monotonic_time ();
+  clutter_event_put (event);
+  clutter_event_free (event);
+
+  return G_SOURCE_CONTINUE;
+}
+
+static void
+add_percentiles (JsonBuilder *builder,
+                 const char  *name,
+                 GArray      *values)
+{
+  json_builder_set_member_name (builder, name);
+  json_builder_begin_object (builder);
+
+  json_builder_set_member_name (builder, "samples");
+  json_builder_add_int_value (builder, values->len);
+
+  if (values->len > 0)
+    {
+      json_builder_set_member_name (builder, "p50");
+      json_builder_add_double_value (builder, get_percentile (values, 50));
+      json_builder_set_member_name (builder, "p90");
+      json_builder_add_double_value (builder, get_percentile (values, 90));
+      json_builder_set_member_name (builder, "p99");
+      json_builder_add_double_value (builder, get_percentile (values, 99));
+      json_builder_set_member_name (builder, "max");
+      json_builder_add_double_value (builder, get_percentile (values, 100));
+    }
+
+  json_builder_end_object (builder);
+}
+
+static void
+benchmark_report (TestCase  *test,
+                  Benchmark *benchmark,
+                  guint32    duration)
+{
+  long memory_growth_kb =
+    benchmark->resident_end_kb - benchmark->resident_start_kb;
+
+  g_print ("# %s: %u frames, %u input events, %+ld kB resident in %u ms\n",
+           test->name,
+           benchmark->frame_times->len,
+           benchmark->input_latencies->len,
+           memory_growth_kb,
+           duration);
+
+  json_builder_begin_object (benchmark_results);
+
+  json_builder_set_member_name (benchmark_results, "test");
+  json_builder_add_string_value (benchmark_results, test->name);
+  json_builder_set_member_name (benchmark_results, "duration-ms");
+  json_builder_add_int_value (benchmark_results, duration);
+  json_builder_set_member_name (benchmark_results, "clients");
+  json_builder_add_int_value (benchmark_results,
+                              g_hash_table_size (test->clients));
+
+  add_percentiles (benchmark_results, "frame-time-ms",
+                   benchmark->frame_times);
+  add_percentiles (benchmark_results, "input-latency-ms",
+                   benchmark->input_latencies);
+
+  json_builder_set_member_name (benchmark_results, "memory-growth-kb");
+  json_builder_add_int_value (benchmark_results, memory_growth_kb);
+
+  json_builder_end_object (benchmark_results);
+}
+
+static gboolean
+test_case_benchmark (TestCase  *test,
+                     guint32    duration,
+                     GError   **error)
+{
+  ClutterActor *stage = meta_backend_get_stage (meta_get_backend ());
+  Benchmark *benchmark;
+  gulong after_paint_handler_id;
+  guint filter_id;
+  guint input_id;
+
+  benchmark = g_new0 (Benchmark, 1);
+  benchmark->frame_times = g_array_new (FALSE, FALSE, sizeof (double));
+  benchmark->input_latencies = g_array_new (FALSE, FALSE, sizeof (double));
+  benchmark->resident_start_kb = read_resident_kb ();
+
+  g_clear_pointer (&test->benchmark, benchmark_free);
+  test->benchmark = benchmark;
+
+  after_paint_handler_id =
+    g_signal_connect (stage, "after-paint",
+                      G_CALLBACK (benchmark_after_paint), benchmark);
+  filter_id = clutter_event_add_filter (CLUTTER_STAGE (stage),
+                                        benchmark_event_filter,
+                                        NULL, benchmark);
+  input_id = g_timeout_add (BENCHMARK_INPUT_INTERVAL_MS,
+                            benchmark_send_input, benchmark);
+
+  test_case_sleep (test, duration, error);
+
+  g_source_remove (input_id);
+  clutter_event_remove_filter (filter_id);
+  g_signal_handler_disconnect (stage, after_paint_handler_id);
+
+  benchmark->resident_end_kb = read_resident_kb ();
+
+  benchmark_report (test, benchmark, duration);
+
+  return TRUE;
+}
+
+static gboolean
+test_case_assert_percentile (TestCase    *test,
+                             const char  *what,
+                             GArray      *values,
+                             const char  *percentile_str,
+                             const char  *max_str,
+                             GError     **error)
+{
+  double percentile, max, value;
+  char *end;
+
+  percentile = g_ascii_strtod (percentile_str, &end);
+  if (*end != '\0' || percentile <= 0 || percentile > 100)
+    BAD_COMMAND ("invalid percentile %s", percentile_str);
+
+  max = g_ascii_strtod (max_str, &end);
+  if (*end != '\0' || max < 0)
+    BAD_COMMAND ("invalid limit %s", max_str);
+
+  if (values->len == 0)
+    {
+      g_set_error (error, TEST_RUNNER_ERROR, TEST_RUNNER_ERROR_ASSERTION_FAILED,
+                   "%s: no samples were collected", what);
+      return FALSE;
+    }
+
+  value = get_percentile (values, percentile);
+  if (value > max)
+    {
+      g_set_error (error, TEST_RUNNER_ERROR, TEST_RUNNER_ERROR_ASSERTION_FAILED,
+                   "%s: expected p%g <= %g ms, actual=%.2f ms",
+                   what, percentile, max, value);
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+static gboolean
+test_case_spawn_clients (TestCase              *test,
+                         const char            *prefix,
+                         int                    n_clients,
+                         int                    n_windows,
+                         MetaWindowClientType   type,
+                         gboolean               animated,
+                         GError               **error)
+{
+  int i, j;
+
+  for (i = 0; i < n_clients; i++)
+    {
+      g_autofree char *client_id = g_strdup_printf ("%s%d", prefix, i);
+      TestClient *client;
+
+      if (g_hash_table_lookup (test->clients, client_id))
+        BAD_COMMAND ("client %s already exists", client_id);
+
+      client = test_client_new (client_id, type, error);
+      if (!client)
+        return FALSE;
+
+      g_hash_table_insert (test->clients, test_client_get_id (client), client);
+
+      for (j = 0; j < n_windows; j++)
+        {
+          g_autofree char *window_id = g_strdup_printf ("%d", j);
+
+          if (!test_client_do (client, error, "create", window_id, NULL))
+            return FALSE;
+
+          if (!test_client_do (client, error, "show", window_id, NULL))
+            return FALSE;
+
+          if (animated &&
+              !test_client_do (client, error, "animate", window_id, "true",
+                               NULL))
+            return FALSE;
+        }
+    }
+
+  return TRUE;
+}
+
 static TestClient *
 test_case_lookup_client (TestCase *test,
                          char     *client_id,
@@ -426,7 +760,8 @@ test_case_do (TestCase *test,
                            NULL))
         return FALSE;
     }
-  else if (strcmp (argv[0], "accept_focus") == 0)
+  else if (strcmp (argv[0], "accept_focus") == 0 ||
+           strcmp (argv[0], "animate") == 0)
     {
       if (argc != 3 ||
           (g_ascii_strcasecmp (argv[2], "true") != 0 &&
@@ -567,6 +902,100 @@ test_case_do (TestCase *test,
       if (!test_case_sleep (test, (guint32) interval, error))
         return FALSE;
     }
+  else if (strcmp (argv[0], "spawn_clients") == 0)
+    {
+      MetaWindowClientType type;
+      guint64 n_clients, n_windows;
+      gboolean animated = FALSE;
+
+      if (argc < 5 || argc > 6 ||
+          (argc == 6 && strcmp (argv[5], "animated") != 0))
+        BAD_COMMAND("usage: %s <prefix> <n-clients> <n-windows> [wayland|x11] [animated]",
+                    argv[0]);
+
+      if (!g_ascii_string_to_unsigned (argv[2], 10, 1, 1000,
+                                       &n_clients, error) ||
+          !g_ascii_string_to_unsigned (argv[3], 10, 0, 1000,
+                                       &n_windows, error))
+        return FALSE;
+
+      if (strcmp (argv[4], "x11") == 0)
+        type = META_WINDOW_CLIENT_TYPE_X11;
+      else if (strcmp (argv[4], "wayland") == 0)
+        type = META_WINDOW_CLIENT_TYPE_WAYLAND;
+      else
+        BAD_COMMAND("usage: %s <prefix> <n-clients> <n-windows> [wayland|x11] [animated]",
+                    argv[0]);
+
+      animated = argc == 6;
+
+      if (!test_case_spawn_clients (test, argv[1],
+                                    (int) n_clients, (int) n_windows,
+                                    type, animated, error))
+        return FALSE;
+    }
+  else if (strcmp (argv[0], "benchmark") == 0)
+    {
+      guint64 duration;
+
+      if (argc != 2)
+        BAD_COMMAND("usage: %s <milliseconds>", argv[0]);
+
+      if (!g_ascii_string_to_unsigned (argv[1], 10, 1, G_MAXUINT32,
+                                       &duration, error))
+        return FALSE;
+
+      if (!test_case_benchmark (test, (guint32) duration, error))
+        return FALSE;
+    }
+  else if (strcmp (argv[0], "assert_frame_time") == 0 ||
+           strcmp (argv[0], "assert_input_latency") == 0)
+    {
+      gboolean frame_time = strcmp (argv[0], "assert_frame_time") == 0;
+
+      if (argc != 3)
+        BAD_COMMAND("usage: %s <percentile> <max-milliseconds>", argv[0]);
+
+      if (!test->benchmark)
+        BAD_COMMAND("%s needs a preceding benchmark", argv[0]);
+
+      if (!test_case_assert_percentile (test,
+                                        frame_time ? "frame time"
+                                                   : "input latency",
+                                        frame_time ?
+                                        test->benchmark->frame_times :
+                                        test->benchmark->input_latencies,
+                                        argv[1], argv[2],
+                                        error))
+        return FALSE;
+    }
+  else if (strcmp (argv[0], "assert_memory_growth") == 0)
+    {
+      guint64 max_kb;
+      long growth_kb;
+
+      if (argc != 2)
+        BAD_COMMAND("usage: %s <max-kilobytes>", argv[0]);
+
+      if (!test->benchmark)
+        BAD_COMMAND("%s needs a preceding benchmark", argv[0]);
+
+      if (!g_ascii_string_to_unsigned (argv[1], 10, 0, G_MAXINT32,
+                                       &max_kb, error))
+        return FALSE;
+
+      growth_kb = (test->benchmark->resident_end_kb -
+                   test->benchmark->resident_start_kb);
+      if (growth_kb > (long) max_kb)
+        {
+          g_set_error (error, TEST_RUNNER_ERROR,
+                       TEST_RUNNER_ERROR_ASSERTION_FAILED,
+                       "memory growth: expected <= %" G_GUINT64_FORMAT " kB, "
+                       "actual=%ld kB",
+                       max_kb, growth_kb);
+          return FALSE;
+        }
+    }
   else if (strcmp (argv[0], "assert_stacking") == 0)
     {
       if (!test_case_assert_stacking (test, argv + 1, argc - 1, error))
@@ -622,7 +1051,9 @@ test_case_destroy (TestCase *test,
   meta_x11_display_set_alarm_filter (meta_get_display ()->x11_display,
                                      NULL, NULL);
 
+  g_clear_pointer (&test->benchmark, benchmark_free);
   g_hash_table_destroy (test->clients);
+  g_free (test->name);
   g_free (test);
 
   return TRUE;
@@ -634,9 +1065,18 @@ static gboolean
 run_test (const char *filename,
           int         index)
 {
-  TestCase *test = test_case_new ();
+  TestCase *test;
   GError *error = NULL;
 
+  const char *testspos = strstr (filename, "tests/");
+  char *pretty_name;
+  if (testspos)
+    pretty_name = g_strdup (testspos + strlen("tests/"));
+  else
+    pretty_name = g_strdup (filename);
+
+  test = test_case_new (pretty_name);
+
   GFile *file = g_file_new_for_path (filename);
 
   GDataInputStream *in = NULL;
@@ -699,13 +1139,6 @@ run_test (const char *filename,
   GError *cleanup_error = NULL;
   test_case_destroy (test, &cleanup_error);
 
-  const char *testspos = strstr (filename, "tests/");
-  char *pretty_name;
-  if (testspos)
-    pretty_name = g_strdup (testspos + strlen("tests/"));
-  else
-    pretty_name = g_strdup (filename);
-
   if (error || cleanup_error)
     {
       g_print ("not ok %d %s\n", index, pretty_name);
@@ -735,6 +1168,35 @@ run_test (const char *filename,
   return success;
 }
 
+static char *benchmark_output = NULL;
+
+static gboolean
+write_benchmark_results (void)
+{
+  g_autoptr (JsonGenerator) generator = NULL;
+  g_autoptr (JsonNode) root = NULL;
+  GError *error = NULL;
+
+  json_builder_end_array (benchmark_results);
+
+  if (!benchmark_output)
+    return TRUE;
+
+  root = json_builder_get_root (benchmark_results);
+  generator = json_generator_new ();
+  json_generator_set_pretty (generator, TRUE);
+  json_generator_set_root (generator, root);
+
+  if (!json_generator_to_file (generator, benchmark_output, &error))
+    {
+      g_printerr ("Failed to write benchmark results: %s\n", error->message);
+      g_error_free (error);
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
 typedef struct {
   int n_tests;
   char **tests;
@@ -753,6 +1215,9 @@ run_tests (gpointer data)
     if (!run_test (info->tests[i], i + 1))
       success = FALSE;
 
+  if (!write_benchmark_results ())
+    success = FALSE;
+
   meta_quit (success ? 0 : 1);
 
   return FALSE;
@@ -823,6 +1288,12 @@ const GOptionEntry options[] = {
     "Run all installed tests",
     NULL
   },
+  {
+    "benchmark-output", 0, 0, G_OPTION_ARG_FILENAME,
+    &benchmark_output,
+    "Write the results of benchmarks as JSON to FILE",
+    "FILE"
+  },
   { NULL }
 };
 
@@ -900,6 +1371,9 @@ main (int argc, char **argv)
   info.tests = (char **)tests->pdata;
   info.n_tests = tests->len;
 
+  benchmark_results = json_builder_new ();
+  json_builder_begin_array (benchmark_results);
+
   g_idle_add (run_tests, &info);
 
   return meta_run ();
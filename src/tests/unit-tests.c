@@ -33,6 +33,7 @@
 #include "tests/monitor-config-migration-unit-tests.h"
 #include "tests/monitor-unit-tests.h"
 #include "tests/monitor-store-unit-tests.h"
+#include "tests/selection-unit-tests.h"
 #include "tests/test-utils.h"
 #include "wayland/meta-wayland.h"
 
@@ -251,6 +252,7 @@ init_tests (int argc, char **argv)
   init_monitor_config_migration_tests ();
   init_monitor_tests ();
   init_boxes_tests ();
+  init_selection_tests ();
 }
 
 int
@@ -0,0 +1,913 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+
+/*
+ * Copyright (C) 2019 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * A Wayland client that puts load on the compositor using nothing but
+ * wl_shm buffers on xdg_shell toplevels, optionally with subsurface
+ * trees. Every commit is followed by a wl_display.sync, the time until
+ * it is answered is the commit round trip latency.
+ */
+
+#include "config.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <glib.h>
+#include <math.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <wayland-client.h>
+
+#include "xdg-shell-client-protocol.h"
+
+#define N_BUFFERS 3
+#define SUBSURFACE_SIZE 64
+#define RESIZE_STEPS 16
+#define RESIZE_STEP_SIZE 8
+
+typedef enum _DamagePattern
+{
+  DAMAGE_PATTERN_FULL,
+  DAMAGE_PATTERN_PARTIAL,
+  DAMAGE_PATTERN_SCATTERED,
+} DamagePattern;
+
+typedef struct _Buffer
+{
+  struct wl_buffer *buffer;
+  uint32_t *data;
+  size_t size;
+  int width;
+  int height;
+  gboolean busy;
+} Buffer;
+
+typedef struct _Surface
+{
+  struct wl_surface *surface;
+  struct wl_subsurface *subsurface;
+  Buffer buffers[N_BUFFERS];
+} Surface;
+
+typedef struct _Window
+{
+  Surface main;
+  Surface *subsurfaces;
+
+  struct xdg_surface *xdg_surface;
+  struct xdg_toplevel *xdg_toplevel;
+  gboolean configured;
+
+  struct wl_callback *frame_callback;
+  gint64 frame_requested_us;
+
+  gboolean roundtrip_pending;
+  gint64 next_commit_us;
+  uint64_t n_commits;
+} Window;
+
+typedef struct _Roundtrip
+{
+  Window *window;
+  gint64 start_us;
+} Roundtrip;
+
+static struct wl_display *display;
+static struct wl_compositor *compositor;
+static struct wl_subcompositor *subcompositor;
+static struct wl_shm *shm;
+static struct xdg_wm_base *xdg_wm_base;
+
+static int n_windows = 1;
+static int n_subsurfaces = 0;
+static int commit_rate = 0;
+static int duration_ms = 5000;
+static int base_width = 256;
+static int base_height = 256;
+static char *damage_pattern_str = NULL;
+static gboolean no_frame_callbacks = FALSE;
+static gboolean resize_storm = FALSE;
+static gboolean json_output = FALSE;
+
+static DamagePattern damage_pattern = DAMAGE_PATTERN_FULL;
+
+static GArray *roundtrip_latencies;
+static GArray *frame_latencies;
+static uint64_t n_starved;
+static gboolean running = TRUE;
+
+static GOptionEntry options[] = {
+  {
+    "windows", 'w', 0, G_OPTION_ARG_INT, &n_windows,
+    "Number of toplevel windows", "N"
+  },
+  {
+    "subsurfaces", 's', 0, G_OPTION_ARG_INT, &n_subsurfaces,
+    "Number of subsurfaces per window, arranged as a binary tree", "N"
+  },
+  {
+    "rate", 'r', 0, G_OPTION_ARG_INT, &commit_rate,
+    "Commits per second and window, 0 for as fast as allowed", "HZ"
+  },
+  {
+    "duration", 'd', 0, G_OPTION_ARG_INT, &duration_ms,
+    "Duration of the run", "MILLISECONDS"
+  },
+  {
+    "width", 0, 0, G_OPTION_ARG_INT, &base_width,
+    "Width of the windows", "WIDTH"
+  },
+  {
+    "height", 0, 0, G_OPTION_ARG_INT, &base_height,
+    "Height of the windows", "HEIGHT"
+  },
+  {
+    "damage", 0, 0, G_OPTION_ARG_STRING, &damage_pattern_str,
+    "Damage per commit: full, partial or scattered", "PATTERN"
+  },
+  {
+    "no-frame-callbacks", 0, 0, G_OPTION_ARG_NONE, &no_frame_callbacks,
+    "Don't throttle commits with frame callbacks", NULL
+  },
+  {
+    "resize-storm", 0, 0, G_OPTION_ARG_NONE, &resize_storm,
+    "Change the size of the windows with every commit", NULL
+  },
+  {
+    "json", 0, 0, G_OPTION_ARG_NONE, &json_output,
+    "Print the results as JSON", NULL
+  },
+  { NULL }
+};
+
+static int
+create_anonymous_file (size_t size)
+{
+  int fd;
+
+#ifdef HAVE_MEMFD_CREATE
+  fd = memfd_create ("mutter-load-generator", MFD_CLOEXEC);
+  if (fd == -1)
+    return -1;
+#else
+  char *path;
+
+  fd = g_file_open_tmp ("mutter-load-generator-XXXXXX", &path, NULL);
+  if (fd == -1)
+    return -1;
+
+  unlink (path);
+  g_free (path);
+
+  fcntl (fd, F_SETFD, FD_CLOEXEC);
+#endif
+
+  if (ftruncate (fd, size) < 0)
+    {
+      close (fd);
+      return -1;
+    }
+
+  return fd;
+}
+
+static void
+handle_buffer_release (void             *data,
+                       struct wl_buffer *wl_buffer)
+{
+  Buffer *buffer = data;
+
+  buffer->busy = FALSE;
+}
+
+static const struct wl_buffer_listener buffer_listener = {
+  handle_buffer_release,
+};
+
+static void
+buffer_release (Buffer *buffer)
+{
+  if (!buffer->buffer)
+    return;
+
+  wl_buffer_destroy (buffer->buffer);
+  munmap (buffer->data, buffer->size);
+  memset (buffer, 0, sizeof (*buffer));
+}
+
+static gboolean
+buffer_allocate (Buffer *buffer,
+                 int     width,
+                 int     height)
+{
+  struct wl_shm_pool *pool;
+  int stride = width * 4;
+  int fd;
+
+  buffer_release (buffer);
+
+  buffer->size = stride * height;
+  fd = create_anonymous_file (buffer->size);
+  if (fd == -1)
+    {
+      g_printerr ("Failed to create buffer storage: %s\n", g_strerror (errno));
+      return FALSE;
+    }
+
+  buffer->data = mmap (NULL, buffer->size, PROT_READ | PROT_WRITE,
+                       MAP_SHARED, fd, 0);
+  if (buffer->data == MAP_FAILED)
+    {
+      g_printerr ("Failed to map buffer storage: %s\n", g_strerror (errno));
+      buffer->data = NULL;
+      close (fd);
+      return FALSE;
+    }
+
+  pool = wl_shm_create_pool (shm, fd, buffer->size);
+  buffer->buffer = wl_shm_pool_create_buffer (pool, 0, width, height, stride,
+                                              WL_SHM_FORMAT_XRGB8888);
+  wl_buffer_add_listener (buffer->buffer, &buffer_listener, buffer);
+  wl_shm_pool_destroy (pool);
+  close (fd);
+
+  buffer->width = width;
+  buffer->height = height;
+
+  return TRUE;
+}
+
+static Buffer *
+surface_get_free_buffer (Surface *surface,
+                         int      width,
+                         int      height)
+{
+  int i;
+
+  for (i = 0; i < N_BUFFERS; i++)
+    {
+      Buffer *buffer = &surface->buffers[i];
+
+      if (buffer->busy)
+        continue;
+
+      if (!buffer->buffer ||
+          buffer->width != width ||
+          buffer->height != height)
+        {
+          if (!buffer_allocate (buffer, width, height))
+            return NULL;
+        }
+
+      return buffer;
+    }
+
+  return NULL;
+}
+
+static void
+fill_rect (Buffer   *buffer,
+           int       x,
+           int       y,
+           int       width,
+           int       height,
+           uint32_t  color)
+{
+  int i, j;
+
+  x = CLAMP (x, 0, buffer->width);
+  y = CLAMP (y, 0, buffer->height);
+  width = MIN (width, buffer->width - x);
+  height = MIN (height, buffer->height - y);
+
+  for (j = y; j < y + height; j++)
+    {
+      uint32_t *row = buffer->data + j * buffer->width;
+
+      for (i = x; i < x + width; i++)
+        row[i] = color;
+    }
+}
+
+static void
+surface_draw (Surface  *surface,
+              Buffer   *buffer,
+              uint64_t  frame)
+{
+  uint32_t color = 0xff000000 | ((frame * 4) & 0xff) << 16 | 0x8080;
+  int i;
+
+  switch (damage_pattern)
+    {
+    case DAMAGE_PATTERN_FULL:
+      fill_rect (buffer, 0, 0, buffer->width, buffer->height, color);
+      wl_surface_damage_buffer (surface->surface,
+                                0, 0, buffer->width, buffer->height);
+      break;
+
+    case DAMAGE_PATTERN_PARTIAL:
+      {
+        int size = MIN (buffer->width, buffer->height) / 4;
+        int x = (frame * 4) % MAX (buffer->width - size, 1);
+        int y = (frame * 2) % MAX (buffer->height - size, 1);
+
+        fill_rect (buffer, x, y, size, size, color);
+        wl_surface_damage_buffer (surface->surface, x, y, size, size);
+      }
+      break;
+
+    case DAMAGE_PATTERN_SCATTERED:
+      for (i = 0; i < 8; i++)
+        {
+          int x = ((frame + i * 7) * 13) % MAX (buffer->width - 8, 1);
+          int y = ((frame + i * 5) * 11) % MAX (buffer->height - 8, 1);
+
+          fill_rect (buffer, x, y, 8, 8, color);
+          wl_surface_damage_buffer (surface->surface, x, y, 8, 8);
+        }
+      break;
+    }
+}
+
+static gboolean
+surface_update (Surface  *surface,
+                int       width,
+                int       height,
+                uint64_t  frame)
+{
+  Buffer *buffer;
+
+  buffer = surface_get_free_buffer (surface, width, height);
+  if (!buffer)
+    return FALSE;
+
+  surface_draw (surface, buffer, frame);
+
+  wl_surface_attach (surface->surface, buffer->buffer, 0, 0);
+  buffer->busy = TRUE;
+
+  return TRUE;
+}
+
+static void
+handle_roundtrip_done (void               *data,
+                       struct wl_callback *callback,
+                       uint32_t            time)
+{
+  Roundtrip *roundtrip = data;
+  double ms;
+
+  ms = (g_get_monotonic_time () - roundtrip->start_us) / 1000.0;
+  g_array_append_val (roundtrip_latencies, ms);
+
+  roundtrip->window->roundtrip_pending = FALSE;
+
+  wl_callback_destroy (callback);
+  g_free (roundtrip);
+}
+
+static const struct wl_callback_listener roundtrip_listener = {
+  handle_roundtrip_done,
+};
+
+static void
+handle_frame_done (void               *data,
+                   struct wl_callback *callback,
+                   uint32_t            time)
+{
+  Window *window = data;
+  double ms;
+
+  ms = (g_get_monotonic_time () - window->frame_requested_us) / 1000.0;
+  g_array_append_val (frame_latencies, ms);
+
+  wl_callback_destroy (callback);
+  window->frame_callback = NULL;
+}
+
+static const struct wl_callback_listener frame_listener = {
+  handle_frame_done,
+};
+
+static gboolean
+window_can_commit (Window *window,
+                   gint64  now_us)
+{
+  if (!window->configured || window->roundtrip_pending)
+    return FALSE;
+
+  if (window->frame_callback)
+    return FALSE;
+
+  if (commit_rate > 0 && now_us < window->next_commit_us)
+    return FALSE;
+
+  return TRUE;
+}
+
+static void
+window_commit (Window *window,
+               gint64  now_us)
+{
+  Roundtrip *roundtrip;
+  struct wl_callback *callback;
+  int width = base_width;
+  int height = base_height;
+  int i;
+
+  if (resize_storm)
+    {
+      int step = window->n_commits % (RESIZE_STEPS * 2);
+
+      if (step >= RESIZE_STEPS)
+        step = RESIZE_STEPS * 2 - step;
+
+      width += step * RESIZE_STEP_SIZE;
+      height += step * RESIZE_STEP_SIZE;
+    }
+
+  /* Children are synchronized, their state is applied with the toplevel */
+  for (i = n_subsurfaces - 1; i >= 0; i--)
+    {
+      Surface *subsurface = &window->subsurfaces[i];
+
+      if (surface_update (subsurface, SUBSURFACE_SIZE, SUBSURFACE_SIZE,
+                          window->n_commits))
+        wl_surface_commit (subsurface->surface);
+    }
+
+  if (!surface_update (&window->main, width, height, window->n_commits))
+    {
+      n_starved++;
+      return;
+    }
+
+  if (!no_frame_callbacks)
+    {
+      window->frame_callback = wl_surface_frame (window->main.surface);
+      wl_callback_add_listener (window->frame_callback, &frame_listener,
+                                window);
+      window->frame_requested_us = now_us;
+    }
+
+  wl_surface_commit (window->main.surface);
+
+  roundtrip = g_new0 (Roundtrip, 1);
+  roundtrip->window = window;
+  roundtrip->start_us = now_us;
+  callback = wl_display_sync (display);
+  wl_callback_add_listener (callback, &roundtrip_listener, roundtrip);
+  window->roundtrip_pending = TRUE;
+
+  window->n_commits++;
+  if (commit_rate > 0)
+    {
+      window->next_commit_us += G_USEC_PER_SEC / commit_rate;
+      if (window->next_commit_us < now_us)
+        window->next_commit_us = now_us;
+    }
+}
+
+static void
+handle_xdg_surface_configure (void               *data,
+                              struct xdg_surface *xdg_surface,
+                              uint32_t            serial)
+{
+  Window *window = data;
+
+  xdg_surface_ack_configure (xdg_surface, serial);
+  window->configured = TRUE;
+}
+
+static const struct xdg_surface_listener xdg_surface_listener = {
+  handle_xdg_surface_configure,
+};
+
+static void
+handle_xdg_toplevel_configure (void                *data,
+                               struct xdg_toplevel *xdg_toplevel,
+                               int32_t              width,
+                               int32_t              height,
+                               struct wl_array     *states)
+{
+  /* The size is chosen by the generator, not the compositor */
+}
+
+static void
+handle_xdg_toplevel_close (void                *data,
+                           struct xdg_toplevel *xdg_toplevel)
+{
+  running = FALSE;
+}
+
+static const struct xdg_toplevel_listener xdg_toplevel_listener = {
+  handle_xdg_toplevel_configure,
+  handle_xdg_toplevel_close,
+};
+
+static Window *
+window_new (int index)
+{
+  Window *window;
+  g_autofree char *title = NULL;
+  int i;
+
+  window = g_new0 (Window, 1);
+  window->main.surface = wl_compositor_create_surface (compositor);
+  window->xdg_surface = xdg_wm_base_get_xdg_surface (xdg_wm_base,
+                                                     window->main.surface);
+  xdg_surface_add_listener (window->xdg_surface, &xdg_surface_listener,
+                            window);
+  window->xdg_toplevel = xdg_surface_get_toplevel (window->xdg_surface);
+  xdg_toplevel_add_listener (window->xdg_toplevel, &xdg_toplevel_listener,
+                             window);
+
+  title = g_strdup_printf ("load-generator/%d", index);
+  xdg_toplevel_set_title (window->xdg_toplevel, title);
+
+  window->subsurfaces = g_new0 (Surface, n_subsurfaces);
+  for (i = 0; i < n_subsurfaces; i++)
+    {
+      Surface *subsurface = &window->subsurfaces[i];
+      struct wl_surface *parent;
+      int x, y;
+
+      parent = i == 0 ? window->main.surface
+                      : window->subsurfaces[(i - 1) / 2].surface;
+
+      subsurface->surface = wl_compositor_create_surface (compositor);
+      subsurface->subsurface =
+        wl_subcompositor_get_subsurface (subcompositor,
+                                         subsurface->surface,
+                                         parent);
+
+      x = (i % 4) * SUBSURFACE_SIZE / 4;
+      y = (i / 4 % 4) * SUBSURFACE_SIZE / 4;
+      wl_subsurface_set_position (subsurface->subsurface, x, y);
+    }
+
+  wl_surface_commit (window->main.surface);
+
+  return window;
+}
+
+static void
+surface_free (Surface *surface)
+{
+  int i;
+
+  for (i = 0; i < N_BUFFERS; i++)
+    buffer_release (&surface->buffers[i]);
+
+  g_clear_pointer (&surface->subsurface, wl_subsurface_destroy);
+  g_clear_pointer (&surface->surface, wl_surface_destroy);
+}
+
+static void
+window_free (Window *window)
+{
+  int i;
+
+  g_clear_pointer (&window->frame_callback, wl_callback_destroy);
+
+  for (i = n_subsurfaces - 1; i >= 0; i--)
+    surface_free (&window->subsurfaces[i]);
+  g_free (window->subsurfaces);
+
+  g_clear_pointer (&window->xdg_toplevel, xdg_toplevel_destroy);
+  g_clear_pointer (&window->xdg_surface, xdg_surface_destroy);
+  surface_free (&window->main);
+
+  g_free (window);
+}
+
+static void
+handle_xdg_wm_base_ping (void               *data,
+                         struct xdg_wm_base *xdg_wm_base,
+                         uint32_t            serial)
+{
+  xdg_wm_base_pong (xdg_wm_base, serial);
+}
+
+static const struct xdg_wm_base_listener xdg_wm_base_listener = {
+  handle_xdg_wm_base_ping,
+};
+
+static void
+handle_registry_global (void               *data,
+                        struct wl_registry *registry,
+                        uint32_t            id,
+                        const char         *interface,
+                        uint32_t            version)
+{
+  if (strcmp (interface, "wl_compositor") == 0)
+    {
+      compositor = wl_registry_bind (registry, id,
+                                     &wl_compositor_interface, 4);
+    }
+  else if (strcmp (interface, "wl_subcompositor") == 0)
+    {
+      subcompositor = wl_registry_bind (registry, id,
+                                        &wl_subcompositor_interface, 1);
+    }
+  else if (strcmp (interface, "wl_shm") == 0)
+    {
+      shm = wl_registry_bind (registry, id, &wl_shm_interface, 1);
+    }
+  else if (strcmp (interface, "xdg_wm_base") == 0)
+    {
+      xdg_wm_base = wl_registry_bind (registry, id,
+                                      &xdg_wm_base_interface, 1);
+      xdg_wm_base_add_listener (xdg_wm_base, &xdg_wm_base_listener, NULL);
+    }
+}
+
+static void
+handle_registry_global_remove (void               *data,
+                               struct wl_registry *registry,
+                               uint32_t            name)
+{
+}
+
+static const struct wl_registry_listener registry_listener = {
+  handle_registry_global,
+  handle_registry_global_remove,
+};
+
+static int
+compare_doubles (gconstpointer a,
+                 gconstpointer b)
+{
+  double da = *(const double *) a;
+  double db = *(const double *) b;
+
+  return da < db ? -1 : da > db ? 1 : 0;
+}
+
+/* Nearest-rank percentile of sorted @values */
+static double
+get_percentile (GArray *values,
+                double  percentile)
+{
+  unsigned int rank;
+
+  if (values->len == 0)
+    return 0.0;
+
+  rank = (unsigned int) ceil (percentile / 100.0 * values->len);
+  rank = CLAMP (rank, 1, values->len);
+
+  return g_array_index (values, double, rank - 1);
+}
+
+static void
+print_latencies (const char *name,
+                 GArray     *values,
+                 gboolean    last)
+{
+  g_array_sort (values, compare_doubles);
+
+  if (json_output)
+    {
+      printf ("  \"%s\": { \"samples\": %u, \"p50\": %.3f, \"p90\": %.3f, "
+              "\"p99\": %.3f, \"max\": %.3f }%s\n",
+              name, values->len,
+              get_percentile (values, 50),
+              get_percentile (values, 90),
+              get_percentile (values, 99),
+              get_percentile (values, 100),
+              last ? "" : ",");
+    }
+  else
+    {
+      printf ("%-24s %8u samples, p50 %8.3f ms, p90 %8.3f ms, "
+              "p99 %8.3f ms, max %8.3f ms\n",
+              name, values->len,
+              get_percentile (values, 50),
+              get_percentile (values, 90),
+              get_percentile (values, 99),
+              get_percentile (values, 100));
+    }
+}
+
+static void
+print_results (uint64_t n_commits,
+               double   elapsed)
+{
+  if (json_output)
+    {
+      printf ("{\n");
+      printf ("  \"windows\": %d,\n", n_windows);
+      printf ("  \"subsurfaces\": %d,\n", n_subsurfaces);
+      printf ("  \"damage\": \"%s\",\n",
+              damage_pattern_str ? damage_pattern_str : "full");
+      printf ("  \"frame-callbacks\": %s,\n",
+              no_frame_callbacks ? "false" : "true");
+      printf ("  \"resize-storm\": %s,\n", resize_storm ? "true" : "false");
+      printf ("  \"commits\": %" G_GUINT64_FORMAT ",\n", n_commits);
+      printf ("  \"commits-per-second\": %.1f,\n", n_commits / elapsed);
+      printf ("  \"starved\": %" G_GUINT64_FORMAT ",\n", n_starved);
+    }
+  else
+    {
+      printf ("%" G_GUINT64_FORMAT " commits in %.2f s (%.1f/s), "
+              "%" G_GUINT64_FORMAT " starved for buffers\n",
+              n_commits, elapsed, n_commits / elapsed, n_starved);
+    }
+
+  print_latencies ("commit-roundtrip-ms", roundtrip_latencies,
+                   no_frame_callbacks);
+  if (!no_frame_callbacks)
+    print_latencies ("frame-callback-ms", frame_latencies, TRUE);
+
+  if (json_output)
+    printf ("}\n");
+}
+
+static gboolean
+parse_options (int    *argc,
+               char ***argv)
+{
+  g_autoptr (GOptionContext) context = NULL;
+  GError *error = NULL;
+
+  context = g_option_context_new (NULL);
+  g_option_context_set_summary (context,
+                                "Puts load on the Wayland compositor given "
+                                "by WAYLAND_DISPLAY");
+  g_option_context_add_main_entries (context, options, NULL);
+
+  if (!g_option_context_parse (context, argc, argv, &error))
+    {
+      g_printerr ("%s\n", error->message);
+      g_error_free (error);
+      return FALSE;
+    }
+
+  if (g_strcmp0 (damage_pattern_str, "partial") == 0)
+    damage_pattern = DAMAGE_PATTERN_PARTIAL;
+  else if (g_strcmp0 (damage_pattern_str, "scattered") == 0)
+    damage_pattern = DAMAGE_PATTERN_SCATTERED;
+  else if (damage_pattern_str && strcmp (damage_pattern_str, "full") != 0)
+    {
+      g_printerr ("Unknown damage pattern %s\n", damage_pattern_str);
+      return FALSE;
+    }
+
+  if (n_windows < 1 || n_subsurfaces < 0 || commit_rate < 0 ||
+      duration_ms < 1 || base_width < 1 || base_height < 1)
+    {
+      g_printerr ("Invalid arguments\n");
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  struct wl_registry *registry;
+  GPtrArray *windows;
+  gint64 start_us, end_us;
+  uint64_t n_commits = 0;
+  double elapsed;
+  unsigned int i;
+
+  if (!parse_options (&argc, &argv))
+    return EXIT_FAILURE;
+
+  display = wl_display_connect (NULL);
+  if (!display)
+    {
+      g_printerr ("Failed to connect to the Wayland display\n");
+      return EXIT_FAILURE;
+    }
+
+  registry = wl_display_get_registry (display);
+  wl_registry_add_listener (registry, &registry_listener, NULL);
+  wl_display_roundtrip (display);
+
+  if (!compositor || !subcompositor || !shm || !xdg_wm_base)
+    {
+      g_printerr ("Missing required Wayland globals\n");
+      return EXIT_FAILURE;
+    }
+
+  roundtrip_latencies = g_array_new (FALSE, FALSE, sizeof (double));
+  frame_latencies = g_array_new (FALSE, FALSE, sizeof (double));
+
+  windows = g_ptr_array_new_with_free_func ((GDestroyNotify) window_free);
+  for (i = 0; i < (unsigned int) n_windows; i++)
+    g_ptr_array_add (windows, window_new (i));
+
+  /* Wait for the initial configure events before starting the clock */
+  wl_display_roundtrip (display);
+
+  start_us = g_get_monotonic_time ();
+  end_us = start_us + duration_ms * 1000;
+
+  while (running)
+    {
+      gint64 now_us = g_get_monotonic_time ();
+      gint64 next_us = end_us;
+      struct pollfd pfd;
+      int timeout;
+
+      if (now_us >= end_us)
+        break;
+
+      for (i = 0; i < windows->len; i++)
+        {
+          Window *window = g_ptr_array_index (windows, i);
+
+          if (window_can_commit (window, now_us))
+            window_commit (window, now_us);
+
+          if (commit_rate > 0 && window->next_commit_us > now_us)
+            next_us = MIN (next_us, window->next_commit_us);
+        }
+
+      while (wl_display_prepare_read (display) != 0)
+        wl_display_dispatch_pending (display);
+
+      if (wl_display_flush (display) < 0 && errno != EAGAIN)
+        {
+          wl_display_cancel_read (display);
+          g_printerr ("Lost connection to the Wayland display\n");
+          return EXIT_FAILURE;
+        }
+
+      timeout = MAX (0, (int) ((next_us - now_us + 999) / 1000));
+
+      pfd.fd = wl_display_get_fd (display);
+      pfd.events = POLLIN;
+      if (poll (&pfd, 1, timeout) > 0)
+        {
+          if (wl_display_read_events (display) < 0)
+            {
+              g_printerr ("Lost connection to the Wayland display\n");
+              return EXIT_FAILURE;
+            }
+        }
+      else
+        {
+          wl_display_cancel_read (display);
+        }
+
+      if (wl_display_dispatch_pending (display) < 0)
+        {
+          g_printerr ("Lost connection to the Wayland display\n");
+          return EXIT_FAILURE;
+        }
+    }
+
+  elapsed = (g_get_monotonic_time () - start_us) / (double) G_USEC_PER_SEC;
+
+  /* Collect the outstanding round trips, they refer to the windows */
+  wl_display_roundtrip (display);
+
+  for (i = 0; i < windows->len; i++)
+    {
+      Window *window = g_ptr_array_index (windows, i);
+
+      n_commits += window->n_commits;
+    }
+
+  print_results (n_commits, elapsed);
+
+  g_ptr_array_free (windows, TRUE);
+
+  g_array_free (roundtrip_latencies, TRUE);
+  g_array_free (frame_latencies, TRUE);
+
+  xdg_wm_base_destroy (xdg_wm_base);
+  wl_shm_destroy (shm);
+  wl_subcompositor_destroy (subcompositor);
+  wl_compositor_destroy (compositor);
+  wl_registry_destroy (registry);
+  wl_display_disconnect (display);
+
+  return EXIT_SUCCESS;
+}
@@ -293,16 +293,23 @@ meta_wayland_egl_stream_is_y_inverted (MetaWaylandEglStream *stream)
 CoglSnippet *
 meta_wayland_egl_stream_create_snippet (void)
 {
-  CoglSnippet *snippet;
+  static CoglSnippet *snippet = NULL;
 
-  snippet = cogl_snippet_new (COGL_SNIPPET_HOOK_TEXTURE_LOOKUP,
-                              "uniform samplerExternalOES tex_external;",
-                              NULL);
-  cogl_snippet_set_replace (snippet,
-                            "cogl_texel = texture2D (tex_external,\n"
-                            "                        cogl_tex_coord.xy);");
+  /* Cogl tells snippets apart by identity, so share one between all
+   * buffers for them to share a program, instead of compiling one per
+   * commit.
+   */
+  if (!snippet)
+    {
+      snippet = cogl_snippet_new (COGL_SNIPPET_HOOK_TEXTURE_LOOKUP,
+                                  "uniform samplerExternalOES tex_external;",
+                                  NULL);
+      cogl_snippet_set_replace (snippet,
+                                "cogl_texel = texture2D (tex_external,\n"
+                                "                        cogl_tex_coord.xy);");
+    }
 
-  return snippet;
+  return cogl_object_ref (snippet);
 }
 
 gboolean
@@ -23,7 +23,6 @@
 #include "wayland/meta-wayland-subsurface.h"
 
 #include "compositor/meta-surface-actor-wayland.h"
-#include "compositor/meta-window-actor-wayland.h"
 #include "wayland/meta-wayland.h"
 #include "wayland/meta-wayland-actor-surface.h"
 #include "wayland/meta-wayland-buffer.h"
@@ -46,6 +45,15 @@ typedef struct
 struct _MetaWaylandSubsurface
 {
   MetaWaylandActorSurface parent;
+
+  /* Union of the geometry of the surface and its subsurfaces, relative to
+   * the origin of the surface. Invalidated together with the geometry of all
+   * ancestors whenever a surface of the subtree changes size or moves.
+   */
+  gboolean has_cached_geometry;
+  MetaRectangle cached_geometry;
+  int cached_width;
+  int cached_height;
 };
 
 G_DEFINE_TYPE (MetaWaylandSubsurface,
@@ -92,6 +100,29 @@ sync_actor_subsurface_state (MetaWaylandSurface *surface)
     clutter_actor_hide (actor);
 }
 
+static void
+invalidate_geometry (MetaWaylandSurface *surface)
+{
+  while (surface && META_IS_WAYLAND_SUBSURFACE (surface->role))
+    {
+      MetaWaylandSubsurface *subsurface =
+        META_WAYLAND_SUBSURFACE (surface->role);
+
+      /* The ancestors of an invalid cache are never valid. */
+      if (!subsurface->has_cached_geometry)
+        return;
+
+      subsurface->has_cached_geometry = FALSE;
+      surface = surface->sub.parent;
+    }
+}
+
+static void
+invalidate_parent_geometry (MetaWaylandSurface *surface)
+{
+  invalidate_geometry (surface->sub.parent);
+}
+
 static gboolean
 is_child (MetaWaylandSurface *surface,
           MetaWaylandSurface *sibling)
@@ -132,13 +163,14 @@ meta_wayland_subsurface_parent_state_applied (MetaWaylandSubsurface *subsurface)
       surface->sub.x = surface->sub.pending_x;
       surface->sub.y = surface->sub.pending_y;
       surface->sub.pending_pos = FALSE;
+
+      invalidate_parent_geometry (surface);
     }
 
   if (surface->sub.pending_placement_ops)
     {
       GSList *it;
       MetaWaylandSurface *parent;
-      MetaWindowActor *window_actor;
 
       parent = surface->sub.parent;
 
@@ -183,9 +215,7 @@ meta_wayland_subsurface_parent_state_applied (MetaWaylandSubsurface *subsurface)
       g_slist_free (surface->sub.pending_placement_ops);
       surface->sub.pending_placement_ops = NULL;
 
-      window_actor = meta_window_actor_wayland_from_surface (surface);
-      if (window_actor)
-        meta_window_actor_wayland_rebuild_surface_tree (window_actor);
+      meta_wayland_surface_notify_subsurface_tree_changed (surface);
     }
 
   if (is_surface_effectively_synchronized (surface))
@@ -194,11 +224,8 @@ meta_wayland_subsurface_parent_state_applied (MetaWaylandSubsurface *subsurface)
   meta_wayland_actor_surface_sync_actor_state (actor_surface);
 }
 
-void
-meta_wayland_subsurface_union_geometry (MetaWaylandSubsurface *subsurface,
-                                        int                    parent_x,
-                                        int                    parent_y,
-                                        MetaRectangle         *out_geometry)
+static void
+ensure_cached_geometry (MetaWaylandSubsurface *subsurface)
 {
   MetaWaylandSurfaceRole *surface_role = META_WAYLAND_SURFACE_ROLE (subsurface);
   MetaWaylandSurface *surface =
@@ -206,31 +233,59 @@ meta_wayland_subsurface_union_geometry (MetaWaylandSubsurface *subsurface,
   MetaRectangle geometry;
   GNode *n;
 
+  if (subsurface->has_cached_geometry)
+    return;
+
+  subsurface->cached_width = meta_wayland_surface_get_width (surface);
+  subsurface->cached_height = meta_wayland_surface_get_height (surface);
+
   geometry = (MetaRectangle) {
-    .x = surface->offset_x + surface->sub.x,
-    .y = surface->offset_y + surface->sub.y,
-    .width = meta_wayland_surface_get_width (surface),
-    .height = meta_wayland_surface_get_height (surface),
+    .width = subsurface->cached_width,
+    .height = subsurface->cached_height,
   };
 
-  meta_rectangle_union (out_geometry, &geometry, out_geometry);
-
   for (n = g_node_first_child (surface->subsurface_branch_node);
        n;
        n = g_node_next_sibling (n))
     {
-      MetaWaylandSurface *subsurface_surface = n->data;
-      MetaWaylandSubsurface *subsurface;
+      MetaWaylandSurface *child_surface = n->data;
+      MetaWaylandSubsurface *child;
+      MetaRectangle child_geometry;
 
       if (G_NODE_IS_LEAF (n))
         continue;
 
-      subsurface = META_WAYLAND_SUBSURFACE (subsurface_surface->role);
-      meta_wayland_subsurface_union_geometry (subsurface,
-                                              parent_x + geometry.x,
-                                              parent_y + geometry.y,
-                                              out_geometry);
+      child = META_WAYLAND_SUBSURFACE (child_surface->role);
+      ensure_cached_geometry (child);
+
+      child_geometry = child->cached_geometry;
+      child_geometry.x += child_surface->offset_x + child_surface->sub.x;
+      child_geometry.y += child_surface->offset_y + child_surface->sub.y;
+      meta_rectangle_union (&geometry, &child_geometry, &geometry);
     }
+
+  subsurface->cached_geometry = geometry;
+  subsurface->has_cached_geometry = TRUE;
+}
+
+void
+meta_wayland_subsurface_union_geometry (MetaWaylandSubsurface *subsurface,
+                                        int                    parent_x,
+                                        int                    parent_y,
+                                        MetaRectangle         *out_geometry)
+{
+  MetaWaylandSurfaceRole *surface_role = META_WAYLAND_SURFACE_ROLE (subsurface);
+  MetaWaylandSurface *surface =
+    meta_wayland_surface_role_get_surface (surface_role);
+  MetaRectangle geometry;
+
+  ensure_cached_geometry (subsurface);
+
+  geometry = subsurface->cached_geometry;
+  geometry.x += parent_x + surface->offset_x + surface->sub.x;
+  geometry.y += parent_y + surface->offset_y + surface->sub.y;
+
+  meta_rectangle_union (out_geometry, &geometry, out_geometry);
 }
 
 static MetaWaylandSurface *
@@ -246,6 +301,26 @@ meta_wayland_subsurface_get_toplevel (MetaWaylandSurfaceRole *surface_role)
     return NULL;
 }
 
+static void
+meta_wayland_subsurface_apply_state (MetaWaylandSurfaceRole  *surface_role,
+                                     MetaWaylandSurfaceState *pending)
+{
+  MetaWaylandSubsurface *subsurface = META_WAYLAND_SUBSURFACE (surface_role);
+  MetaWaylandSurface *surface =
+    meta_wayland_surface_role_get_surface (surface_role);
+  MetaWaylandSurfaceRoleClass *surface_role_class =
+    META_WAYLAND_SURFACE_ROLE_CLASS (meta_wayland_subsurface_parent_class);
+
+  surface_role_class->apply_state (surface_role, pending);
+
+  if (pending->dx != 0 || pending->dy != 0)
+    invalidate_parent_geometry (surface);
+
+  if (meta_wayland_surface_get_width (surface) != subsurface->cached_width ||
+      meta_wayland_surface_get_height (surface) != subsurface->cached_height)
+    invalidate_geometry (surface);
+}
+
 static gboolean
 meta_wayland_subsurface_should_cache_state (MetaWaylandSurfaceRole *surface_role)
 {
@@ -317,6 +392,7 @@ meta_wayland_subsurface_class_init (MetaWaylandSubsurfaceClass *klass)
     META_WAYLAND_ACTOR_SURFACE_CLASS (klass);
 
   surface_role_class->get_toplevel = meta_wayland_subsurface_get_toplevel;
+  surface_role_class->apply_state = meta_wayland_subsurface_apply_state;
   surface_role_class->should_cache_state = meta_wayland_subsurface_should_cache_state;
 
   actor_surface_class->get_geometry_scale =
@@ -347,6 +423,7 @@ wl_subsurface_destructor (struct wl_resource *resource)
   meta_wayland_compositor_destroy_frame_callbacks (surface->compositor,
                                                    surface);
 
+  invalidate_parent_geometry (surface);
   g_node_unlink (surface->subsurface_branch_node);
   unparent_actor (surface);
 
@@ -524,7 +601,6 @@ wl_subcompositor_get_subsurface (struct wl_client   *client,
   MetaWaylandSurface *surface = wl_resource_get_user_data (surface_resource);
   MetaWaylandSurface *parent = wl_resource_get_user_data (parent_resource);
   MetaWindow *toplevel_window;
-  MetaWindowActor *window_actor;
   MetaSurfaceActor *surface_actor;
 
   if (surface->wl_subsurface)
@@ -569,10 +645,9 @@ wl_subcompositor_get_subsurface (struct wl_client   *client,
 
   g_node_append (parent->subsurface_branch_node,
                  surface->subsurface_branch_node);
+  invalidate_geometry (parent);
 
-  window_actor = meta_window_actor_wayland_from_surface (surface);
-  if (window_actor)
-    meta_window_actor_wayland_rebuild_surface_tree (window_actor);
+  meta_wayland_surface_notify_subsurface_tree_changed (surface);
 
   surface_actor = meta_wayland_surface_get_actor (surface);
   clutter_actor_set_reactive (CLUTTER_ACTOR (surface_actor), TRUE);
@@ -35,6 +35,7 @@
 #include "compositor/meta-surface-actor-wayland.h"
 #include "compositor/meta-surface-actor.h"
 #include "compositor/meta-window-actor-private.h"
+#include "compositor/meta-window-actor-wayland.h"
 #include "compositor/region-utils.h"
 #include "core/display-private.h"
 #include "core/window-private.h"
@@ -73,6 +74,17 @@ enum
 
 static guint surface_state_signals[SURFACE_STATE_SIGNAL_N_SIGNALS];
 
+/* Applying the state of a surface recurses into its synchronized
+ * subsurfaces. Window actor updates caused by any surface of the tree are
+ * collected here and done once the outermost surface has been applied.
+ */
+static struct
+{
+  int depth;
+  gboolean needs_rebuild;
+  gboolean had_damage;
+} tree_commit;
+
 typedef struct _MetaWaylandSurfaceRolePrivate
 {
   MetaWaylandSurface *surface;
@@ -97,6 +109,7 @@ enum
   SURFACE_SHORTCUTS_RESTORED,
   SURFACE_GEOMETRY_CHANGED,
   SURFACE_PRE_STATE_APPLIED,
+  SURFACE_SUSPEND_STATE_CHANGED,
   N_SURFACE_SIGNALS
 };
 
@@ -623,11 +636,53 @@ meta_wayland_surface_cache_pending_frame_callbacks (MetaWaylandSurface      *sur
   wl_list_init (&pending->frame_callback_list);
 }
 
+void
+meta_wayland_surface_notify_subsurface_tree_changed (MetaWaylandSurface *surface)
+{
+  MetaWindowActor *window_actor;
+
+  if (tree_commit.depth > 0)
+    {
+      tree_commit.needs_rebuild = TRUE;
+      return;
+    }
+
+  window_actor = meta_window_actor_wayland_from_surface (surface);
+  if (window_actor)
+    meta_window_actor_wayland_rebuild_surface_tree (window_actor);
+}
+
+static void
+finish_tree_commit (MetaWaylandSurface *surface)
+{
+  gboolean needs_rebuild = tree_commit.needs_rebuild;
+  gboolean had_damage = tree_commit.had_damage;
+  MetaWindow *toplevel_window;
+  MetaWindowActor *toplevel_window_actor;
+
+  tree_commit.needs_rebuild = FALSE;
+  tree_commit.had_damage = FALSE;
+
+  if (needs_rebuild)
+    meta_wayland_surface_notify_subsurface_tree_changed (surface);
+
+  if (!had_damage)
+    return;
+
+  toplevel_window = meta_wayland_surface_get_toplevel_window (surface);
+  if (!toplevel_window)
+    return;
+
+  toplevel_window_actor = meta_window_actor_from_window (toplevel_window);
+  if (toplevel_window_actor)
+    meta_window_actor_notify_damaged (toplevel_window_actor);
+}
+
 static void
 meta_wayland_surface_apply_state (MetaWaylandSurface      *surface,
                                   MetaWaylandSurfaceState *state)
 {
-  gboolean had_damage = FALSE;
+  tree_commit.depth++;
 
   g_signal_emit (surface, surface_signals[SURFACE_PRE_STATE_APPLIED], 0);
 
@@ -741,7 +796,7 @@ meta_wayland_surface_apply_state (MetaWaylandSurface      *surface,
       surface_process_damage (surface,
                               state->surface_damage,
                               state->buffer_damage);
-      had_damage = TRUE;
+      tree_commit.had_damage = TRUE;
     }
 
   surface->offset_x += state->dx;
@@ -807,21 +862,8 @@ cleanup:
                            parent_surface_state_applied,
                            NULL);
 
-  if (had_damage)
-    {
-      MetaWindow *toplevel_window;
-
-      toplevel_window = meta_wayland_surface_get_toplevel_window (surface);
-      if (toplevel_window)
-        {
-          MetaWindowActor *toplevel_window_actor;
-
-          toplevel_window_actor =
-            meta_window_actor_from_window (toplevel_window);
-          if (toplevel_window_actor)
-            meta_window_actor_notify_damaged (toplevel_window_actor);
-        }
-    }
+  if (--tree_commit.depth == 0)
+    finish_tree_commit (surface);
 }
 
 void
@@ -1741,6 +1783,13 @@ meta_wayland_surface_class_init (MetaWaylandSurfaceClass *klass)
                   0, NULL, NULL,
                   g_cclosure_marshal_VOID__VOID,
                   G_TYPE_NONE, 0);
+  surface_signals[SURFACE_SUSPEND_STATE_CHANGED] =
+    g_signal_new ("suspend-state-changed",
+                  G_TYPE_FROM_CLASS (object_class),
+                  G_SIGNAL_RUN_LAST,
+                  0, NULL, NULL,
+                  g_cclosure_marshal_VOID__VOID,
+                  G_TYPE_NONE, 0);
 }
 
 static void
@@ -1965,6 +2014,12 @@ meta_wayland_surface_notify_geometry_changed (MetaWaylandSurface *surface)
   g_signal_emit (surface, surface_signals[SURFACE_GEOMETRY_CHANGED], 0);
 }
 
+void
+meta_wayland_surface_notify_suspend_state_changed (MetaWaylandSurface *surface)
+{
+  g_signal_emit (surface, surface_signals[SURFACE_SUSPEND_STATE_CHANGED], 0);
+}
+
 int
 meta_wayland_surface_get_width (MetaWaylandSurface *surface)
 {
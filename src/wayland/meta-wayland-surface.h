@@ -236,6 +236,8 @@ MetaWaylandSurfaceState *
 
 void                meta_wayland_surface_apply_cached_state (MetaWaylandSurface *surface);
 
+void                meta_wayland_surface_notify_subsurface_tree_changed (MetaWaylandSurface *surface);
+
 gboolean            meta_wayland_surface_is_effectively_synchronized (MetaWaylandSurface *surface);
 
 gboolean            meta_wayland_surface_assign_role (MetaWaylandSurface *surface,
@@ -325,6 +327,8 @@ MetaSurfaceActor *  meta_wayland_surface_get_actor (MetaWaylandSurface *surface)
 
 void                meta_wayland_surface_notify_geometry_changed (MetaWaylandSurface *surface);
 
+void                meta_wayland_surface_notify_suspend_state_changed (MetaWaylandSurface *surface);
+
 int                 meta_wayland_surface_get_width (MetaWaylandSurface *surface);
 int                 meta_wayland_surface_get_height (MetaWaylandSurface *surface);
 
@@ -0,0 +1,199 @@
+/*
+ * Copyright (C) 2020 Red Hat
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "wayland/meta-wayland-suspension.h"
+
+#include <wayland-server.h>
+
+#include "core/window-private.h"
+#include "wayland/meta-wayland-private.h"
+#include "wayland/meta-wayland-surface.h"
+#include "wayland/meta-wayland-versions.h"
+
+#include "mutter-suspension-server-protocol.h"
+
+typedef struct _MetaWaylandSurfaceSuspension
+{
+  MetaWaylandSurface *surface;
+  gulong              suspend_state_changed_handler;
+  gulong              unmapped_handler;
+  gulong              surface_destroyed_handler;
+  struct wl_resource *resource;
+
+  gboolean            suspended;
+} MetaWaylandSurfaceSuspension;
+
+static gboolean
+is_surface_suspended (MetaWaylandSurface *surface)
+{
+  MetaWindow *window = surface->window;
+
+  if (!window || window->unmanaging)
+    return FALSE;
+
+  return meta_window_is_suspended (window);
+}
+
+static void
+update_suspended (MetaWaylandSurfaceSuspension *suspension,
+                  gboolean                      suspended)
+{
+  if (suspension->suspended == suspended)
+    return;
+
+  suspension->suspended = suspended;
+
+  if (suspended)
+    mutter_surface_suspension_v1_send_suspended (suspension->resource);
+  else
+    mutter_surface_suspension_v1_send_resumed (suspension->resource);
+}
+
+static void
+suspend_state_changed_cb (MetaWaylandSurface           *surface,
+                          MetaWaylandSurfaceSuspension *suspension)
+{
+  update_suspended (suspension, is_surface_suspended (surface));
+}
+
+static void
+surface_unmapped_cb (MetaWaylandSurface           *surface,
+                     MetaWaylandSurfaceSuspension *suspension)
+{
+  update_suspended (suspension, FALSE);
+}
+
+static void
+surface_destroyed_cb (MetaWaylandSurface           *surface,
+                      MetaWaylandSurfaceSuspension *suspension)
+{
+  g_clear_signal_handler (&suspension->suspend_state_changed_handler,
+                          suspension->surface);
+  g_clear_signal_handler (&suspension->unmapped_handler,
+                          suspension->surface);
+  g_clear_signal_handler (&suspension->surface_destroyed_handler,
+                          suspension->surface);
+  suspension->surface = NULL;
+}
+
+static void
+mutter_surface_suspension_destructor (struct wl_resource *resource)
+{
+  MetaWaylandSurfaceSuspension *suspension;
+
+  suspension = wl_resource_get_user_data (resource);
+  if (suspension->surface)
+    surface_destroyed_cb (suspension->surface, suspension);
+
+  g_free (suspension);
+}
+
+static void
+mutter_surface_suspension_destroy (struct wl_client   *client,
+                                   struct wl_resource *resource)
+{
+  wl_resource_destroy (resource);
+}
+
+static const struct mutter_surface_suspension_v1_interface
+  meta_surface_suspension_interface = {
+    mutter_surface_suspension_destroy,
+  };
+
+static void
+mutter_suspension_manager_destroy (struct wl_client   *client,
+                                   struct wl_resource *resource)
+{
+  wl_resource_destroy (resource);
+}
+
+static void
+mutter_suspension_manager_get_surface_suspension (struct wl_client   *client,
+                                                  struct wl_resource *resource,
+                                                  uint32_t            id,
+                                                  struct wl_resource *surface_resource)
+{
+  MetaWaylandSurface *surface = wl_resource_get_user_data (surface_resource);
+  MetaWaylandSurfaceSuspension *suspension;
+  struct wl_resource *suspension_resource;
+
+  suspension_resource =
+    wl_resource_create (client,
+                        &mutter_surface_suspension_v1_interface,
+                        wl_resource_get_version (resource),
+                        id);
+
+  suspension = g_new0 (MetaWaylandSurfaceSuspension, 1);
+  suspension->surface = surface;
+  suspension->resource = suspension_resource;
+
+  suspension->suspend_state_changed_handler =
+    g_signal_connect (surface, "suspend-state-changed",
+                      G_CALLBACK (suspend_state_changed_cb),
+                      suspension);
+  suspension->unmapped_handler =
+    g_signal_connect (surface, "unmapped",
+                      G_CALLBACK (surface_unmapped_cb),
+                      suspension);
+  suspension->surface_destroyed_handler =
+    g_signal_connect (surface, "destroy",
+                      G_CALLBACK (surface_destroyed_cb),
+                      suspension);
+
+  wl_resource_set_implementation (suspension_resource,
+                                  &meta_surface_suspension_interface,
+                                  suspension,
+                                  mutter_surface_suspension_destructor);
+
+  update_suspended (suspension, is_surface_suspended (surface));
+}
+
+static const struct mutter_suspension_manager_v1_interface
+  meta_suspension_manager_interface = {
+    mutter_suspension_manager_destroy,
+    mutter_suspension_manager_get_surface_suspension,
+  };
+
+static void
+bind_suspension_manager (struct wl_client *client,
+                         void             *data,
+                         uint32_t          version,
+                         uint32_t          id)
+{
+  struct wl_resource *resource;
+
+  resource = wl_resource_create (client,
+                                 &mutter_suspension_manager_v1_interface,
+                                 version,
+                                 id);
+
+  wl_resource_set_implementation (resource,
+                                  &meta_suspension_manager_interface,
+                                  NULL, NULL);
+}
+
+gboolean
+meta_wayland_suspension_init (MetaWaylandCompositor *compositor)
+{
+  return (wl_global_create (compositor->wayland_display,
+                            &mutter_suspension_manager_v1_interface,
+                            META_MUTTER_SUSPENSION_MANAGER_V1_VERSION,
+                            NULL,
+                            bind_suspension_manager) != NULL);
+}
@@ -37,6 +37,8 @@ struct _MetaWaylandWindowConfiguration
   gboolean has_size;
   int width;
   int height;
+
+  int64_t sent_time_us;
 };
 
 MetaWaylandWindowConfiguration * meta_wayland_window_configuration_new (int x,
@@ -58,6 +58,14 @@ struct _MetaWindowWayland
   int last_sent_width;
   int last_sent_height;
 
+  /* Interactive resizes keep at most one configure in flight; the most
+   * recent size requested in the meantime is sent once it has landed. */
+  gboolean has_throttled_configure;
+  int throttled_x;
+  int throttled_y;
+  int throttled_width;
+  int throttled_height;
+
   gboolean has_been_shown;
 };
 
@@ -173,11 +181,62 @@ meta_window_wayland_configure (MetaWindowWayland *wl_window,
   MetaWaylandWindowConfiguration *configuration;
 
   configuration = meta_wayland_window_configuration_new (x, y, width, height);
+  configuration->sent_time_us = g_get_monotonic_time ();
 
   meta_wayland_surface_configure_notify (window->surface, configuration);
 
   wl_window->pending_configurations =
     g_list_prepend (wl_window->pending_configurations, configuration);
+
+  wl_window->has_throttled_configure = FALSE;
+}
+
+static gboolean
+should_throttle_configure (MetaWindowWayland   *wl_window,
+                           MetaMoveResizeFlags  flags)
+{
+  MetaWindow *window = META_WINDOW (wl_window);
+  MetaDisplay *display = window->display;
+
+  if (flags & META_MOVE_RESIZE_STATE_CHANGED)
+    return FALSE;
+
+  if (display->grab_window != window ||
+      !meta_grab_op_is_resizing (display->grab_op))
+    return FALSE;
+
+  return wl_window->pending_configurations != NULL;
+}
+
+static void
+throttle_configure (MetaWindowWayland *wl_window,
+                    int                x,
+                    int                y,
+                    int                width,
+                    int                height)
+{
+  meta_topic (META_DEBUG_RESIZING,
+              "Coalescing configure %dx%d for %s, previous one in flight\n",
+              width, height, META_WINDOW (wl_window)->desc);
+
+  wl_window->has_throttled_configure = TRUE;
+  wl_window->throttled_x = x;
+  wl_window->throttled_y = y;
+  wl_window->throttled_width = width;
+  wl_window->throttled_height = height;
+}
+
+static void
+flush_throttled_configure (MetaWindowWayland *wl_window)
+{
+  if (!wl_window->has_throttled_configure)
+    return;
+
+  meta_window_wayland_configure (wl_window,
+                                 wl_window->throttled_x,
+                                 wl_window->throttled_y,
+                                 wl_window->throttled_width,
+                                 wl_window->throttled_height);
 }
 
 static void
@@ -189,6 +248,12 @@ surface_state_changed (MetaWindow *window)
   if (window->unmanaging)
     return;
 
+  if (wl_window->has_throttled_configure)
+    {
+      flush_throttled_configure (wl_window);
+      return;
+    }
+
   meta_window_wayland_configure (wl_window,
                                  wl_window->last_sent_x,
                                  wl_window->last_sent_y,
@@ -196,6 +261,12 @@ surface_state_changed (MetaWindow *window)
                                  wl_window->last_sent_height);
 }
 
+static void
+meta_window_wayland_suspend_state_changed (MetaWindow *window)
+{
+  meta_wayland_surface_notify_suspend_state_changed (window->surface);
+}
+
 static void
 meta_window_wayland_grab_op_began (MetaWindow *window,
                                    MetaGrabOp  op)
@@ -210,6 +281,8 @@ static void
 meta_window_wayland_grab_op_ended (MetaWindow *window,
                                    MetaGrabOp  op)
 {
+  /* This also sends the size coalesced while the last configure of the
+   * resize was in flight, without waiting for it to be acked. */
   if (meta_grab_op_is_resizing (op))
     surface_state_changed (window);
 
@@ -323,11 +396,22 @@ meta_window_wayland_move_resize_internal (MetaWindow                *window,
               constrained_rect.height == 1)
             return;
 
-          meta_window_wayland_configure (wl_window,
-                                         configured_x,
-                                         configured_y,
-                                         configured_width,
-                                         configured_height);
+          if (should_throttle_configure (wl_window, flags))
+            {
+              throttle_configure (wl_window,
+                                  configured_x,
+                                  configured_y,
+                                  configured_width,
+                                  configured_height);
+            }
+          else
+            {
+              meta_window_wayland_configure (wl_window,
+                                             configured_x,
+                                             configured_y,
+                                             configured_width,
+                                             configured_height);
+            }
 
           /* We need to wait until the resize completes before we can move */
           can_move_now = FALSE;
@@ -337,6 +421,10 @@ meta_window_wayland_move_resize_internal (MetaWindow                *window,
           /* We're just moving the window, so we don't need to wait for a configure
            * and then ack to simply move the window. */
           can_move_now = TRUE;
+
+          /* The window is back at the size it has, drop any coalesced size
+           * so the next ack doesn't resize it again. */
+          wl_window->has_throttled_configure = FALSE;
         }
     }
 
@@ -694,6 +782,7 @@ meta_window_wayland_class_init (MetaWindowWaylandClass *klass)
   window_class->calculate_layer = meta_window_wayland_calculate_layer;
   window_class->map = meta_window_wayland_map;
   window_class->unmap = meta_window_wayland_unmap;
+  window_class->suspend_state_changed = meta_window_wayland_suspend_state_changed;
 }
 
 MetaWindow *
@@ -778,6 +867,39 @@ acquire_acked_configuration (MetaWindowWayland       *wl_window,
   return NULL;
 }
 
+static void
+record_configure_latency (MetaWindow                     *window,
+                          MetaWaylandWindowConfiguration *configuration)
+{
+  int64_t now_us;
+
+  if (!configuration->sent_time_us)
+    return;
+
+  now_us = g_get_monotonic_time ();
+
+  meta_topic (META_DEBUG_RESIZING,
+              "Configure %u for %s committed after %.2f ms\n",
+              configuration->serial, window->desc,
+              (now_us - configuration->sent_time_us) / 1000.0);
+
+#ifdef HAVE_PROFILER
+  {
+    MetaBackend *backend = meta_get_backend ();
+    MetaProfiler *profiler = meta_backend_get_profiler (backend);
+
+    if (profiler && meta_profiler_is_running (profiler))
+      {
+        g_autofree char *name = NULL;
+
+        name = g_strdup_printf ("Configure (%s)", window->desc);
+        meta_profiler_add_mark (profiler, name,
+                                configuration->sent_time_us, now_us);
+      }
+  }
+#endif
+}
+
 int
 meta_window_wayland_get_geometry_scale (MetaWindow *window)
 {
@@ -828,6 +950,8 @@ meta_window_wayland_finish_move_resize (MetaWindow              *window,
   flags = META_MOVE_RESIZE_WAYLAND_FINISH_MOVE_RESIZE;
 
   acked_configuration = acquire_acked_configuration (wl_window, pending);
+  if (acked_configuration)
+    record_configure_latency (window, acked_configuration);
 
   /* x/y are ignored when we're doing interactive resizing */
   if (!meta_grab_op_is_resizing (window->display->grab_op))
@@ -864,6 +988,11 @@ meta_window_wayland_finish_move_resize (MetaWindow              *window,
 
   gravity = meta_resize_gravity_from_grab_op (window->display->grab_op);
   meta_window_move_resize_internal (window, flags, gravity, rect);
+
+  /* The configure that was in flight has landed; send the size the
+   * interactive resize asked for in the meantime. */
+  if (!wl_window->pending_configurations)
+    flush_throttled_configure (wl_window);
 }
 
 void
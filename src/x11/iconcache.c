@@ -187,6 +187,173 @@ argbdata_to_surface (gulong *argb_data, int w, int h)
   return surface;
 }
 
+/* _NET_WM_ICON surfaces are shared between windows with identical icon
+ * data, which is typically every window of an application. The cache
+ * keeps a reference to the most recently used surfaces, up to
+ * ICON_SURFACE_CACHE_MAX_BYTES; windows hold their own references.
+ */
+#define ICON_SURFACE_CACHE_MAX_BYTES (4 * 1024 * 1024)
+
+typedef struct _IconSurfaceCacheEntry
+{
+  guint hash;
+  int width;
+  int height;
+
+  /* Either the cached surface, or the raw data of a lookup key */
+  cairo_surface_t *surface;
+  gulong *argb_data;
+
+  GList link;
+} IconSurfaceCacheEntry;
+
+static GHashTable *icon_surfaces;
+static GQueue icon_surfaces_lru = G_QUEUE_INIT;
+static size_t icon_surfaces_size;
+
+static guint
+hash_argb_data (gulong *argb_data,
+                int     w,
+                int     h)
+{
+  guint hash = 5381;
+  int i;
+
+  hash = hash * 33 + w;
+  hash = hash * 33 + h;
+
+  for (i = 0; i < w * h; i++)
+    hash = hash * 33 + (uint32_t) argb_data[i];
+
+  return hash;
+}
+
+static gboolean
+argb_data_equals_surface (gulong          *argb_data,
+                          cairo_surface_t *surface)
+{
+  int w = cairo_image_surface_get_width (surface);
+  int h = cairo_image_surface_get_height (surface);
+  int stride = cairo_image_surface_get_stride (surface) / sizeof (uint32_t);
+  uint32_t *data = (uint32_t *) cairo_image_surface_get_data (surface);
+  int y, x;
+
+  for (y = 0; y < h; y++)
+    {
+      for (x = 0; x < w; x++)
+        {
+          if (data[y * stride + x] != (uint32_t) argb_data[y * w + x])
+            return FALSE;
+        }
+    }
+
+  return TRUE;
+}
+
+static guint
+icon_surface_cache_entry_hash (gconstpointer key)
+{
+  const IconSurfaceCacheEntry *entry = key;
+
+  return entry->hash;
+}
+
+static gboolean
+icon_surface_cache_entry_equal (gconstpointer a,
+                                gconstpointer b)
+{
+  const IconSurfaceCacheEntry *entry_a = a;
+  const IconSurfaceCacheEntry *entry_b = b;
+
+  if (entry_a == entry_b)
+    return TRUE;
+
+  /* Entries in the table always have a surface, lookup keys never do */
+  if (!entry_a->argb_data && !entry_b->argb_data)
+    return FALSE;
+
+  if (entry_a->hash != entry_b->hash ||
+      entry_a->width != entry_b->width ||
+      entry_a->height != entry_b->height)
+    return FALSE;
+
+  if (entry_a->argb_data)
+    return argb_data_equals_surface (entry_a->argb_data, entry_b->surface);
+  else
+    return argb_data_equals_surface (entry_b->argb_data, entry_a->surface);
+}
+
+static void
+icon_surface_cache_entry_free (IconSurfaceCacheEntry *entry)
+{
+  cairo_surface_destroy (entry->surface);
+  g_free (entry);
+}
+
+static size_t
+icon_surface_size (cairo_surface_t *surface)
+{
+  return (size_t) cairo_image_surface_get_stride (surface) *
+         cairo_image_surface_get_height (surface);
+}
+
+static cairo_surface_t *
+ensure_icon_surface (gulong *argb_data,
+                     int     w,
+                     int     h)
+{
+  IconSurfaceCacheEntry key = { 0 };
+  IconSurfaceCacheEntry *entry;
+
+  if (!icon_surfaces)
+    {
+      icon_surfaces =
+        g_hash_table_new_full (icon_surface_cache_entry_hash,
+                               icon_surface_cache_entry_equal,
+                               (GDestroyNotify) icon_surface_cache_entry_free,
+                               NULL);
+    }
+
+  key.hash = hash_argb_data (argb_data, w, h);
+  key.width = w;
+  key.height = h;
+  key.argb_data = argb_data;
+
+  entry = g_hash_table_lookup (icon_surfaces, &key);
+  if (entry)
+    {
+      g_queue_unlink (&icon_surfaces_lru, &entry->link);
+      g_queue_push_head_link (&icon_surfaces_lru, &entry->link);
+      return cairo_surface_reference (entry->surface);
+    }
+
+  entry = g_new0 (IconSurfaceCacheEntry, 1);
+  entry->hash = key.hash;
+  entry->width = w;
+  entry->height = h;
+  entry->surface = argbdata_to_surface (argb_data, w, h);
+  entry->link.data = entry;
+
+  g_hash_table_add (icon_surfaces, entry);
+  g_queue_push_head_link (&icon_surfaces_lru, &entry->link);
+  icon_surfaces_size += icon_surface_size (entry->surface);
+
+  while (icon_surfaces_size > ICON_SURFACE_CACHE_MAX_BYTES &&
+         icon_surfaces_lru.length > 1)
+    {
+      IconSurfaceCacheEntry *oldest;
+      GList *link;
+
+      link = g_queue_pop_tail_link (&icon_surfaces_lru);
+      oldest = link->data;
+
+      icon_surfaces_size -= icon_surface_size (oldest->surface);
+      g_hash_table_remove (icon_surfaces, oldest);
+    }
+
+  return cairo_surface_reference (entry->surface);
+}
+
 static gboolean
 read_rgb_icon (MetaX11Display   *x11_display,
                Window            xwindow,
@@ -248,8 +415,8 @@ read_rgb_icon (MetaX11Display   *x11_display,
       return FALSE;
     }
 
-  *icon = argbdata_to_surface (best, w, h);
-  *mini_icon = argbdata_to_surface (best_mini, mini_w, mini_h);
+  *icon = ensure_icon_surface (best, w, h);
+  *mini_icon = ensure_icon_surface (best_mini, mini_w, mini_h);
 
   XFree (data);
 
@@ -56,6 +56,7 @@ struct _MetaX11SelectionOutputStreamPrivate
   GTask *pending_task;
 
   guint incr : 1;
+  guint incr_finished : 1;
   guint delete_pending : 1;
 };
 
@@ -113,7 +114,8 @@ get_max_request_size (MetaX11Display *display)
   if (size <= 0)
     size = XMaxRequestSize (display->xdisplay);
 
-  return size - 100;
+  /* Request sizes are in 4 byte units, leave room for the request header */
+  return (size - 100) * 4;
 }
 
 static gboolean
@@ -123,7 +125,11 @@ meta_x11_selection_output_stream_needs_flush_unlocked (MetaX11SelectionOutputStr
     meta_x11_selection_output_stream_get_instance_private (stream);
 
   if (priv->data->len == 0)
-    return FALSE;
+    {
+      /* INCR transfers are terminated by a zero-length property */
+      return (priv->incr && !priv->incr_finished &&
+              g_output_stream_is_closing (G_OUTPUT_STREAM (stream)));
+    }
 
   if (g_output_stream_is_closing (G_OUTPUT_STREAM (stream)))
     return TRUE;
@@ -171,13 +177,52 @@ get_element_size (int format)
     }
 }
 
+static void meta_x11_selection_output_stream_write_async (GOutputStream       *output_stream,
+                                                          const void          *buffer,
+                                                          size_t               count,
+                                                          int                  io_priority,
+                                                          GCancellable        *cancellable,
+                                                          GAsyncReadyCallback  callback,
+                                                          gpointer             user_data);
+
+static void
+meta_x11_selection_output_stream_complete_pending (MetaX11SelectionOutputStream *stream)
+{
+  MetaX11SelectionOutputStreamPrivate *priv =
+    meta_x11_selection_output_stream_get_instance_private (stream);
+  GTask *task = priv->pending_task;
+
+  if (!task)
+    return;
+
+  if (g_task_get_source_tag (task) == meta_x11_selection_output_stream_write_async)
+    {
+      size_t result;
+
+      result = GPOINTER_TO_SIZE (g_task_get_task_data (task));
+      g_task_return_int (task, result);
+    }
+  else
+    {
+      /* Flushes are only complete once all buffered data went through */
+      if (meta_x11_selection_output_stream_needs_flush (stream))
+        return;
+
+      g_task_return_boolean (task, TRUE);
+    }
+
+  priv->pending_task = NULL;
+  g_object_unref (task);
+}
+
 static void
 meta_x11_selection_output_stream_perform_flush (MetaX11SelectionOutputStream *stream)
 {
   MetaX11SelectionOutputStreamPrivate *priv =
     meta_x11_selection_output_stream_get_instance_private (stream);
   Display *xdisplay;
-  size_t element_size, n_elements;
+  size_t element_size, n_elements, max_size;
+  gboolean closing;
 
   g_assert (!priv->delete_pending);
 
@@ -189,12 +234,17 @@ meta_x11_selection_output_stream_perform_flush (MetaX11SelectionOutputStream *st
   g_mutex_lock (&priv->mutex);
 
   element_size = get_element_size (priv->format);
-  n_elements = priv->data->len / element_size;
+  max_size = get_max_request_size (priv->x11_display);
+  closing = g_output_stream_is_closing (G_OUTPUT_STREAM (stream));
 
-  if (!g_output_stream_is_closing (G_OUTPUT_STREAM (stream)))
+  if (!priv->incr && (!closing || priv->data->len > max_size))
     {
       XWindowAttributes attrs;
 
+      /* The data doesn't fit in a single request, or it's not all there
+       * yet. Announce an INCR transfer, the data follows in chunks as the
+       * requestor deletes the property.
+       */
       priv->incr = TRUE;
       XGetWindowAttributes (xdisplay,
 			    priv->xwindow,
@@ -210,11 +260,18 @@ meta_x11_selection_output_stream_perform_flush (MetaX11SelectionOutputStream *st
                        XInternAtom (priv->x11_display->xdisplay, "INCR", True),
                        32,
                        PropModeReplace,
-                       (guchar *) &(long) { n_elements },
+                       (guchar *) &(long) { priv->data->len },
                        1);
+
+      meta_x11_selection_output_stream_notify_selection (stream);
     }
   else
     {
+      /* Send as much as a single request can hold; with INCR, a
+       * zero-length chunk marks the end of the transfer.
+       */
+      n_elements = MIN (priv->data->len, max_size) / element_size;
+
       XChangeProperty (xdisplay,
                        priv->xwindow,
                        priv->xproperty,
@@ -226,9 +283,12 @@ meta_x11_selection_output_stream_perform_flush (MetaX11SelectionOutputStream *st
       g_byte_array_remove_range (priv->data, 0, n_elements * element_size);
       if (priv->data->len < element_size)
         priv->flush_requested = FALSE;
-    }
 
-  meta_x11_selection_output_stream_notify_selection (stream);
+      if (!priv->incr)
+        meta_x11_selection_output_stream_notify_selection (stream);
+      else if (n_elements == 0 && closing)
+        priv->incr_finished = TRUE;
+    }
 
   priv->delete_pending = TRUE;
   g_cond_broadcast (&priv->cond);
@@ -238,15 +298,7 @@ meta_x11_selection_output_stream_perform_flush (MetaX11SelectionOutputStream *st
   if (meta_x11_error_trap_pop_with_return (priv->x11_display))
     g_warning ("Failed to flush selection output stream");
 
-  if (priv->pending_task)
-    {
-      size_t result;
-
-      result = GPOINTER_TO_SIZE (g_task_get_task_data (priv->pending_task));
-      g_task_return_int (priv->pending_task, result);
-      g_object_unref (priv->pending_task);
-      priv->pending_task = NULL;
-    }
+  meta_x11_selection_output_stream_complete_pending (stream);
 }
 
 static gboolean
@@ -404,26 +456,26 @@ meta_x11_selection_output_stream_flush_async (GOutputStream       *output_stream
   g_task_set_source_tag (task, meta_x11_selection_output_stream_flush_async);
   g_task_set_priority (task, io_priority);
 
-  if (!meta_x11_selection_output_stream_can_flush (stream))
+  if (!meta_x11_selection_output_request_flush (stream))
     {
-      if (meta_x11_selection_output_request_flush (stream))
-        {
-          g_assert (priv->pending_task == NULL);
-          priv->pending_task = task;
-          return;
-        }
-      else
-        {
-          g_task_return_boolean (task, TRUE);
-          g_object_unref (task);
-          return;
-        }
+      g_task_return_boolean (task, TRUE);
+      g_object_unref (task);
+      return;
     }
 
-  meta_x11_selection_output_stream_perform_flush (stream);
-  g_task_return_boolean (task, TRUE);
-  g_object_unref (task);
-  return;
+  if (meta_x11_selection_output_stream_can_flush (stream))
+    meta_x11_selection_output_stream_perform_flush (stream);
+
+  if (!meta_x11_selection_output_stream_needs_flush (stream))
+    {
+      g_task_return_boolean (task, TRUE);
+      g_object_unref (task);
+      return;
+    }
+
+  /* More chunks are pending, complete once the requestor took them all */
+  g_assert (priv->pending_task == NULL);
+  priv->pending_task = task;
 }
 
 static gboolean